@@ -133,6 +133,19 @@ public:
       return this->read() / this->ADC_MAX_;
    }
 
+   /********************************************************************************
+   * duty_steps: Lser av en analog insignal och returnerar motsvarande antal
+   *             steg av angivet antal steg per period, avrundat till nrmaste
+   *             heltal. Berkningen sker med heltal, utan flyttal.
+   *
+   *             - steps: Antalet steg per period.
+   ********************************************************************************/
+   uint8_t duty_steps(const uint8_t steps) const
+   {
+      const auto max = static_cast<uint16_t>(this->ADC_MAX_);
+      return static_cast<uint8_t>((static_cast<uint32_t>(this->read()) * steps + max / 2) / max);
+   }
+
    /********************************************************************************
    * get_pwm_values: Lser av en analog insignal och berknar on- och off-tid fr
    *                 fr PWM-generering, avrundat till nrmaste heltal.
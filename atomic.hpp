@@ -0,0 +1,349 @@
+/********************************************************************************
+* atomic.hpp: Innehller primitiver fr sker tkomst av data som delas mellan
+*             avbrottsrutiner och huvudprogrammet. ATmega328P r en 8-bitars
+*             processor, vilket innebr att lsning och skrivning av 16- och
+*             32-bitars variabler sker en byte i taget. Om ett avbrott ger rum
+*             mitt i en sdan tkomst kan ett halvuppdaterat vrde erhllas.
+*
+*             - critical_section: Inaktiverar avbrott under objektets livstid
+*                                 och terstller drefter statusregistret SREG
+*                                 till vrdet fre, vilket gr att avbrott inte
+*                                 aktiveras av misstag om klassen anvnds i en
+*                                 avbrottsrutin (till skillnad mot CLI/SEI).
+*
+*             - atomic<T>       : Variabel av godtycklig heltalstyp, dr lsning
+*                                 och skrivning alltid sker odelbart. Variabler
+*                                 p en byte lses och skrivs utan kritisk sektion.
+*
+*             - seqlock<T>      : Skyddar en strukt innehllande flera flt som
+*                                 skrivs av en avbrottsrutin. Lsaren kopierar
+*                                 strukten utan att inaktivera avbrott och gr
+*                                 om kopieringen ifall en skrivning gde rum
+*                                 under tiden, vilket ger en konsistent gonblicksbild
+*                                 utan att avbrottslatensen pverkas.
+*
+*             Kritiska sektioner br hllas s korta som mjligt, eftersom
+*             avbrottslatensen i vrsta fall frlngs med den lngsta kritiska
+*             sektionen i programmet.
+********************************************************************************/
+#ifndef ATOMIC_HPP_
+#define ATOMIC_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+
+/********************************************************************************
+* memory_barrier: Frhindrar att kompilatorn flyttar minnestkomster frbi
+*                 anropet, vilket krvs i brjan och slutet av kritiska sektioner.
+*                 Ingen instruktion genereras.
+********************************************************************************/
+inline void memory_barrier(void)
+{
+   asm volatile("" ::: "memory");
+   return;
+}
+
+/********************************************************************************
+* critical_section: Klass fr implementering av kritiska sektioner. Avbrott
+*                   inaktiveras nr objektet skapas och statusregistret SREG
+*                   terstlls nr objektet gr ur scope, exempelvis:
+*
+*                   {
+*                      critical_section lock;
+*                      shared_value++;
+*                   }
+********************************************************************************/
+class critical_section
+{
+private:
+   const uint8_t sreg_; /* Statusregistrets vrde innan avbrott inaktiverades. */
+
+public:
+
+   /********************************************************************************
+   * critical_section: Sparar statusregistret och inaktiverar avbrott.
+   ********************************************************************************/
+   critical_section(void)
+      : sreg_(SREG)
+   {
+      asm volatile("CLI" ::: "memory");
+      return;
+   }
+
+   /********************************************************************************
+   * ~critical_section: terstller statusregistret, vilket teraktiverar avbrott
+   *                    endast om dessa var aktiverade nr objektet skapades.
+   ********************************************************************************/
+   ~critical_section(void)
+   {
+      memory_barrier();
+      SREG = this->sreg_;
+      return;
+   }
+
+   /********************************************************************************
+   * critical_section: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   critical_section(critical_section&) = delete;
+
+   /********************************************************************************
+   * critical_section: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   critical_section& operator= (critical_section&) = delete;
+};
+
+/********************************************************************************
+* atomic: Generisk klass fr variabler som delas mellan avbrottsrutiner och
+*         huvudprogrammet, dr samtliga operationer sker odelbart.
+********************************************************************************/
+template<class T>
+class atomic
+{
+private:
+   volatile T value_; /* Lagrat vrde. */
+
+   static constexpr bool LOCK_FREE_ = sizeof(T) == 1; /* Indikerar ifall tkomst r odelbar utan kritisk sektion. */
+
+public:
+
+   /********************************************************************************
+   * atomic: Initierar ny variabel med angivet startvrde.
+   *
+   *         - value: Startvrde (default = 0).
+   ********************************************************************************/
+   atomic(const T value = static_cast<T>(0))
+      : value_(value) { }
+
+   /********************************************************************************
+   * atomic: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   atomic(atomic&) = delete;
+
+   /********************************************************************************
+   * atomic: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   atomic& operator= (atomic&) = delete;
+
+   /********************************************************************************
+   * load: Returnerar lagrat vrde.
+   ********************************************************************************/
+   T load(void) const
+   {
+      if (LOCK_FREE_) return this->value_;
+      critical_section lock;
+      return this->value_;
+   }
+
+   /********************************************************************************
+   * store: Lagrar angivet vrde.
+   *
+   *        - value: Vrdet som ska lagras.
+   ********************************************************************************/
+   void store(const T value)
+   {
+      if (LOCK_FREE_)
+      {
+         this->value_ = value;
+      }
+      else
+      {
+         critical_section lock;
+         this->value_ = value;
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * exchange: Lagrar angivet vrde och returnerar det tidigare vrdet.
+   *
+   *           - value: Vrdet som ska lagras.
+   ********************************************************************************/
+   T exchange(const T value)
+   {
+      critical_section lock;
+      const T previous = this->value_;
+      this->value_ = value;
+      return previous;
+   }
+
+   /********************************************************************************
+   * fetch_add: Adderar angivet vrde och returnerar det tidigare vrdet.
+   *
+   *            - value: Vrdet som ska adderas.
+   ********************************************************************************/
+   T fetch_add(const T value)
+   {
+      critical_section lock;
+      const T previous = this->value_;
+      this->value_ = previous + value;
+      return previous;
+   }
+
+   /********************************************************************************
+   * fetch_sub: Subtraherar angivet vrde och returnerar det tidigare vrdet.
+   *
+   *            - value: Vrdet som ska subtraheras.
+   ********************************************************************************/
+   T fetch_sub(const T value)
+   {
+      critical_section lock;
+      const T previous = this->value_;
+      this->value_ = previous - value;
+      return previous;
+   }
+
+   /********************************************************************************
+   * compare_exchange: Lagrar angivet nytt vrde frutsatt att lagrat vrde r
+   *                   lika med frvntat vrde, vilket d indikeras genom att
+   *                   true returneras. Annars skrivs lagrat vrde till expected
+   *                   och false returneras.
+   *
+   *                   - expected: Referens till frvntat vrde.
+   *                   - desired : Vrdet som ska lagras.
+   ********************************************************************************/
+   bool compare_exchange(T& expected,
+                         const T desired)
+   {
+      critical_section lock;
+
+      if (this->value_ == expected)
+      {
+         this->value_ = desired;
+         return true;
+      }
+      else
+      {
+         expected = this->value_;
+         return false;
+      }
+   }
+
+   /********************************************************************************
+   * operator T: Returnerar lagrat vrde.
+   ********************************************************************************/
+   operator T(void) const
+   {
+      return this->load();
+   }
+
+   /********************************************************************************
+   * operator=: Lagrar angivet vrde.
+   *
+   *            - value: Vrdet som ska lagras.
+   ********************************************************************************/
+   atomic& operator= (const T value)
+   {
+      this->store(value);
+      return *this;
+   }
+
+   /********************************************************************************
+   * operator+=: Adderar angivet vrde och returnerar det nya vrdet.
+   *
+   *             - value: Vrdet som ska adderas.
+   ********************************************************************************/
+   T operator+= (const T value)
+   {
+      return this->fetch_add(value) + value;
+   }
+
+   /********************************************************************************
+   * operator-=: Subtraherar angivet vrde och returnerar det nya vrdet.
+   *
+   *             - value: Vrdet som ska subtraheras.
+   ********************************************************************************/
+   T operator-= (const T value)
+   {
+      return this->fetch_sub(value) - value;
+   }
+
+   /********************************************************************************
+   * operator++: Rknar upp lagrat vrde och returnerar det nya vrdet.
+   ********************************************************************************/
+   T operator++ (void)
+   {
+      return this->fetch_add(1) + 1;
+   }
+
+   /********************************************************************************
+   * operator--: Rknar ned lagrat vrde och returnerar det nya vrdet.
+   ********************************************************************************/
+   T operator-- (void)
+   {
+      return this->fetch_sub(1) - 1;
+   }
+};
+
+/********************************************************************************
+* seqlock: Generisk klass fr strukter med flera flt som skrivs av en
+*          avbrottsrutin och lses av huvudprogrammet. En sekvensrknare rknas
+*          upp fre och efter varje skrivning, vilket gr att rknaren r udda
+*          under pgende skrivning. Lsaren kopierar datan och kontrollerar
+*          att rknaren var jmn och ofrndrad under kopieringen, annars grs
+*          kopieringen om. Avbrott inaktiveras drmed aldrig av lsaren.
+*
+*          Skrivning fr endast ske frn en avbrottsrutin (eller med avbrott
+*          inaktiverade), eftersom en lsare i en avbrottsrutin annars skulle
+*          kunna vnta p en skrivning som aldrig blir klar.
+********************************************************************************/
+template<class T>
+class seqlock
+{
+private:
+   volatile uint8_t sequence_ = 0; /* Sekvensrknare, udda under pgende skrivning. */
+   T data_;                        /* Skyddad data. */
+
+public:
+
+   /********************************************************************************
+   * seqlock: Defaultkonstruktor, initierar skyddad data med defaultvrden.
+   ********************************************************************************/
+   seqlock(void) { }
+
+   /********************************************************************************
+   * seqlock: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   seqlock(seqlock&) = delete;
+
+   /********************************************************************************
+   * seqlock: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   seqlock& operator= (seqlock&) = delete;
+
+   /********************************************************************************
+   * write: Skriver angiven data. Anropas frn en avbrottsrutin.
+   *
+   *        - data: Referens till datan som ska skrivas.
+   ********************************************************************************/
+   void write(const T& data)
+   {
+      this->sequence_ = this->sequence_ + 1;
+      memory_barrier();
+      this->data_ = data;
+      memory_barrier();
+      this->sequence_ = this->sequence_ + 1;
+      return;
+   }
+
+   /********************************************************************************
+   * read: Returnerar en konsistent kopia av skyddad data. Kopieringen grs om
+   *       ifall en skrivning gde rum under tiden.
+   ********************************************************************************/
+   T read(void) const
+   {
+      uint8_t sequence = 0;
+      T copy;
+
+      do
+      {
+         sequence = this->sequence_;
+         memory_barrier();
+         copy = this->data_;
+         memory_barrier();
+      } while ((sequence & 0x01) || sequence != this->sequence_);
+
+      return copy;
+   }
+};
+
+#endif /* ATOMIC_HPP_ */
\ No newline at end of file
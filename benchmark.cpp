@@ -0,0 +1,114 @@
+/********************************************************************************
+* benchmark.cpp: Innehller mtning av kostnaden fr push och pop i vector.
+********************************************************************************/
+#include "benchmark.hpp"
+#include "vector.hpp"
+#include "power.hpp"
+#include "serial.hpp"
+
+/********************************************************************************
+* elapsed_us: Returnerar tiden mtt i mikrosekunder sedan angiven tidpunkt.
+*
+*             - start: Tidpunkten d mtningen startade, mtt i ticks.
+********************************************************************************/
+static inline uint32_t elapsed_us(const uint32_t start)
+{
+   return static_cast<uint32_t>((power::now() - start) * power::TICK_US);
+}
+
+/********************************************************************************
+* vector_push_pop: Genomfr angivet antal push fljt av lika mnga pop p en
+*                  vector<uint16_t>. Varje ndring av kapaciteten motsvarar
+*                  ett anrop till malloc eller realloc.
+*
+*                  - count: Antalet element.
+********************************************************************************/
+benchmark::result benchmark::vector_push_pop(const uint16_t count)
+{
+   result measurement;
+   vector<uint16_t> v;
+   auto capacity = v.capacity();
+   const auto start = power::now();
+
+   for (uint16_t i = 0; i < count; ++i)
+   {
+      if (v.push(i)) break;
+      if (v.capacity() != capacity) measurement.allocations++;
+      capacity = v.capacity();
+   }
+
+   while (v.size())
+   {
+      v.pop();
+      if (v.capacity() != capacity) measurement.allocations++;
+      capacity = v.capacity();
+   }
+
+   measurement.time_us = elapsed_us(start);
+   return measurement;
+}
+
+/********************************************************************************
+* legacy_push_pop: Genomfr angivet antal push fljt av lika mnga pop med
+*                  en omallokering per element, dr sista pop frigr minnet.
+*
+*                  - count: Antalet element.
+********************************************************************************/
+benchmark::result benchmark::legacy_push_pop(const uint16_t count)
+{
+   result measurement;
+   uint16_t* data = nullptr;
+   size_t size = 0;
+   const auto start = power::now();
+
+   for (uint16_t i = 0; i < count; ++i)
+   {
+      auto copy = static_cast<uint16_t*>(realloc(data, sizeof(uint16_t) * (size + 1)));
+      measurement.allocations++;
+      if (!copy) break;
+      copy[size++] = i;
+      data = copy;
+   }
+
+   while (size > 1)
+   {
+      auto copy = static_cast<uint16_t*>(realloc(data, sizeof(uint16_t) * (size - 1)));
+      measurement.allocations++;
+      if (!copy) break;
+      data = copy;
+      size--;
+   }
+
+   free(data);
+   measurement.time_us = elapsed_us(start);
+   return measurement;
+}
+
+/********************************************************************************
+* print_vector: Genomfr bda mtningarna fr 16, 64 samt 256 element och
+*               skriver ut antalet minnesanrop samt tiden fr respektive
+*               implementering.
+********************************************************************************/
+void benchmark::print_vector(void)
+{
+   static constexpr uint16_t counts[] = { 16, 64, 256 };
+   serial::print("push/pop count: legacy allocations (us), vector allocations (us)\n");
+
+   for (auto count : counts)
+   {
+      const auto legacy = legacy_push_pop(count);
+      const auto current = vector_push_pop(count);
+
+      serial::print_unsigned(count);
+      serial::print(": ");
+      serial::print_unsigned(legacy.allocations);
+      serial::print(" (");
+      serial::print_unsigned(legacy.time_us);
+      serial::print("), ");
+      serial::print_unsigned(current.allocations);
+      serial::print(" (");
+      serial::print_unsigned(current.time_us);
+      serial::print(")\n");
+   }
+   return;
+}
\ No newline at end of file
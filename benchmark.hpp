@@ -0,0 +1,67 @@
+/********************************************************************************
+* benchmark.hpp: Innehller mtning av kostnaden fr push och pop i vector,
+*                jmfrt med den tidigare implementeringen som omallokerade
+*                minnet vid varje push och pop.
+*
+*                Antalet anrop till malloc/realloc rknas (exklusive
+*                frigrandet av minnet p slutet) tillsammans med tiden fr
+*                count push fljt av count pop av 16-bitars element. Tiden
+*                mts via tidsbasen i power, s power::init mste ha anropats,
+*                och upplsningen r drmed en tick (64 us). Resultatet skrivs
+*                ut via print_vector, exempelvis:
+*
+*                serial::init();
+*                power::init();
+*                benchmark::print_vector();
+*
+*                Frvntat antal minnesanrop fr 16, 64 respektive 256 element
+*                r 31, 127 och 511 fr den tidigare implementeringen samt
+*                5, 9 och 12 fr vector.
+********************************************************************************/
+#ifndef BENCHMARK_HPP_
+#define BENCHMARK_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+
+/********************************************************************************
+* benchmark: Namnrymd innehllande prestandamtningar.
+********************************************************************************/
+namespace benchmark
+{
+   /********************************************************************************
+   * result: Strukt fr resultatet av en mtning.
+   ********************************************************************************/
+   struct result
+   {
+      uint16_t allocations = 0; /* Antalet anrop till malloc/realloc. */
+      uint32_t time_us = 0;     /* Uppmtt tid mtt i mikrosekunder. */
+   };
+
+   /********************************************************************************
+   * vector_push_pop: Genomfr angivet antal push fljt av lika mnga pop p en
+   *                  vector<uint16_t> och returnerar antalet omallokeringar
+   *                  samt uppmtt tid.
+   *
+   *                  - count: Antalet element.
+   ********************************************************************************/
+   result vector_push_pop(const uint16_t count);
+
+   /********************************************************************************
+   * legacy_push_pop: Genomfr angivet antal push fljt av lika mnga pop med
+   *                  en omallokering per element, ssom vector tidigare
+   *                  implementerades, och returnerar antalet omallokeringar
+   *                  samt uppmtt tid.
+   *
+   *                  - count: Antalet element.
+   ********************************************************************************/
+   result legacy_push_pop(const uint16_t count);
+
+   /********************************************************************************
+   * print_vector: Genomfr bda mtningarna fr 16, 64 samt 256 element och
+   *               skriver ut resultatet via seriell verfring.
+   ********************************************************************************/
+   void print_vector(void);
+}
+
+#endif /* BENCHMARK_HPP_ */
\ No newline at end of file
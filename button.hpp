@@ -4,18 +4,31 @@
 *             fungerar ocks utmrkt fr andra digitala inportar dr insignalen
 *             ska kunna lsas av samt avbrott ska kunna genereras vid ett
 *             godtyckligt event.
+*
+*             En avbrottsrutin kan passeras vid initiering, vilken d lagras
+*             fr aktuell I/O-ports avbrottsvektor via dispatch-lagret i
+*             interrupt.hpp. Avbrottsvektorn delas av samtliga pinnar p
+*             samma I/O-port, s senast lagrad avbrottsrutin gller fr porten.
+*
+*             Fr tryckknappar vars pin r knd vid kompileringen finns ven
+*             klassen basic_button, som har samma grnssnitt men bygger p
+*             pin<N> i pin.hpp, s att avlsning kompileras till en enda
+*             sbis/sbic-instruktion utan RAM-tgng fr registren.
 ********************************************************************************/
 #ifndef BUTTON_HPP_
 #define BUTTON_HPP_
 
 /* Inkluderingsdirektiv: */
 #include "misc.hpp"
+#include "interrupt.hpp"
+#include "pin.hpp"
 
 /********************************************************************************
 * button: Klass fr implementering av tryckknappar och andra digitala inportar.
 *         PCI-avbrott kan aktiveras p aktuell pin. Drmed fr eventdetektering
 *         implementeras av anvndaren, d PCI-avbrott inte mjliggr kontroll
-*         av vilken flank som avbrott ska ske p.
+*         av vilken flank som avbrott ska ske p. Alternativt kan pcint.hpp
+*         anvndas, som avgr ndrad pin och flank per I/O-port.
 ********************************************************************************/
 class button
 {
@@ -36,13 +49,17 @@ public:
    /********************************************************************************
    * button: Initierar ny tryckknapp p angiven pin.
    *
-   *         - pin : Tryckknappens pin-nummer p Arduino Uno, exempelvis 13.
-   *                 Alternativt kan motsvarande port-nummer p ATmega328P anges,
-   *                 exempelvis B5 fr pin 13 eller D3 fr pin 3.
+   *         - pin     : Tryckknappens pin-nummer p Arduino Uno, exempelvis 13.
+   *                     Alternativt kan motsvarande port-nummer p ATmega328P
+   *                     anges, exempelvis B5 fr pin 13 eller D3 fr pin 3.
+   *         - callback: Avbrottsrutin fr PCI-avbrott p aktuell I/O-port
+   *                     (default = ingen, avbrottsvektorn skrivs d av
+   *                     anvndaren).
    ********************************************************************************/
-   button(const uint8_t pin)
+   button(const uint8_t pin,
+          void (*callback)(void) = nullptr)
    {
-      this->init(pin); 
+      this->init(pin, callback); 
       return;
    }
 
@@ -73,6 +90,14 @@ public:
       return this->pin_;
    }
 
+   /********************************************************************************
+   * port: Returnerar I/O-porten som tryckknappen r ansluten till.
+   ********************************************************************************/
+   enum io_port port(void) const
+   {
+      return static_cast<io_port>(this->pcint_);
+   }
+
    /********************************************************************************
    * clear: Nollstller lysdiod samt motsvarande pin.
    ********************************************************************************/
@@ -100,11 +125,15 @@ public:
    /********************************************************************************
    * init: Initierar ny tryckknapp p angiven pin.
    *
-   *       - pin : Tryckknappens pin-nummer p Arduino Uno, exempelvis 13.
-   *               Alternativt kan motsvarande port-nummer p ATmega328P anges,
-   *               exempelvis B5 fr pin 13 eller D3 fr pin 3.
+   *       - pin     : Tryckknappens pin-nummer p Arduino Uno, exempelvis 13.
+   *                   Alternativt kan motsvarande port-nummer p ATmega328P
+   *                   anges, exempelvis B5 fr pin 13 eller D3 fr pin 3.
+   *       - callback: Avbrottsrutin fr PCI-avbrott p aktuell I/O-port
+   *                   (default = ingen, avbrottsvektorn skrivs d av
+   *                   anvndaren).
    ********************************************************************************/
-   void init(const uint8_t pin)
+   void init(const uint8_t pin,
+             void (*callback)(void) = nullptr)
    {
       if (pin >= 0 && pin <= 7)
       {
@@ -132,6 +161,7 @@ public:
       }
       
       *(this->pullup_) |= (1 << this->pin_);
+      if (callback) interrupt::attach_pcint(static_cast<io_port>(this->pcint_), callback);
       return;
    }
 
@@ -197,4 +227,144 @@ public:
 
 };
 
+/********************************************************************************
+* basic_button: Generisk klass fr tryckknappar vars pin bestms vid
+*               kompileringen via angiven pin-typ, exempelvis pin<13>, med
+*               samma grnssnitt som klassen button. Samtliga medlemmar r
+*               statiska och klassen saknar datamedlemmar, s att ven
+*               maskregistret och PCI-biten r konstanter, exempelvis:
+*
+*               basic_button<pin<13>> b1;
+*               if (b1.is_pressed()) ...
+*
+*               Klassen kan inte anvndas i debounce eller gesture, som
+*               krver referenser till objekt av klassen button.
+********************************************************************************/
+template<class Pin>
+class basic_button
+{
+private:
+
+   /********************************************************************************
+   * pcmsk: Returnerar en referens till maskregistret fr PCI-avbrott p aktuell
+   *        I/O-port.
+   ********************************************************************************/
+   static inline volatile uint8_t& pcmsk(void)
+   {
+      if constexpr (Pin::PORT == io_port::b) return PCMSK0;
+      else if constexpr (Pin::PORT == io_port::c) return PCMSK1;
+      else return PCMSK2;
+   }
+
+public:
+
+   /********************************************************************************
+   * basic_button: Initierar ny tryckknapp p angiven pin.
+   *
+   *               - callback: Avbrottsrutin fr PCI-avbrott p aktuell I/O-port
+   *                           (default = ingen, avbrottsvektorn skrivs d av
+   *                           anvndaren).
+   ********************************************************************************/
+   basic_button(void (*callback)(void) = nullptr)
+   {
+      basic_button::init(callback);
+      return;
+   }
+
+   /********************************************************************************
+   * pin: Returnerar tryckknappens pin-nummer p aktuell I/O-port.
+   ********************************************************************************/
+   static constexpr uint8_t pin(void)
+   {
+      return Pin::BIT;
+   }
+
+   /********************************************************************************
+   * port: Returnerar I/O-porten som tryckknappen r ansluten till.
+   ********************************************************************************/
+   static constexpr enum io_port port(void)
+   {
+      return Pin::PORT;
+   }
+
+   /********************************************************************************
+   * clear: Nollstller tryckknapp samt motsvarande pin.
+   ********************************************************************************/
+   static inline void clear(void)
+   {
+      basic_button::disable_interrupt();
+      Pin::set_input(false);
+      return;
+   }
+
+   /********************************************************************************
+   * interrupt_enabled: Indikerar ifall PCI-avbrott r aktiverat p knappens pin.
+   ********************************************************************************/
+   static inline bool interrupt_enabled(void)
+   {
+      return pcmsk() & Pin::MASK;
+   }
+
+   /********************************************************************************
+   * init: Initierar tryckknappen som inport med intern pullup-resistor.
+   *
+   *       - callback: Avbrottsrutin fr PCI-avbrott p aktuell I/O-port
+   *                   (default = ingen, avbrottsvektorn skrivs d av
+   *                   anvndaren).
+   ********************************************************************************/
+   static inline void init(void (*callback)(void) = nullptr)
+   {
+      Pin::set_input(true);
+      if (callback) interrupt::attach_pcint(Pin::PORT, callback);
+      return;
+   }
+
+   /********************************************************************************
+   * is_pressed: Lser av tryckknappens pin och indikerar ifall denna r
+   *             nedtryckt (sbis/sbic). I s fall returneras true, annars false.
+   ********************************************************************************/
+   static inline bool is_pressed(void)
+   {
+      return Pin::read();
+   }
+
+   /********************************************************************************
+   * enable_interrupt: Aktiverar PCI-avbrott p tryckknappens pin, bde p
+   *                   stigande och fallande flank. Se button::enable_interrupt
+   *                   fr sambandet mellan I/O-port och avbrottsvektor.
+   ********************************************************************************/
+   static inline void enable_interrupt(void)
+   {
+      asm("SEI");
+      PCICR |= (1 << static_cast<uint8_t>(Pin::PORT));
+      pcmsk() |= Pin::MASK;
+      return;
+   }
+
+   /********************************************************************************
+   * disable_interrupt: Inaktiverar PCI-avbrott p tryckknappens pin.
+   ********************************************************************************/
+   static inline void disable_interrupt(void)
+   {
+      pcmsk() &= ~Pin::MASK;
+      return;
+   }
+
+   /********************************************************************************
+   * toggle_interrupt: Togglar aktivering av PCI-avbrott p tryckknappens pin.
+   ********************************************************************************/
+   static inline void toggle_interrupt(void)
+   {
+      if (basic_button::interrupt_enabled())
+      {
+         basic_button::disable_interrupt();
+      }
+      else
+      {
+         basic_button::enable_interrupt();
+      }
+      return;
+   }
+};
+
 #endif /* BUTTON_HPP_ */
\ No newline at end of file
@@ -0,0 +1,285 @@
+/********************************************************************************
+* capture.cpp: Innehller drivrutiner fr Input Capture via Timer 1 p pin
+*              ICP1 (PORTB0 / pin 8 p Arduino Uno).
+********************************************************************************/
+#include "capture.hpp"
+#include "interrupt.hpp"
+#include "atomic.hpp"
+
+/********************************************************************************
+* measurement: Strukt fr lagring av senast uppmtta periodtid och pulsbredd,
+*              vilka skrivs tillsammans av avbrottsrutinen och drmed alltid
+*              ska lsas som ett par.
+********************************************************************************/
+struct measurement
+{
+   uint32_t period = 0;    /* Senast uppmtta periodtid i ticks. */
+   uint32_t high_time = 0; /* Senast uppmtta pulsbredd i ticks. */
+};
+
+/* Statiska variabler: */
+static volatile uint16_t overflow_count = 0;             /* Rknarvrdets vre 16 bitar. */
+static capture::event buffer[capture::BUFFER_SIZE];      /* Ringbuffert fr tidsstmplar. */
+static volatile uint8_t head = 0;                        /* Index fr nsta skrivning (avbrottsrutin). */
+static volatile uint8_t tail = 0;                        /* Index fr nsta lsning (huvudprogram). */
+static volatile bool buffer_overrun = false;             /* Indikerar frlorade tidsstmplar. */
+static uint32_t last_reference = 0;                      /* Senaste tidsstmpel fr referensflanken. */
+static atomic<uint32_t> last_capture;                    /* Senaste tidsstmpel oavsett flank. */
+static measurement current;                              /* Pgende mtning (anvnds endast av avbrottsrutinen). */
+static seqlock<measurement> latest;                      /* Senast slutfrda mtning. */
+static volatile uint8_t reference_count = 0;             /* Antalet detekterade referensflanker (max 2). */
+static bool both_edges = false;                          /* Indikerar ifall bda flanker ska detekteras. */
+static uint16_t divider = 8;                             /* Prescaler fr Timer 1 som heltal. */
+
+/********************************************************************************
+* on_overflow: Avbrottsrutin som ger rum vid overflow av Timer 1. Rknarvrdets
+*              vre 16 bitar rknas upp. Rutinen lagras fr avbrottsvektor
+*              TIMER1_OVF_vect via dispatch-lagret.
+********************************************************************************/
+static void on_overflow(void)
+{
+   overflow_count++;
+   return;
+}
+
+/********************************************************************************
+* init: Initierar Input Capture p pin ICP1 (PORTB0 / pin 8). Timer 1 stts
+*       i Normal Mode, dr avbrott sker vid varje capture samt overflow.
+*
+*       - capture_edge   : Flank som ska generera tidsstmpel.
+*       - timer_prescaler: Prescaler fr Timer 1.
+*       - noise_canceler : Indikerar ifall brusfiltret ska aktiveras.
+*       - pullup         : Indikerar ifall intern pullup-resistor ska aktiveras.
+********************************************************************************/
+void capture::init(const edge capture_edge,
+                   const prescaler timer_prescaler,
+                   const bool noise_canceler,
+                   const bool pullup)
+{
+   capture::clear();
+
+   DDRB &= ~(1 << PORTB0);
+   if (pullup) PORTB |= (1 << PORTB0);
+
+   if (timer_prescaler == prescaler::_1) divider = 1;
+   else if (timer_prescaler == prescaler::_8) divider = 8;
+   else if (timer_prescaler == prescaler::_64) divider = 64;
+   else if (timer_prescaler == prescaler::_256) divider = 256;
+   else divider = 1024;
+
+   both_edges = capture_edge == edge::both;
+
+   TCCR1A = 0x00;
+   TCNT1 = 0;
+   TCCR1B = static_cast<uint8_t>(timer_prescaler);
+   if (noise_canceler) TCCR1B |= (1 << ICNC1);
+   if (capture_edge != edge::falling) TCCR1B |= (1 << ICES1);
+
+   interrupt::attach<interrupt::vector::timer1_ovf>(&on_overflow);
+   TIFR1 = (1 << ICF1) | (1 << TOV1);
+   TIMSK1 = (1 << ICIE1) | (1 << TOIE1);
+   asm("SEI");
+   return;
+}
+
+/********************************************************************************
+* clear: Stnger av Timer 1 samt nollstller ringbufferten och mtvrden.
+********************************************************************************/
+void capture::clear(void)
+{
+   TIMSK1 = 0x00;
+   TCCR1B = 0x00;
+
+   overflow_count = 0;
+   head = 0;
+   tail = 0;
+   buffer_overrun = false;
+   last_reference = 0;
+   last_capture.store(0);
+   current = measurement();
+   latest.write(current);
+   reference_count = 0;
+   return;
+}
+
+/********************************************************************************
+* now: Returnerar aktuellt 32-bitars rknarvrde fr Timer 1 mtt i ticks.
+*      Om ett overflow har gt rum men nnu inte hanterats kompenseras detta.
+********************************************************************************/
+uint32_t capture::now(void)
+{
+   critical_section lock;
+   auto high = overflow_count;
+   const uint16_t low = TCNT1;
+   if ((TIFR1 & (1 << TOV1)) && low < 0x8000) high++;
+   return (static_cast<uint32_t>(high) << 16) | low;
+}
+
+/********************************************************************************
+* ticks_per_second: Returnerar antalet ticks per sekund fr Timer 1.
+********************************************************************************/
+uint32_t capture::ticks_per_second(void)
+{
+   return F_CPU / divider;
+}
+
+/********************************************************************************
+* available: Returnerar antalet tidsstmplar lagrade i ringbufferten.
+********************************************************************************/
+uint8_t capture::available(void)
+{
+   return static_cast<uint8_t>(head - tail) & (BUFFER_SIZE - 1);
+}
+
+/********************************************************************************
+* read: Lser nsta tidsstmpel frn ringbufferten. Om en tidsstmpel fanns
+*       lagrad returneras true, annars false. Endast huvudprogrammet skriver
+*       till tail och endast avbrottsrutinen skriver till head, vilket gr att
+*       ingen kritisk sektion krvs. Tidsstmpeln kopieras innan tail
+*       uppdateras, vilket skerstlls via en minnesbarrir, s att
+*       avbrottsrutinen inte kan skriva ver platsen under kopieringen.
+*
+*       - event: Referens till strukt dr tidsstmpeln lagras.
+********************************************************************************/
+bool capture::read(event& event)
+{
+   if (head == tail) return false;
+   event = buffer[tail];
+   memory_barrier();
+   tail = (tail + 1) & (BUFFER_SIZE - 1);
+   return true;
+}
+
+/********************************************************************************
+* overrun: Indikerar ifall tidsstmplar har gtt frlorade p grund av full
+*          ringbuffert sedan senaste anrop. Flaggan nollstlls vid anrop.
+********************************************************************************/
+bool capture::overrun(void)
+{
+   const bool overrun = buffer_overrun;
+   buffer_overrun = false;
+   return overrun;
+}
+
+/********************************************************************************
+* period_ticks: Returnerar senast uppmtta periodtid mtt i ticks.
+********************************************************************************/
+uint32_t capture::period_ticks(void)
+{
+   return latest.read().period;
+}
+
+/********************************************************************************
+* high_ticks: Returnerar senast uppmtta pulsbredd mtt i ticks.
+********************************************************************************/
+uint32_t capture::high_ticks(void)
+{
+   return latest.read().high_time;
+}
+
+/********************************************************************************
+* period_us: Returnerar senast uppmtta periodtid mtt i mikrosekunder.
+********************************************************************************/
+double capture::period_us(void)
+{
+   return capture::period_ticks() * 1000000.0 / capture::ticks_per_second();
+}
+
+/********************************************************************************
+* pulse_width_us: Returnerar senast uppmtta pulsbredd mtt i mikrosekunder.
+********************************************************************************/
+double capture::pulse_width_us(void)
+{
+   return capture::high_ticks() * 1000000.0 / capture::ticks_per_second();
+}
+
+/********************************************************************************
+* frequency_hz: Returnerar senast uppmtta frekvens mtt i Hz. Om ingen
+*               period har uppmtts returneras 0.
+********************************************************************************/
+double capture::frequency_hz(void)
+{
+   const auto period = capture::period_ticks();
+   return period ? static_cast<double>(capture::ticks_per_second()) / period : 0.0;
+}
+
+/********************************************************************************
+* duty_cycle: Returnerar senast uppmtta duty cycle som ett flyttal mellan
+*             0 - 1. Periodtid samt pulsbredd lses som en gonblicksbild,
+*             s att bda vrdena avser samma period.
+********************************************************************************/
+double capture::duty_cycle(void)
+{
+   const auto snapshot = latest.read();
+   return snapshot.period ? static_cast<double>(snapshot.high_time) / snapshot.period : 0.0;
+}
+
+/********************************************************************************
+* stalled: Indikerar ifall ingen flank har detekterats under angiven tid.
+*
+*          - timeout_ms: Maximal tid mellan tv flanker mtt i millisekunder.
+********************************************************************************/
+bool capture::stalled(const uint32_t timeout_ms)
+{
+   const auto timeout_ticks = static_cast<uint32_t>(timeout_ms * (capture::ticks_per_second() / 1000.0));
+   return capture::now() - last_capture.load() > timeout_ticks;
+}
+
+/********************************************************************************
+* ISR (TIMER1_CAPT_vect): Avbrottsrutin som ger rum vid capture p pin ICP1.
+*                         Tidsstmpeln utkas till 32 bitar, dr ett overflow
+*                         som intrffat fre capture men nnu inte hanterats
+*                         kompenseras. Vid detektering av bda flanker byts
+*                         flank efter varje capture, varefter flaggan ICF1
+*                         nollstlls enligt databladet. Periodtid och pulsbredd
+*                         uppdateras och publiceras som ett par via seqlock,
+*                         fljt av att tidsstmpeln lagras i ringbufferten.
+********************************************************************************/
+ISR (TIMER1_CAPT_vect)
+{
+   const uint16_t low = ICR1;
+   auto high = overflow_count;
+   if ((TIFR1 & (1 << TOV1)) && low < 0x8000) high++;
+
+   const auto time = (static_cast<uint32_t>(high) << 16) | low;
+   const bool rising = TCCR1B & (1 << ICES1);
+
+   if (both_edges)
+   {
+      TCCR1B ^= (1 << ICES1);
+      TIFR1 = (1 << ICF1);
+   }
+
+   if (rising || !both_edges)
+   {
+      if (reference_count < 2) reference_count++;
+
+      if (reference_count == 2)
+      {
+         current.period = time - last_reference;
+         latest.write(current);
+      }
+      last_reference = time;
+   }
+   else if (reference_count)
+   {
+      current.high_time = time - last_reference;
+   }
+
+   last_capture.store(time);
+
+   const uint8_t next = (head + 1) & (capture::BUFFER_SIZE - 1);
+
+   if (next == tail)
+   {
+      buffer_overrun = true;
+   }
+   else
+   {
+      buffer[head].time = time;
+      buffer[head].rising = rising;
+      memory_barrier();
+      head = next;
+   }
+   return;
+}
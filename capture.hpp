@@ -0,0 +1,163 @@
+/********************************************************************************
+* capture.hpp: Innehller drivrutiner fr Input Capture via Timer 1 p pin
+*              ICP1 (PORTB0 / pin 8 p Arduino Uno), vilket mjliggr
+*              cykelexakt mtning av periodtid, frekvens samt duty cycle fr
+*              exempelvis varvtalsgivare och fldesmtare.
+*
+*              Vid vald flank kopierar hrdvaran Timer 1:s rknarvrde till
+*              registret ICR1, vilket gr att tidsstmpeln inte pverkas av
+*              avbrottslatens. Rknarvrdet utkas till 32 bitar via upprkning
+*              vid overflow, s att ven lnga perioder kan mtas. Samtliga
+*              tidsstmplar lagras i en ringbuffert, som kan lsas av frn
+*              huvudprogrammet.
+*
+*              Timer 1 anvnds exklusivt av denna drivrutin nr capture::init
+*              har anropats, vilket innebr att timer-objekt inte fr anvnda
+*              timer::sel::timer1 samtidigt. Avbrottsvektorn TIMER1_CAPT_vect
+*              implementeras i capture.cpp, medan overflow-avbrott hanteras
+*              via dispatch-lagret i interrupt.hpp.
+********************************************************************************/
+#ifndef CAPTURE_HPP_
+#define CAPTURE_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+
+/********************************************************************************
+* capture: Namnrymd innehllande drivrutiner fr Input Capture p pin ICP1.
+********************************************************************************/
+namespace capture
+{
+   static constexpr auto BUFFER_SIZE = 16; /* Ringbuffertens kapacitet (mste vara en tvpotens). */
+
+   /********************************************************************************
+   * edge: Enumerationsklass fr val av flank som ska generera tidsstmpel.
+   ********************************************************************************/
+   enum class edge
+   {
+      falling, /* Fallande flank. */
+      rising,  /* Stigande flank. */
+      both     /* Bda flanker, krvs fr mtning av pulsbredd samt duty cycle. */
+   };
+
+   /********************************************************************************
+   * prescaler: Enumerationsklass fr val av prescaler fr Timer 1. Vrdena
+   *            motsvarar bitarna CS12 - CS10 i registret TCCR1B.
+   ********************************************************************************/
+   enum class prescaler
+   {
+      _1    = (1 << CS10),               /* 16 MHz, 62.5 ns upplsning. */
+      _8    = (1 << CS11),               /* 2 MHz, 0.5 us upplsning. */
+      _64   = (1 << CS11) | (1 << CS10), /* 250 kHz, 4 us upplsning. */
+      _256  = (1 << CS12),               /* 62.5 kHz, 16 us upplsning. */
+      _1024 = (1 << CS12) | (1 << CS10)  /* 15.625 kHz, 64 us upplsning. */
+   };
+
+   /********************************************************************************
+   * event: Strukt fr lagring av en tidsstmpel i ringbufferten.
+   ********************************************************************************/
+   struct event
+   {
+      uint32_t time = 0;   /* Tidsstmpel mtt i ticks fr Timer 1. */
+      bool rising = false; /* Indikerar ifall tidsstmpeln avser en stigande flank. */
+   };
+
+   /********************************************************************************
+   * init: Initierar Input Capture p pin ICP1 (PORTB0 / pin 8). Timer 1 stts
+   *       i Normal Mode, dr avbrott sker vid varje capture samt overflow.
+   *
+   *       - capture_edge   : Flank som ska generera tidsstmpel.
+   *       - timer_prescaler: Prescaler fr Timer 1 (default = 8, vilket ger
+   *                          0.5 us upplsning och 32-bitars tidsstmplar
+   *                          som rcker i ca 36 minuter).
+   *       - noise_canceler : Indikerar ifall brusfiltret ska aktiveras, vilket
+   *                          krver fyra lika samplingar i rad och frdrjer
+   *                          tidsstmpeln med fyra klockcykler (default = true).
+   *       - pullup         : Indikerar ifall intern pullup-resistor ska
+   *                          aktiveras (default = false).
+   ********************************************************************************/
+   void init(const edge capture_edge,
+             const prescaler timer_prescaler = prescaler::_8,
+             const bool noise_canceler = true,
+             const bool pullup = false);
+
+   /********************************************************************************
+   * clear: Stnger av Timer 1 samt nollstller ringbufferten och mtvrden.
+   ********************************************************************************/
+   void clear(void);
+
+   /********************************************************************************
+   * now: Returnerar aktuellt 32-bitars rknarvrde fr Timer 1 mtt i ticks.
+   ********************************************************************************/
+   uint32_t now(void);
+
+   /********************************************************************************
+   * ticks_per_second: Returnerar antalet ticks per sekund fr Timer 1.
+   ********************************************************************************/
+   uint32_t ticks_per_second(void);
+
+   /********************************************************************************
+   * available: Returnerar antalet tidsstmplar lagrade i ringbufferten.
+   ********************************************************************************/
+   uint8_t available(void);
+
+   /********************************************************************************
+   * read: Lser nsta tidsstmpel frn ringbufferten. Om en tidsstmpel fanns
+   *       lagrad returneras true, annars false.
+   *
+   *       - event: Referens till strukt dr tidsstmpeln lagras.
+   ********************************************************************************/
+   bool read(event& event);
+
+   /********************************************************************************
+   * overrun: Indikerar ifall tidsstmplar har gtt frlorade p grund av full
+   *          ringbuffert sedan senaste anrop. Flaggan nollstlls vid anrop.
+   ********************************************************************************/
+   bool overrun(void);
+
+   /********************************************************************************
+   * period_ticks: Returnerar senast uppmtta periodtid mtt i ticks, allts
+   *               tiden mellan tv stigande flanker (eller tv av vald flank).
+   *               Om frre n tv flanker har detekterats returneras 0.
+   ********************************************************************************/
+   uint32_t period_ticks(void);
+
+   /********************************************************************************
+   * high_ticks: Returnerar senast uppmtta pulsbredd (tiden mellan stigande
+   *             och fallande flank) mtt i ticks. Krver edge::both.
+   ********************************************************************************/
+   uint32_t high_ticks(void);
+
+   /********************************************************************************
+   * period_us: Returnerar senast uppmtta periodtid mtt i mikrosekunder.
+   ********************************************************************************/
+   double period_us(void);
+
+   /********************************************************************************
+   * pulse_width_us: Returnerar senast uppmtta pulsbredd mtt i mikrosekunder.
+   *                 Krver edge::both.
+   ********************************************************************************/
+   double pulse_width_us(void);
+
+   /********************************************************************************
+   * frequency_hz: Returnerar senast uppmtta frekvens mtt i Hz. Om ingen
+   *               period har uppmtts returneras 0.
+   ********************************************************************************/
+   double frequency_hz(void);
+
+   /********************************************************************************
+   * duty_cycle: Returnerar senast uppmtta duty cycle som ett flyttal mellan
+   *             0 - 1. Krver edge::both.
+   ********************************************************************************/
+   double duty_cycle(void);
+
+   /********************************************************************************
+   * stalled: Indikerar ifall ingen flank har detekterats under angiven tid,
+   *          exempelvis fr att detektera att en flkt har stannat.
+   *
+   *          - timeout_ms: Maximal tid mellan tv flanker mtt i millisekunder.
+   ********************************************************************************/
+   bool stalled(const uint32_t timeout_ms);
+}
+
+#endif /* CAPTURE_HPP_ */
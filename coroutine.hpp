@@ -0,0 +1,236 @@
+/********************************************************************************
+* coroutine.hpp: Innehller stacklsa korutiner (protothreads) fr sekvenser
+*                som annars skulle implementeras med blockerande frdrjningar
+*                via misc::delay_ms. En korutin skrivs som vanlig rak kod, men
+*                lmnar tillbaka kontrollen till anroparen vid varje vntan och
+*                fortstter dr den slutade vid nsta anrop. vrigt arbete,
+*                ssom tasks i scheduler.hpp, kan drmed kras under vntan.
+*
+*                Korutinens tillstnd utgrs endast av ett coroutine-objekt p
+*                ngra f byte (terupptagningspunkt, deadline samt rknare),
+*                s ingen egen stack krvs per korutin. Detta innebr dock att
+*                lokala variabler inte behller sina vrden mellan tv anrop,
+*                utan tillstnd som ska verleva en vntan mste lagras i
+*                coroutine-objektet (via counter) eller i ett annat objekt.
+*
+*                En korutin r en funktion som returnerar true nr sekvensen
+*                r slutfrd, annars false. Sekvensen startas om frn brjan
+*                vid nsta anrop efter att den har slutfrts. Exempel:
+*
+*                bool blink_twice(coroutine& co)
+*                {
+*                   CO_BEGIN(co);
+*                   l1.on();
+*                   CO_AWAIT_MS(co, 100);
+*                   l1.off();
+*                   CO_AWAIT_EVENT(co, button_signal);
+*                   l1.on();
+*                   CO_AWAIT_CONDITION(co, !b1.is_pressed());
+*                   l1.off();
+*                   CO_END(co);
+*                }
+*
+*                Makrona anvnder radnumret som terupptagningspunkt, vilket
+*                innebr att tv vntemakron inte fr placeras p samma rad.
+*                Makrona implementeras via en switch-sats, s korutinen fr
+*                inte sjlv innehlla en switch-sats som omsluter ett makro.
+*                Tiden mts via tidsbasen i power.hpp med en upplsning p 64 us.
+********************************************************************************/
+#ifndef COROUTINE_HPP_
+#define COROUTINE_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "power.hpp"
+
+/********************************************************************************
+* CO_BEGIN: Markerar brjan p en korutin. Exekveringen fortstter frn
+*           senaste terupptagningspunkt.
+*
+*           - co: Korutinens tillstnd (coroutine-objekt).
+********************************************************************************/
+#define CO_BEGIN(co) switch ((co).resume_point()) { case 0:
+
+/********************************************************************************
+* CO_END: Markerar slutet p en korutin. Tillstndet nollstlls, s att
+*         sekvensen startas om vid nsta anrop, och true returneras.
+*
+*         - co: Korutinens tillstnd (coroutine-objekt).
+********************************************************************************/
+#define CO_END(co) } (co).reset(); return true
+
+/********************************************************************************
+* CO_YIELD: Lmnar tillbaka kontrollen till anroparen. Exekveringen fortstter
+*           efter makrot vid nsta anrop.
+*
+*           - co: Korutinens tillstnd (coroutine-objekt).
+********************************************************************************/
+#define CO_YIELD(co) do { (co).set_resume_point(__LINE__); return false; case __LINE__:; } while (0)
+
+/********************************************************************************
+* CO_AWAIT_CONDITION: Vntar tills angivet villkor r sant. Villkoret
+*                     utvrderas vid varje anrop av korutinen.
+*
+*                     - co       : Korutinens tillstnd (coroutine-objekt).
+*                     - condition: Villkoret som ska invntas.
+********************************************************************************/
+#define CO_AWAIT_CONDITION(co, condition) \
+   do { (co).set_resume_point(__LINE__); case __LINE__: if (!(condition)) return false; } while (0)
+
+/********************************************************************************
+* CO_AWAIT_MS: Vntar under angiven tid utan att blockera anroparen.
+*
+*              - co     : Korutinens tillstnd (coroutine-objekt).
+*              - time_ms: Tiden mtt i millisekunder.
+********************************************************************************/
+#define CO_AWAIT_MS(co, time_ms) \
+   do { (co).start_timer(time_ms); CO_AWAIT_CONDITION(co, (co).timer_elapsed()); } while (0)
+
+/********************************************************************************
+* CO_AWAIT_EVENT: Vntar tills angiven signal har notifierats, exempelvis frn
+*                 en avbrottsrutin eller en hndelsehanterare. Signalen
+*                 frbrukas nr vntan avslutas.
+*
+*                 - co    : Korutinens tillstnd (coroutine-objekt).
+*                 - signal: Signalen (coroutine::signal) som ska invntas.
+********************************************************************************/
+#define CO_AWAIT_EVENT(co, signal) CO_AWAIT_CONDITION(co, (signal).take())
+
+/********************************************************************************
+* coroutine: Klass fr lagring av en stackls korutins tillstnd.
+********************************************************************************/
+class coroutine
+{
+private:
+   uint16_t resume_point_ = 0; /* Radnummer dr exekveringen ska fortstta (0 = brjan). */
+   uint32_t deadline_ = 0;     /* Tidpunkt d pgende vntan lper ut mtt i ticks. */
+   uint16_t counter_ = 0;      /* Rknare som behller sitt vrde mellan tv anrop. */
+
+public:
+
+   /********************************************************************************
+   * signal: Klass fr signaler som en korutin kan invnta via CO_AWAIT_EVENT.
+   *         En signal r en flagga p en byte, vilket gr att notify kan
+   *         anropas frn en avbrottsrutin utan kritisk sektion. Multipla
+   *         notifieringar fre vntan rknas som en.
+   ********************************************************************************/
+   class signal
+   {
+   private:
+      volatile bool pending_ = false; /* Indikerar ifall signalen har notifierats. */
+
+   public:
+
+      /********************************************************************************
+      * notify: Notifierar signalen, vilket avslutar en pgende vntan.
+      ********************************************************************************/
+      void notify(void)
+      {
+         this->pending_ = true;
+         return;
+      }
+
+      /********************************************************************************
+      * take: Indikerar ifall signalen har notifierats. Signalen nollstlls i s fall.
+      ********************************************************************************/
+      bool take(void)
+      {
+         if (!this->pending_) return false;
+         this->pending_ = false;
+         return true;
+      }
+   };
+
+   /********************************************************************************
+   * coroutine: Defaultkonstruktor, initierar korutin som startar frn brjan.
+   ********************************************************************************/
+   coroutine(void) { }
+
+   /********************************************************************************
+   * coroutine: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   coroutine(coroutine&) = delete;
+
+   /********************************************************************************
+   * coroutine: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   coroutine& operator= (coroutine&) = delete;
+
+   /********************************************************************************
+   * resume_point: Returnerar radnumret dr exekveringen ska fortstta.
+   ********************************************************************************/
+   uint16_t resume_point(void) const
+   {
+      return this->resume_point_;
+   }
+
+   /********************************************************************************
+   * set_resume_point: Lagrar radnumret dr exekveringen ska fortstta.
+   *
+   *                   - line: Radnumret fr terupptagningspunkten.
+   ********************************************************************************/
+   void set_resume_point(const uint16_t line)
+   {
+      this->resume_point_ = line;
+      return;
+   }
+
+   /********************************************************************************
+   * running: Indikerar ifall korutinen har startats men nnu inte slutfrts.
+   ********************************************************************************/
+   bool running(void) const
+   {
+      return this->resume_point_ != 0;
+   }
+
+   /********************************************************************************
+   * reset: Nollstller korutinen, som d startar frn brjan vid nsta anrop.
+   ********************************************************************************/
+   void reset(void)
+   {
+      this->resume_point_ = 0;
+      this->counter_ = 0;
+      return;
+   }
+
+   /********************************************************************************
+   * counter: Returnerar en referens till korutinens rknare, exempelvis fr
+   *          index i en loop som innehller en vntan. Rknaren nollstlls
+   *          nr korutinen slutfrs.
+   ********************************************************************************/
+   uint16_t& counter(void)
+   {
+      return this->counter_;
+   }
+
+   /********************************************************************************
+   * start_timer: Startar en vntan p angiven tid.
+   *
+   *              - time_ms: Tiden mtt i millisekunder.
+   ********************************************************************************/
+   void start_timer(const uint32_t time_ms)
+   {
+      this->deadline_ = power::now() + power::ms_to_ticks(time_ms);
+      return;
+   }
+
+   /********************************************************************************
+   * timer_elapsed: Indikerar ifall pgende vntan har lpt ut.
+   ********************************************************************************/
+   bool timer_elapsed(void) const
+   {
+      return static_cast<int32_t>(power::now() - this->deadline_) >= 0;
+   }
+
+   /********************************************************************************
+   * deadline: Returnerar tidpunkten d pgende vntan lper ut mtt i ticks,
+   *           vilket kan anvndas fr att frstta processorn i vila via
+   *           power::sleep_until nr inget annat arbete finns.
+   ********************************************************************************/
+   uint32_t deadline(void) const
+   {
+      return this->deadline_;
+   }
+};
+
+#endif /* COROUTINE_HPP_ */
\ No newline at end of file
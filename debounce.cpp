@@ -0,0 +1,178 @@
+/********************************************************************************
+* debounce.cpp: Innehller motor fr parallell avstudsning av tryckknappar
+*               via vertikala rknare.
+********************************************************************************/
+#include "debounce.hpp"
+#include "atomic.hpp"
+
+/********************************************************************************
+* port_state: Strukt fr avstudsning av samtliga pinnar p en I/O-port.
+*             Bit n i respektive byte tillhr pin n p porten.
+********************************************************************************/
+struct port_state
+{
+   uint8_t mask = 0;              /* Pinnar som ska avstudsas. */
+   uint8_t level = 0;             /* Avstudsad niv. */
+   uint8_t count0 = 0;            /* Bit 0 i respektive pins vertikala rknare. */
+   uint8_t count1 = 0;            /* Bit 1 i respektive pins vertikala rknare. */
+   volatile uint8_t pressed = 0;  /* Registrerade nedtryckningar som nnu inte har lsts. */
+   volatile uint8_t released = 0; /* Registrerade uppslppningar som nnu inte har lsts. */
+};
+
+/* Statiska variabler: */
+static port_state ports[3];                                         /* Tillstnd fr I/O-port B, C och D. */
+static volatile uint8_t* const inputs[3] = { &PINB, &PINC, &PIND }; /* Pinregister fr respektive I/O-port. */
+
+/********************************************************************************
+* add: Lgger till angiven tryckknapp i avstudsningen. Avstudsad niv stts
+*      till aktuell niv p pinnen och pinnens rknare stts till vilolget
+*      (bda bitarna ettstllda), frn vilket SAMPLES ticks krvs fr en flank.
+*
+*      - button: Referens till tryckknappen som ska avstudsas.
+********************************************************************************/
+void debounce::add(const button& button)
+{
+   auto& port = ports[static_cast<uint8_t>(button.port())];
+   const uint8_t bit = (1 << button.pin());
+   critical_section lock;
+
+   port.mask |= bit;
+   port.count0 |= bit;
+   port.count1 |= bit;
+   port.pressed &= ~bit;
+   port.released &= ~bit;
+
+   if (button.is_pressed())
+   {
+      port.level |= bit;
+   }
+   else
+   {
+      port.level &= ~bit;
+   }
+   return;
+}
+
+/********************************************************************************
+* remove: Tar bort angiven tryckknapp frn avstudsningen.
+*
+*         - button: Referens till tryckknappen som ska tas bort.
+********************************************************************************/
+void debounce::remove(const button& button)
+{
+   auto& port = ports[static_cast<uint8_t>(button.port())];
+   const uint8_t bit = (1 << button.pin());
+   critical_section lock;
+
+   port.mask &= ~bit;
+   port.pressed &= ~bit;
+   port.released &= ~bit;
+   return;
+}
+
+/********************************************************************************
+* update: Genomfr en tick fr samtliga I/O-portar med tillagda tryckknappar.
+*         Fr pinnar vars avlsning skiljer sig frn avstudsad niv rknas den
+*         vertikala rknaren upp, vriga rknare nollstlls. Nr rknaren slr
+*         om efter SAMPLES ticks togglas avstudsad niv och en flank registreras.
+*
+*         changed = level ^ sample
+*         count0  = ~(count0 & changed)
+*         count1  = count0 ^ (count1 & changed)
+*         toggle  = changed & count0 & count1
+********************************************************************************/
+void debounce::update(void)
+{
+   for (uint8_t i = 0; i < 3; ++i)
+   {
+      auto& port = ports[i];
+      if (!port.mask) continue;
+
+      const uint8_t changed = (port.level ^ *inputs[i]) & port.mask;
+      port.count0 = ~(port.count0 & changed);
+      port.count1 = port.count0 ^ (port.count1 & changed);
+
+      const uint8_t toggle = changed & port.count0 & port.count1;
+      if (!toggle) continue;
+
+      port.level ^= toggle;
+      critical_section lock;
+      port.pressed |= port.level & toggle;
+      port.released |= ~port.level & toggle;
+   }
+   return;
+}
+
+/********************************************************************************
+* is_pressed: Indikerar ifall angiven tryckknapp r nedtryckt efter avstudsning.
+*
+*             - button: Referens till tryckknappen.
+********************************************************************************/
+bool debounce::is_pressed(const button& button)
+{
+   return ports[static_cast<uint8_t>(button.port())].level & (1 << button.pin());
+}
+
+/********************************************************************************
+* pressed: Indikerar ifall angiven tryckknapp har tryckts ned sedan senaste
+*          anrop. Flanken nollstlls vid anrop.
+*
+*          - button: Referens till tryckknappen.
+********************************************************************************/
+bool debounce::pressed(const button& button)
+{
+   auto& port = ports[static_cast<uint8_t>(button.port())];
+   const uint8_t bit = (1 << button.pin());
+   critical_section lock;
+
+   if (!(port.pressed & bit)) return false;
+   port.pressed &= ~bit;
+   return true;
+}
+
+/********************************************************************************
+* released: Indikerar ifall angiven tryckknapp har slppts upp sedan senaste
+*           anrop. Flanken nollstlls vid anrop.
+*
+*           - button: Referens till tryckknappen.
+********************************************************************************/
+bool debounce::released(const button& button)
+{
+   auto& port = ports[static_cast<uint8_t>(button.port())];
+   const uint8_t bit = (1 << button.pin());
+   critical_section lock;
+
+   if (!(port.released & bit)) return false;
+   port.released &= ~bit;
+   return true;
+}
+
+/********************************************************************************
+* pressed_mask: Returnerar samtliga registrerade nedtryckningar p angiven
+*               I/O-port som en bitmask och nollstller dem.
+*
+*               - io_port: I/O-porten vars nedtryckningar ska returneras.
+********************************************************************************/
+uint8_t debounce::pressed_mask(const enum io_port io_port)
+{
+   auto& port = ports[static_cast<uint8_t>(io_port)];
+   critical_section lock;
+   const uint8_t mask = port.pressed;
+   port.pressed = 0;
+   return mask;
+}
+
+/********************************************************************************
+* released_mask: Returnerar samtliga registrerade uppslppningar p angiven
+*                I/O-port som en bitmask och nollstller dem.
+*
+*                - io_port: I/O-porten vars uppslppningar ska returneras.
+********************************************************************************/
+uint8_t debounce::released_mask(const enum io_port io_port)
+{
+   auto& port = ports[static_cast<uint8_t>(io_port)];
+   critical_section lock;
+   const uint8_t mask = port.released;
+   port.released = 0;
+   return mask;
+}
\ No newline at end of file
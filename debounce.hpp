@@ -0,0 +1,101 @@
+/********************************************************************************
+* debounce.hpp: Innehller en motor fr avstudsning av tryckknappar, dr
+*               samtliga pinnar p en I/O-port avstudsas parallellt via
+*               vertikala rknare. Vid varje tick lses varje anvnd I/O-port
+*               en gng (PINx), varefter en 2-bitars rknare per pin rknas
+*               upp fr pinnar vars niv skiljer sig frn avstudsad niv och
+*               nollstlls fr vriga. Rknarens tv bitar lagras i tv byte
+*               (en bit per pin i respektive byte), s att samtliga tta
+*               pinnar p porten uppdateras med ett ftal bitoperationer.
+*               Frst nr nivn har varit stabil under SAMPLES ticks i fljd
+*               ndras avstudsad niv och en flank registreras. SAMPLES r
+*               fast satt till 4, vilket r vad en 2-bitars rknare rymmer;
+*               ett annat vrde krver fler bitplan i debounce.cpp.
+*
+*               Avstudsning av 20 tryckknappar kostar drmed lika mycket som
+*               avstudsning av en, och inga PCI-avbrott eller hrdvarutimers
+*               anvnds. debounce::update anropas periodiskt, frslagsvis var
+*               5:e millisekund frn en task i scheduler.hpp eller frn en
+*               timer, vilket ger en avstudsningstid p 20 ms.
+*
+*               Avstudsad niv fljer samma polaritet som button::is_pressed,
+*               dvs. hg niv p pinnen tolkas som nedtryckt.
+********************************************************************************/
+#ifndef DEBOUNCE_HPP_
+#define DEBOUNCE_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "button.hpp"
+
+/********************************************************************************
+* debounce: Namnrymd innehllande motor fr parallell avstudsning.
+********************************************************************************/
+namespace debounce
+{
+   static constexpr uint8_t SAMPLES = 4; /* Antalet stabila ticks som krvs fr en flank (fast vrde). */
+   static_assert(SAMPLES == 4, "The vertical counter in debounce.cpp has two bit planes, i.e. four samples!");
+
+   /********************************************************************************
+   * add: Lgger till angiven tryckknapp i avstudsningen. Avstudsad niv stts
+   *      till aktuell niv p pinnen, s att ingen flank registreras vid start.
+   *
+   *      - button: Referens till tryckknappen som ska avstudsas.
+   ********************************************************************************/
+   void add(const button& button);
+
+   /********************************************************************************
+   * remove: Tar bort angiven tryckknapp frn avstudsningen.
+   *
+   *         - button: Referens till tryckknappen som ska tas bort.
+   ********************************************************************************/
+   void remove(const button& button);
+
+   /********************************************************************************
+   * update: Genomfr en tick, dr varje I/O-port med minst en tillagd
+   *         tryckknapp lses en gng och samtliga pinnar avstudsas parallellt.
+   *         Kan anropas frn en task eller en avbrottsrutin.
+   ********************************************************************************/
+   void update(void);
+
+   /********************************************************************************
+   * is_pressed: Indikerar ifall angiven tryckknapp r nedtryckt efter avstudsning.
+   *
+   *             - button: Referens till tryckknappen.
+   ********************************************************************************/
+   bool is_pressed(const button& button);
+
+   /********************************************************************************
+   * pressed: Indikerar ifall angiven tryckknapp har tryckts ned sedan senaste
+   *          anrop. Flanken nollstlls vid anrop.
+   *
+   *          - button: Referens till tryckknappen.
+   ********************************************************************************/
+   bool pressed(const button& button);
+
+   /********************************************************************************
+   * released: Indikerar ifall angiven tryckknapp har slppts upp sedan senaste
+   *           anrop. Flanken nollstlls vid anrop.
+   *
+   *           - button: Referens till tryckknappen.
+   ********************************************************************************/
+   bool released(const button& button);
+
+   /********************************************************************************
+   * pressed_mask: Returnerar samtliga registrerade nedtryckningar p angiven
+   *               I/O-port som en bitmask och nollstller dem.
+   *
+   *               - io_port: I/O-porten vars nedtryckningar ska returneras.
+   ********************************************************************************/
+   uint8_t pressed_mask(const enum io_port io_port);
+
+   /********************************************************************************
+   * released_mask: Returnerar samtliga registrerade uppslppningar p angiven
+   *                I/O-port som en bitmask och nollstller dem.
+   *
+   *                - io_port: I/O-porten vars uppslppningar ska returneras.
+   ********************************************************************************/
+   uint8_t released_mask(const enum io_port io_port);
+}
+
+#endif /* DEBOUNCE_HPP_ */
@@ -3,6 +3,7 @@
 *             EEPROM-minnet.
 ********************************************************************************/
 #include "eeprom.hpp"
+#include "atomic.hpp"
 
 /********************************************************************************
 * write_byte: Skriver en byte bestende av ett osignerat heltal till angiven
@@ -20,10 +21,9 @@ int eeprom::write_byte(const uint16_t address,
    EEAR = address;
    EEDR = data;
 
-   asm("CLI");
+   critical_section lock;
    EECR |= (1 << EEMPE);
    EECR |= (1 << EEPE);
-   asm("SEI");
    return 0;
 }
 
@@ -0,0 +1,299 @@
+/********************************************************************************
+* encoder.hpp: Innehller en avkodare fr inkrementella pulsgivare (rotary
+*              encoders) via klassen encoder, exempelvis fr instllning av
+*              brvrden med en vridknapp.
+*
+*              Kanalerna A och B lses av vid varje anrop av update, vilket
+*              sker frn PCI-avbrott (exempelvis via pcint.hpp), externa
+*              avbrott (extint.hpp) eller en timer. Fregende och aktuellt
+*              tillstnd bildar ett index 0 - 15 i en tabell ver giltiga
+*              vergngar, som ger riktningen +1, -1 eller 0 fr ogiltiga
+*              vergngar (studs eller en missad vergng). Ett anrop kostar
+*              ca 40 CPU-cykler, s flera tusen vergngar per sekund hanteras
+*              utan problem.
+*
+*              Positionen rknas i hack (detents), dr ett hack registreras
+*              frst nr summan av vergngarna nr antalet vergngar per
+*              hack (oftast 4) i ngon riktning. Tiden mellan tv hack mts via tidsbasen i
+*              power.hpp, vilken anvnds fr hastighetsberkning samt fr
+*              acceleration, dr snabbare vridning ger strre steg (1, 2, 4
+*              eller 8). Tidsbasen mste drmed vara initierad via power::init.
+*
+*              Exempel med kanalerna p pin 2 och 3:
+*
+*              encoder<> e1(2, 3);
+*              pcint::attach(2, [](const pcint::change&) { e1.update(); });
+*              pcint::attach(3, [](const pcint::change&) { e1.update(); });
+********************************************************************************/
+#ifndef ENCODER_HPP_
+#define ENCODER_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "atomic.hpp"
+#include "power.hpp"
+
+/********************************************************************************
+* encoder: Generisk klass fr avkodning av inkrementella pulsgivare, dr T
+*          utgr typen fr positionen (int16_t eller int32_t).
+********************************************************************************/
+template<class T = int32_t>
+class encoder
+{
+private:
+   static_assert(static_cast<T>(-1) < 0, "Encoder position must be a signed type!");
+
+   /********************************************************************************
+   * transitions: Tabell ver riktning fr respektive vergng, dr index
+   *              utgrs av fregende tillstnd (AB) samt aktuellt tillstnd
+   *              (AB), dvs. (previous << 2) | current.
+   ********************************************************************************/
+   static constexpr int8_t transitions[16] =
+   {
+       0, -1,  1,  0,
+       1,  0,  0, -1,
+      -1,  0,  0,  1,
+       0,  1, -1,  0
+   };
+
+   volatile uint8_t* input_a_ = nullptr; /* Pinregister fr kanal A. */
+   volatile uint8_t* input_b_ = nullptr; /* Pinregister fr kanal B. */
+   uint8_t mask_a_ = 0;                  /* Bitmask fr kanal A. */
+   uint8_t mask_b_ = 0;                  /* Bitmask fr kanal B. */
+   uint8_t state_ = 0;                   /* Fregende tillstnd (AB). */
+   int8_t substeps_ = 0;                 /* Ackumulerade vergngar sedan senaste hack. */
+   int8_t steps_per_detent_ = 4;         /* Antalet vergngar per hack. */
+   int8_t direction_ = 0;                /* Riktning fr senaste hack (+1 eller -1). */
+   uint16_t accel_ticks_ = 0;            /* Tid mellan hack under vilken acceleration sker (0 = av). */
+   uint16_t interval_ = 0xFFFF;          /* Tid mellan de tv senaste hacken mtt i ticks. */
+   uint32_t last_detent_ = 0;            /* Tidpunkt fr senaste hack mtt i ticks. */
+   atomic<T> position_;                  /* Aktuell position. */
+   T last_read_ = 0;                     /* Position vid senaste anrop av delta. */
+
+   /********************************************************************************
+   * init_pin: Tar fram pinregister och bitmask fr angiven pin samt aktiverar
+   *           intern pullup-resistor.
+   *
+   *           - pin  : Pin-nummer p Arduino Uno, exempelvis 2 eller A1.
+   *           - input: Referens till pekare dr pinregistret lagras.
+   *           - mask : Referens till variabel dr bitmasken lagras.
+   ********************************************************************************/
+   static void init_pin(const uint8_t pin,
+                        volatile uint8_t*& input,
+                        uint8_t& mask)
+   {
+      if (pin <= 7)
+      {
+         mask = (1 << pin);
+         input = &PIND;
+         DDRD &= ~mask;
+         PORTD |= mask;
+      }
+      else if (pin <= 13)
+      {
+         mask = (1 << (pin - 8));
+         input = &PINB;
+         DDRB &= ~mask;
+         PORTB |= mask;
+      }
+      else if (pin <= 19)
+      {
+         mask = (1 << (pin - 14));
+         input = &PINC;
+         DDRC &= ~mask;
+         PORTC |= mask;
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * read_state: Returnerar aktuellt tillstnd fr kanalerna, dr kanal A
+   *             utgr bit 1 och kanal B bit 0.
+   ********************************************************************************/
+   uint8_t read_state(void) const
+   {
+      return (*this->input_a_ & this->mask_a_ ? 0x02 : 0x00) |
+             (*this->input_b_ & this->mask_b_ ? 0x01 : 0x00);
+   }
+
+   /********************************************************************************
+   * detent: Registrerar ett hack i angiven riktning. Tiden sedan fregende
+   *         hack lagras, och vid vridning i samma riktning snabbare n
+   *         accelerationstiden kas steget till 2, 4 eller 8 vid en halv,
+   *         en fjrdedel respektive en ttondel av accelerationstiden.
+   *
+   *         - direction: Riktning fr hacket (+1 eller -1).
+   ********************************************************************************/
+   void detent(const int8_t direction)
+   {
+      const uint32_t now = power::now();
+      const uint32_t elapsed = now - this->last_detent_;
+      this->interval_ = elapsed > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(elapsed);
+      this->last_detent_ = now;
+
+      T step = 1;
+
+      if (direction == this->direction_ && this->interval_ < this->accel_ticks_)
+      {
+         if (this->interval_ < (this->accel_ticks_ >> 3)) step = 8;
+         else if (this->interval_ < (this->accel_ticks_ >> 2)) step = 4;
+         else if (this->interval_ < (this->accel_ticks_ >> 1)) step = 2;
+      }
+
+      this->direction_ = direction;
+      this->position_.fetch_add(direction > 0 ? step : -step);
+      return;
+   }
+
+public:
+
+   /********************************************************************************
+   * encoder: Defaultkonstruktor, initierar tomt objekt.
+   ********************************************************************************/
+   encoder(void) { }
+
+   /********************************************************************************
+   * encoder: Initierar avkodare fr pulsgivare med angivna kanaler.
+   *
+   *          - pin_a           : Pin-nummer fr kanal A, exempelvis 2.
+   *          - pin_b           : Pin-nummer fr kanal B, exempelvis 3.
+   *          - steps_per_detent: Antalet vergngar per hack (default = 4).
+   *          - accel_ms        : Tid mellan hack under vilken acceleration
+   *                              sker (default = 40 ms, 0 = ingen acceleration).
+   ********************************************************************************/
+   encoder(const uint8_t pin_a,
+           const uint8_t pin_b,
+           const uint8_t steps_per_detent = 4,
+           const uint16_t accel_ms = 40)
+   {
+      this->init(pin_a, pin_b, steps_per_detent, accel_ms);
+      return;
+   }
+
+   /********************************************************************************
+   * encoder: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   encoder(encoder&) = delete;
+
+   /********************************************************************************
+   * encoder: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   encoder& operator= (encoder&) = delete;
+
+   /********************************************************************************
+   * init: Initierar avkodare fr pulsgivare med angivna kanaler. Kanalerna
+   *       stts till inportar med intern pullup-resistor och positionen
+   *       nollstlls.
+   *
+   *       - pin_a           : Pin-nummer fr kanal A, exempelvis 2.
+   *       - pin_b           : Pin-nummer fr kanal B, exempelvis 3.
+   *       - steps_per_detent: Antalet vergngar per hack (1, 2 eller 4).
+   *       - accel_ms        : Tid mellan hack under vilken acceleration
+   *                           sker (default = 40 ms, 0 = ingen acceleration).
+   ********************************************************************************/
+   void init(const uint8_t pin_a,
+             const uint8_t pin_b,
+             const uint8_t steps_per_detent = 4,
+             const uint16_t accel_ms = 40)
+   {
+      critical_section lock;
+      init_pin(pin_a, this->input_a_, this->mask_a_);
+      init_pin(pin_b, this->input_b_, this->mask_b_);
+
+      const auto accel_ticks = power::ms_to_ticks(accel_ms);
+      this->accel_ticks_ = accel_ticks > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(accel_ticks);
+      this->steps_per_detent_ = steps_per_detent ? steps_per_detent : 1;
+      this->state_ = this->read_state();
+      this->substeps_ = 0;
+      this->direction_ = 0;
+      this->interval_ = 0xFFFF;
+      this->position_.store(0);
+      this->last_read_ = 0;
+      return;
+   }
+
+   /********************************************************************************
+   * update: Lser av kanalerna och uppdaterar positionen via tabellen ver
+   *         vergngar. vergngarna summeras med tecken, s att studs fram
+   *         och tillbaka tar ut sig sjlvt innan ett hack registreras.
+   *         Anropas vid varje ndring p kanalerna, antingen
+   *         frn en avbrottsrutin eller genom sampling med en timer som r
+   *         snabbare n den snabbaste vergngen.
+   ********************************************************************************/
+   void update(void)
+   {
+      const uint8_t state = this->read_state();
+      const int8_t direction = transitions[(this->state_ << 2) | state];
+      this->state_ = state;
+      if (!direction) return;
+
+      this->substeps_ += direction;
+
+      if (this->substeps_ >= this->steps_per_detent_ || this->substeps_ <= -this->steps_per_detent_)
+      {
+         this->substeps_ = 0;
+         this->detent(direction);
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * position: Returnerar aktuell position, vilken lses odelbart.
+   ********************************************************************************/
+   T position(void) const
+   {
+      return this->position_.load();
+   }
+
+   /********************************************************************************
+   * set_position: Stter aktuell position, exempelvis till ett lagrat brvrde.
+   *
+   *               - position: Den nya positionen.
+   ********************************************************************************/
+   void set_position(const T position)
+   {
+      this->position_.store(position);
+      this->last_read_ = position;
+      return;
+   }
+
+   /********************************************************************************
+   * delta: Returnerar frndringen av positionen sedan fregende anrop, vilket
+   *        lmpar sig fr att stega ett brvrde frn huvudloopen.
+   ********************************************************************************/
+   T delta(void)
+   {
+      const T position = this->position_.load();
+      const T delta = position - this->last_read_;
+      this->last_read_ = position;
+      return delta;
+   }
+
+   /********************************************************************************
+   * velocity: Returnerar uppskattad hastighet mtt i hack per sekund, med
+   *           tecken efter riktningen. Hastigheten berknas utifrn tiden
+   *           mellan de tv senaste hacken, eller tiden sedan senaste hack om
+   *           denna r lngre, s att hastigheten avtar mot noll nr vridningen
+   *           upphr. Berkningen sker vid anrop och belastar inte update.
+   ********************************************************************************/
+   int16_t velocity(void) const
+   {
+      uint32_t interval, last_detent;
+      int8_t direction;
+      {
+         critical_section lock;
+         interval = this->interval_;
+         last_detent = this->last_detent_;
+         direction = this->direction_;
+      }
+
+      const uint32_t elapsed = power::now() - last_detent;
+      if (elapsed > interval) interval = elapsed;
+      if (!direction || !interval || interval >= 0xFFFF) return 0;
+
+      const auto velocity = static_cast<int16_t>(1000000.0 / (interval * power::TICK_US) + 0.5);
+      return direction > 0 ? velocity : -velocity;
+   }
+};
+
+#endif /* ENCODER_HPP_ */
\ No newline at end of file
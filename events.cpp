@@ -0,0 +1,96 @@
+/********************************************************************************
+* events.cpp: Innehller hndelsek samt dispatch-loop fr verfring av
+*             arbete frn avbrottsrutiner till huvudprogrammet.
+********************************************************************************/
+#include "events.hpp"
+#include "queue.hpp"
+#include "atomic.hpp"
+
+/* Statiska variabler: */
+static queue<events::event, events::QUEUE_SIZE> event_queue;      /* K med hndelser som ska hanteras. */
+static void (*handlers[events::MAX_TYPES])(const events::event&); /* Hanterare fr respektive hndelsetyp. */
+static atomic<uint16_t> dropped_events;                           /* Antalet tappade hndelser. */
+
+/********************************************************************************
+* attach: Lagrar angiven funktion som hanterare fr angiven hndelsetyp.
+*         Hanterarna anropas endast frn huvudloopen, s ingen kritisk
+*         sektion krvs.
+*
+*         - type   : Hndelsetypen som hanteraren ska anropas fr.
+*         - handler: Pekare till funktionen som ska anropas.
+********************************************************************************/
+void events::attach(const uint8_t type,
+                    void (*handler)(const event&))
+{
+   if (type < MAX_TYPES) handlers[type] = handler;
+   return;
+}
+
+/********************************************************************************
+* post: Lgger en hndelse av angiven typ i kn. Om avbrott r aktiverade
+*       (anrop frn huvudprogrammet) kan anropet avbrytas av en avbrottsrutin
+*       som ocks postar, varvid skrivningen sker i en kritisk sektion. Frn
+*       en avbrottsrutin sker skrivningen helt utan ls.
+*
+*       - type: Hndelsetypen.
+*       - arg : Godtyckligt argument (default = 0).
+*       - data: Godtycklig data (default = 0).
+********************************************************************************/
+bool events::post(const uint8_t type,
+                  const uint8_t arg,
+                  const uint16_t data)
+{
+   event event;
+   event.type = type;
+   event.arg = arg;
+   event.data = data;
+
+   const auto posted = (SREG & (1 << SREG_I)) ? event_queue.push_shared(event) : event_queue.push(event);
+   if (!posted) ++dropped_events;
+   return posted;
+}
+
+/********************************************************************************
+* dispatch: Lser nsta hndelse frn kn och anropar motsvarande hanterare,
+*           frutsatt att en sdan finns. Returnerar true om en hndelse
+*           fanns i kn, annars false.
+********************************************************************************/
+bool events::dispatch(void)
+{
+   event event;
+   if (!event_queue.pop(event)) return false;
+
+   if (event.type < MAX_TYPES && handlers[event.type])
+   {
+      handlers[event.type](event);
+   }
+   return true;
+}
+
+/********************************************************************************
+* dispatch_all: Hanterar samtliga hndelser i kn och returnerar antalet
+*               hanterade hndelser. Hndelser som postas under tiden
+*               hanteras ocks.
+********************************************************************************/
+uint8_t events::dispatch_all(void)
+{
+   uint8_t num_events = 0;
+   while (events::dispatch()) num_events++;
+   return num_events;
+}
+
+/********************************************************************************
+* pending: Returnerar antalet hndelser som vntar p att hanteras.
+********************************************************************************/
+uint8_t events::pending(void)
+{
+   return event_queue.size();
+}
+
+/********************************************************************************
+* dropped: Returnerar antalet hndelser som har tappats p grund av full k.
+********************************************************************************/
+uint16_t events::dropped(void)
+{
+   return dropped_events.load();
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+/********************************************************************************
+* events.hpp: Innehller en hndelsek fr verfring av arbete frn
+*             avbrottsrutiner till huvudprogrammet. Avbrottsrutinen lgger
+*             endast en liten hndelse (typ, argument samt data) i en lsfri
+*             k via events::post, vilket tar ngra tiotal klockcykler. Det
+*             egentliga arbetet, exempelvis seriell verfring eller
+*             skrivning till EEPROM-minnet, utfrs sedan av en hndelse-
+*             hanterare som anropas frn huvudloopen via events::dispatch.
+*             Avbrottsrutinerna blir drmed korta, vilket minskar
+*             avbrottslatensen fr vriga avbrott.
+*
+*             Varje hndelsetyp (0 - MAX_TYPES - 1) kan tilldelas en
+*             hanterare via events::attach. Om kn r full nr en hndelse
+*             postas rknas hndelsen som tappad, vilket kan lsas av via
+*             events::dropped.
+*
+*             Schemalggaren i scheduler.hpp anropar events::dispatch innan
+*             tasks krs och kontrollerar kn innan processorn frstts i vila,
+*             s att en hndelse som postas strax fre vilan inte blir liggande.
+********************************************************************************/
+#ifndef EVENTS_HPP_
+#define EVENTS_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+
+/********************************************************************************
+* events: Namnrymd innehllande hndelsek samt dispatch-loop.
+********************************************************************************/
+namespace events
+{
+   static constexpr uint8_t QUEUE_SIZE = 16; /* Antalet platser i hndelsekn (tvpotens). */
+   static constexpr uint8_t MAX_TYPES = 16;  /* Antalet hndelsetyper som kan tilldelas hanterare. */
+
+   /********************************************************************************
+   * event: Strukt fr lagring av en hndelse. Strukten r fyra byte stor, s
+   *        att kopiering in i och ut ur kn gr snabbt.
+   ********************************************************************************/
+   struct event
+   {
+      uint8_t type = 0;  /* Hndelsetyp, anvnds fr val av hanterare. */
+      uint8_t arg = 0;   /* Godtyckligt argument, exempelvis ett pin-nummer. */
+      uint16_t data = 0; /* Godtycklig data, exempelvis ett mtvrde. */
+   };
+
+   /********************************************************************************
+   * attach: Lagrar angiven funktion som hanterare fr angiven hndelsetyp.
+   *
+   *         - type   : Hndelsetypen som hanteraren ska anropas fr.
+   *         - handler: Pekare till funktionen som ska anropas.
+   ********************************************************************************/
+   void attach(const uint8_t type,
+               void (*handler)(const event&));
+
+   /********************************************************************************
+   * post: Lgger en hndelse av angiven typ i kn. Anropas i frsta hand frn
+   *       avbrottsrutiner, men kan ven anropas frn huvudprogrammet. Om kn
+   *       r full returneras false och hndelsen rknas som tappad.
+   *
+   *       - type: Hndelsetypen.
+   *       - arg : Godtyckligt argument (default = 0).
+   *       - data: Godtycklig data (default = 0).
+   ********************************************************************************/
+   bool post(const uint8_t type,
+             const uint8_t arg = 0,
+             const uint16_t data = 0);
+
+   /********************************************************************************
+   * dispatch: Lser nsta hndelse frn kn och anropar motsvarande hanterare.
+   *           Returnerar true om en hndelse fanns i kn, annars false.
+   *           Anropas frn huvudloopen, aldrig frn en avbrottsrutin.
+   ********************************************************************************/
+   bool dispatch(void);
+
+   /********************************************************************************
+   * dispatch_all: Hanterar samtliga hndelser i kn och returnerar antalet
+   *               hanterade hndelser.
+   ********************************************************************************/
+   uint8_t dispatch_all(void);
+
+   /********************************************************************************
+   * pending: Returnerar antalet hndelser som vntar p att hanteras.
+   ********************************************************************************/
+   uint8_t pending(void);
+
+   /********************************************************************************
+   * dropped: Returnerar antalet hndelser som har tappats p grund av full k.
+   ********************************************************************************/
+   uint16_t dropped(void);
+}
+
+#endif /* EVENTS_HPP_ */
\ No newline at end of file
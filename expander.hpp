@@ -0,0 +1,374 @@
+/********************************************************************************
+* expander.hpp: Innehller drivrutiner fr utgngsexpansion via N seriekopplade
+*               skiftregister av typen 74HC595 via klassen expander, vilket ger
+*               8 * N utgngar via tre pinnar.
+*
+*               Utgngarnas vrden lagras i en skuggbuffert i RAM. Vid ndring
+*               jmfrs bufferten med senast utskiftade ram. Endast om de
+*               skiljer sig markeras bufferten som ndrad (dirty) och en
+*               verfring via hrdvaru-SPI startas, frutsatt att ingen
+*               verfring pgr.
+*               Skuggbufferten kopieras d till en sndbuffert (dubbel-
+*               buffring), s att programmet kan fortstta ndra utgngar
+*               medan verfringen pgr. verfringen drivs av SPI-avbrott,
+*               en byte per avbrott, och nr sista byten r skickad pulsas
+*               latch-pinnen s att samtliga utgngar ndras samtidigt. Om
+*               bufferten har ndrats under verfringen startas en ny direkt,
+*               annars skiftas inget ut frrn nsta ndring.
+*
+*               Utgngarna kan anvndas som lysdioder via attach, som mappar
+*               ett led-objekt mot motsvarande bit i skuggbufferten. Drmed
+*               kan utgngarna styras via led_vector och pwm<T> precis som
+*               lysdioder anslutna direkt till mikrodatorn.
+*
+*               SPI-klockan r 500 kHz (F_CPU / 32), vilket ger 256 CPU-cykler
+*               per byte. Ett SPI-avbrott via dispatch-lagret kostar en
+*               brkdel av detta, medan en byte vid 8 MHz skiftas ut p 16
+*               cykler, dvs. snabbare n avbrottsrutinen, varvid det vore
+*               billigare att vnta p SPIF. En ram om N byte tar ca 16 * N us.
+*
+*               Anslutning (hrdvaru-SPI):
+*
+*               74HC595      Arduino Uno
+*               SER (DS)     pin 11 (MOSI)
+*               SRCLK        pin 13 (SCK)
+*               RCLK         latch-pin (default = pin 10, SS)
+*
+*               Utgng 0 - 7 sitter p skiftregistret nrmast mikrodatorn,
+*               utgng 8 - 15 p nsta och s vidare. SPI-kretsen samt
+*               avbrottsvektorn delas av samtliga expandrar, s endast en
+*               kedja kan anvndas t gngen.
+********************************************************************************/
+#ifndef EXPANDER_HPP_
+#define EXPANDER_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "atomic.hpp"
+#include "interrupt.hpp"
+#include "led.hpp"
+
+/********************************************************************************
+* expander: Generisk klass fr N seriekopplade skiftregister av typen 74HC595.
+********************************************************************************/
+template<uint8_t N>
+class expander
+{
+private:
+   static_assert(N >= 1 && N <= 32, "Number of shift registers must be between 1 and 32!");
+
+   volatile uint8_t shadow_[N] = {};     /* Skuggbuffert, byte n = skiftregister n. */
+   uint8_t frame_[N] = {};               /* Senast utskiftade eller pgende ram. */
+   volatile uint8_t* latch_ = nullptr;   /* Pekare till dataregister fr latch-pinnen. */
+   uint8_t latch_mask_ = 0;              /* Bitmask fr latch-pinnen. */
+   volatile uint8_t index_ = 0;          /* Index fr byten som skickas. */
+   volatile bool busy_ = false;          /* Indikerar pgende verfring. */
+   volatile bool dirty_ = false;         /* Indikerar ndringar som inte har skiftats ut. */
+   atomic<uint16_t> frames_;             /* Antalet utskiftade ramar. */
+
+   /********************************************************************************
+   * instance: Returnerar en referens till pekaren till den expander som
+   *           anvnder SPI-kretsen via dispatch-lagret.
+   ********************************************************************************/
+   static expander*& instance(void)
+   {
+      static expander* instance = nullptr;
+      return instance;
+   }
+
+   /********************************************************************************
+   * start: Kopierar skuggbufferten till sndbufferten och skickar frsta
+   *        byten, vilket r byten till skiftregistret lngst bort i kedjan.
+   *        Anropas med avbrott inaktiverade.
+   ********************************************************************************/
+   void start(void)
+   {
+      for (uint8_t i = 0; i < N; ++i)
+      {
+         this->frame_[i] = this->shadow_[i];
+      }
+
+      this->dirty_ = false;
+      this->busy_ = true;
+      this->index_ = N - 1;
+      SPCR |= (1 << SPIE);
+      SPDR = this->frame_[N - 1];
+      return;
+   }
+
+   /********************************************************************************
+   * changed: Indikerar ifall skuggbufferten skiljer sig frn senast utskiftade
+   *          (eller pgende) ram. Anropas med avbrott inaktiverade.
+   ********************************************************************************/
+   bool changed(void) const
+   {
+      for (uint8_t i = 0; i < N; ++i)
+      {
+         if (this->shadow_[i] != this->frame_[i]) return true;
+      }
+      return false;
+   }
+
+   /********************************************************************************
+   * transfer_complete: Avbrottsrutin fr avslutad SPI-verfring. Nsta byte
+   *                    skickas, eller om ramen r komplett pulsas latch-pinnen
+   *                    och en ny ram startas om bufferten har ndrats.
+   ********************************************************************************/
+   static void transfer_complete(void)
+   {
+      auto self = instance();
+      if (!self) return;
+
+      if (self->index_)
+      {
+         SPDR = self->frame_[--self->index_];
+         return;
+      }
+
+      *self->latch_ |= self->latch_mask_;
+      *self->latch_ &= ~self->latch_mask_;
+      ++self->frames_;
+
+      if (self->dirty_)
+      {
+         self->start();
+      }
+      else
+      {
+         self->busy_ = false;
+         SPCR &= ~(1 << SPIE);
+      }
+      return;
+   }
+
+public:
+
+   static constexpr uint8_t OUTPUTS = N * 8; /* Antalet utgngar. */
+
+   /********************************************************************************
+   * expander: Defaultkonstruktor, initierar tomt objekt.
+   ********************************************************************************/
+   expander(void) { }
+
+   /********************************************************************************
+   * expander: Initierar expander med angiven latch-pin.
+   *
+   *           - latch_pin: Pin-nummer fr latch (RCLK) (default = 10).
+   ********************************************************************************/
+   expander(const uint8_t latch_pin)
+   {
+      this->init(latch_pin);
+      return;
+   }
+
+   /********************************************************************************
+   * expander: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   expander(expander&) = delete;
+
+   /********************************************************************************
+   * expander: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   expander& operator= (expander&) = delete;
+
+   /********************************************************************************
+   * init: Initierar hrdvaru-SPI som master (mode 0, MSB frst, 500 kHz) samt
+   *       angiven latch-pin och skiftar ut en slckt ram. Pin 10 (SS) stts
+   *       alltid till utport, vilket krvs fr att SPI-kretsen ska frbli
+   *       master.
+   *
+   *       - latch_pin: Pin-nummer fr latch (RCLK) (default = 10).
+   ********************************************************************************/
+   void init(const uint8_t latch_pin = 10)
+   {
+      if (latch_pin <= 7)
+      {
+         this->latch_ = &PORTD;
+         this->latch_mask_ = (1 << latch_pin);
+         DDRD |= this->latch_mask_;
+      }
+      else if (latch_pin <= 13)
+      {
+         this->latch_ = &PORTB;
+         this->latch_mask_ = (1 << (latch_pin - 8));
+         DDRB |= this->latch_mask_;
+      }
+      else
+      {
+         this->latch_ = &PORTC;
+         this->latch_mask_ = (1 << (latch_pin - 14));
+         DDRC |= this->latch_mask_;
+      }
+
+      *this->latch_ &= ~this->latch_mask_;
+      DDRB |= (1 << PORTB2) | (1 << PORTB3) | (1 << PORTB5);
+      SPCR = (1 << SPE) | (1 << MSTR) | (1 << SPR1);
+      SPSR = (1 << SPI2X);
+
+      instance() = this;
+      interrupt::attach<interrupt::vector::spi_stc>(&expander::transfer_complete);
+      asm("SEI");
+      {
+         critical_section lock;
+         if (!this->busy_) this->start();
+      }
+      this->flush();
+      return;
+   }
+
+   /********************************************************************************
+   * commit: Jmfr skuggbufferten med senast utskiftade ram. Om de skiljer
+   *         sig markeras bufferten som ndrad och en verfring startas,
+   *         frutsatt att ingen verfring redan pgr. Pgende verfring
+   *         startar i s fall om nr den r klar. Ofrndrade ramar skiftas
+   *         aldrig ut.
+   ********************************************************************************/
+   void commit(void)
+   {
+      critical_section lock;
+      this->dirty_ = this->changed();
+      if (this->dirty_ && !this->busy_) this->start();
+      return;
+   }
+
+   /********************************************************************************
+   * commit_instance: Anropar commit fr den expander som anvnder SPI-kretsen.
+   *                  Lagras i led-objekt som mappas via attach.
+   ********************************************************************************/
+   static void commit_instance(void)
+   {
+      if (instance()) instance()->commit();
+      return;
+   }
+
+   /********************************************************************************
+   * flush: Vntar tills samtliga ndringar har skiftats ut och latchats.
+   ********************************************************************************/
+   void flush(void)
+   {
+      while (this->busy_ || this->dirty_);
+      return;
+   }
+
+   /********************************************************************************
+   * busy: Indikerar ifall en verfring pgr.
+   ********************************************************************************/
+   bool busy(void) const
+   {
+      return this->busy_;
+   }
+
+   /********************************************************************************
+   * frames: Returnerar antalet utskiftade ramar, inklusive den slckta ramen
+   *         vid initiering, vilket kan anvndas fr att kontrollera att
+   *         ofrndrade ramar inte skiftas ut.
+   ********************************************************************************/
+   uint16_t frames(void) const
+   {
+      return this->frames_.load();
+   }
+
+   /********************************************************************************
+   * attach: Mappar angivet led-objekt mot angiven utgng, s att lysdioden
+   *         kan styras som en lysdiod ansluten direkt till mikrodatorn.
+   *
+   *         - target   : Referens till led-objektet som ska mappas.
+   *         - output   : Utgngens index, 0 - 8 * N - 1.
+   *         - start_val: Utgngens startvrde (default = 0, dvs. lg).
+   ********************************************************************************/
+   void attach(led& target,
+               const uint8_t output,
+               const uint8_t start_val = 0)
+   {
+      if (output >= OUTPUTS) return;
+      target.init_register(this->shadow_[output >> 3], output & 0x07,
+                        &expander::commit_instance, start_val);
+      return;
+   }
+
+   /********************************************************************************
+   * read: Returnerar lagrat vrde fr angiven utgng.
+   *
+   *       - output: Utgngens index, 0 - 8 * N - 1.
+   ********************************************************************************/
+   bool read(const uint8_t output) const
+   {
+      if (output >= OUTPUTS) return false;
+      return this->shadow_[output >> 3] & (1 << (output & 0x07));
+   }
+
+   /********************************************************************************
+   * write: Stter angiven utgng till angivet vrde.
+   *
+   *        - output: Utgngens index, 0 - 8 * N - 1.
+   *        - value : Utgngens nya vrde.
+   ********************************************************************************/
+   void write(const uint8_t output,
+              const bool value)
+   {
+      if (output >= OUTPUTS) return;
+      const uint8_t mask = (1 << (output & 0x07));
+      {
+         critical_section lock;
+         if (value)
+         {
+            this->shadow_[output >> 3] |= mask;
+         }
+         else
+         {
+            this->shadow_[output >> 3] &= ~mask;
+         }
+      }
+      this->commit();
+      return;
+   }
+
+   /********************************************************************************
+   * write_byte: Stter samtliga tta utgngar p angivet skiftregister.
+   *
+   *             - index: Skiftregistrets index, 0 - N - 1.
+   *             - value: Utgngarnas nya vrden, bit n = utgng n.
+   ********************************************************************************/
+   void write_byte(const uint8_t index,
+                   const uint8_t value)
+   {
+      if (index >= N) return;
+      this->shadow_[index] = value;
+      this->commit();
+      return;
+   }
+
+   /********************************************************************************
+   * on: Stter samtliga utgngar hga.
+   ********************************************************************************/
+   void on(void)
+   {
+      {
+         critical_section lock;
+         for (uint8_t i = 0; i < N; ++i)
+         {
+            this->shadow_[i] = 0xFF;
+         }
+      }
+      this->commit();
+      return;
+   }
+
+   /********************************************************************************
+   * off: Stter samtliga utgngar lga.
+   ********************************************************************************/
+   void off(void)
+   {
+      {
+         critical_section lock;
+         for (uint8_t i = 0; i < N; ++i)
+         {
+            this->shadow_[i] = 0x00;
+         }
+      }
+      this->commit();
+      return;
+   }
+};
+
+#endif /* EXPANDER_HPP_ */
@@ -0,0 +1,200 @@
+/********************************************************************************
+* extint.cpp: Innehller drivrutiner fr externa avbrott INT0 och INT1.
+********************************************************************************/
+#include "extint.hpp"
+#include "atomic.hpp"
+
+/* Tidsstmpel fr latensmtning: */
+volatile uint8_t extint::latency_stamp = 0;
+
+/********************************************************************************
+* port_bit: Returnerar angivet externt avbrotts bit p I/O-port D.
+*
+*           - source: Det externa avbrottet.
+********************************************************************************/
+static inline uint8_t port_bit(const enum extint::source source)
+{
+   return source == extint::source::int0 ? PORTD2 : PORTD3;
+}
+
+/********************************************************************************
+* bit: Returnerar angivet externt avbrotts bit i registren EIMSK och EIFR.
+*
+*      - source: Det externa avbrottet.
+********************************************************************************/
+static inline uint8_t bit(const enum extint::source source)
+{
+   return source == extint::source::int0 ? INT0 : INT1;
+}
+
+/********************************************************************************
+* probe: Avbrottsrutin som anvnds vid latensmtning via dispatch-lagret.
+********************************************************************************/
+static void probe(void)
+{
+   extint::timestamp();
+   return;
+}
+
+/********************************************************************************
+* init: Initierar angivet externt avbrott med angivet villkor.
+*
+*       - source  : Det externa avbrottet som ska initieras.
+*       - sense   : Villkor fr avbrott.
+*       - callback: Avbrottsrutin som lagras via dispatch-lagret.
+*       - pullup  : Indikerar ifall intern pullup-resistor ska aktiveras.
+********************************************************************************/
+void extint::init(const enum source source,
+                  const enum sense sense,
+                  void (*callback)(void),
+                  const bool pullup)
+{
+   extint::disable_interrupt(source);
+   DDRD &= ~(1 << port_bit(source));
+
+   if (pullup)
+   {
+      PORTD |= (1 << port_bit(source));
+   }
+   else
+   {
+      PORTD &= ~(1 << port_bit(source));
+   }
+
+   if (source == source::int0)
+   {
+      interrupt::attach<interrupt::vector::int0>(callback);
+   }
+   else
+   {
+      interrupt::attach<interrupt::vector::int1>(callback);
+   }
+
+   extint::set_sense(source, sense);
+   return;
+}
+
+/********************************************************************************
+* set_sense: ndrar villkor fr avbrott fr angivet externt avbrott.
+*
+*            - source: Det externa avbrottet.
+*            - sense : Nytt villkor fr avbrott.
+********************************************************************************/
+void extint::set_sense(const enum source source,
+                       const enum sense sense)
+{
+   const uint8_t shift = source == source::int0 ? ISC00 : ISC10;
+   critical_section lock;
+   EICRA = (EICRA & ~(0x03 << shift)) | (static_cast<uint8_t>(sense) << shift);
+   EIFR = (1 << bit(source));
+   return;
+}
+
+/********************************************************************************
+* enable_interrupt: Aktiverar angivet externt avbrott.
+*
+*                   - source: Det externa avbrottet.
+********************************************************************************/
+void extint::enable_interrupt(const enum source source)
+{
+   critical_section lock;
+   EIFR = (1 << bit(source));
+   EIMSK |= (1 << bit(source));
+   return;
+}
+
+/********************************************************************************
+* disable_interrupt: Inaktiverar angivet externt avbrott.
+*
+*                    - source: Det externa avbrottet.
+********************************************************************************/
+void extint::disable_interrupt(const enum source source)
+{
+   critical_section lock;
+   EIMSK &= ~(1 << bit(source));
+   return;
+}
+
+/********************************************************************************
+* interrupt_enabled: Indikerar ifall angivet externt avbrott r aktiverat.
+*
+*                    - source: Det externa avbrottet.
+********************************************************************************/
+bool extint::interrupt_enabled(const enum source source)
+{
+   return EIMSK & (1 << bit(source));
+}
+
+/********************************************************************************
+* measure_latency: Mter antalet CPU-cykler frn flank till frsta
+*                  instruktion i installerad hanterare. Timer 0 rknar med
+*                  prescaler 1 frn noll nr flanken genereras. Tiden fr
+*                  att skriva TCNT0 och drefter lsa av den mts frst i
+*                  en kalibrering och dras av, liksom de tv cykler som
+*                  instruktionen fr flanken (sbi) tar.
+*
+*                  - source: Det externa avbrottet som ska mtas.
+********************************************************************************/
+uint8_t extint::measure_latency(const enum source source)
+{
+   const uint8_t mask = (1 << port_bit(source));
+   const uint8_t shift = source == source::int0 ? ISC00 : ISC10;
+   const bool use_probe = source == source::int0 ?
+      !interrupt::attached<interrupt::vector::int0>() :
+      !interrupt::attached<interrupt::vector::int1>();
+
+   const uint8_t eicra = EICRA;
+   const uint8_t eimsk = EIMSK;
+   const uint8_t ddrd = DDRD & mask;
+   const uint8_t portd = PORTD & mask;
+   const uint8_t tccr0a = TCCR0A;
+   const uint8_t tccr0b = TCCR0B;
+   const uint8_t tcnt0 = TCNT0;
+
+   if (use_probe)
+   {
+      if (source == source::int0) interrupt::attach<interrupt::vector::int0>(&probe);
+      else interrupt::attach<interrupt::vector::int1>(&probe);
+   }
+
+   TCCR0A = 0;
+   TCCR0B = (1 << CS00);
+
+   {
+      critical_section lock;
+      PORTD &= ~mask;
+      DDRD |= mask;
+      EICRA = (EICRA & ~(0x03 << shift)) | (static_cast<uint8_t>(sense::rising) << shift);
+      EIFR = (1 << bit(source));
+      EIMSK |= (1 << bit(source));
+   }
+
+   TCNT0 = 0;
+   const uint8_t calibration = TCNT0;
+
+   latency_stamp = 0;
+   TCNT0 = 0;
+   PORTD |= mask;
+   for (uint8_t i = 0; i < 200 && !latency_stamp; ++i) { }
+   const uint8_t stamp = latency_stamp;
+
+   {
+      critical_section lock;
+      EIMSK = (EIMSK & ~(1 << bit(source))) | (eimsk & (1 << bit(source)));
+      EICRA = eicra;
+      PORTD = (PORTD & ~mask) | portd;
+      DDRD = (DDRD & ~mask) | ddrd;
+      EIFR = (1 << bit(source));
+      TCCR0B = tccr0b;
+      TCCR0A = tccr0a;
+      TCNT0 = tcnt0;
+   }
+
+   if (use_probe)
+   {
+      if (source == source::int0) interrupt::detach<interrupt::vector::int0>();
+      else interrupt::detach<interrupt::vector::int1>();
+   }
+
+   return stamp > calibration + 2 ? stamp - calibration - 2 : 0;
+}
@@ -0,0 +1,148 @@
+/********************************************************************************
+* extint.hpp: Innehller drivrutiner fr externa avbrott INT0 (pin 2) och
+*             INT1 (pin 3), vilka till skillnad frn PCI-avbrott har en egen
+*             avbrottsvektor per pin samt valbar flank eller lg niv via
+*             registret EICRA. Dessa avbrott lmpar sig drmed fr insignaler
+*             med krav p kort latens, exempelvis nollgenomgngsdetektorer
+*             och ndstopp.
+*
+*             Avbrottsrutinen kan antingen lagras vid initiering via
+*             dispatch-lagret i interrupt.hpp, eller bindas direkt vid
+*             kompileringen fr minsta mjliga latens, exempelvis:
+*
+*             INTERRUPT_BIND (INT0_vect, on_zero_cross);
+*
+*             Latensen frn flank till frsta instruktion i hanteraren
+*             (CPU-cykler vid 16 MHz, ungefrliga vrden):
+*
+*             Synkronisering av pinnen samt flankdetektering:   2 - 3
+*             Avbrottssvar (PC till stacken, hopp till vektor): 4 + 3
+*             Prolog, direkt bindning (INTERRUPT_BIND):         ca 10
+*             Prolog, dispatch-lagret (samtliga scratch-
+*             register sparas, pekaren lses, icall):           ca 40
+*
+*             Om en instruktion som tar flera cykler eller ett annat avbrott
+*             pgr tillkommer dess terstende tid. Faktisk latens fr den
+*             installerade hanteraren kan mtas via measure_latency.
+********************************************************************************/
+#ifndef EXTINT_HPP_
+#define EXTINT_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "interrupt.hpp"
+
+/********************************************************************************
+* extint: Namnrymd innehllande drivrutiner fr externa avbrott INT0 och INT1.
+********************************************************************************/
+namespace extint
+{
+   /********************************************************************************
+   * source: Enumerationsklass fr val av externt avbrott.
+   ********************************************************************************/
+   enum class source
+   {
+      int0, /* INT0 (pin 2 / PORTD2). */
+      int1  /* INT1 (pin 3 / PORTD3). */
+   };
+
+   /********************************************************************************
+   * sense: Enumerationsklass fr val av villkor fr avbrott, dr vrdet
+   *        motsvarar bitarna ISCn1:ISCn0 i registret EICRA. Vid lg niv
+   *        sker avbrott upprepat s lnge pinnen hlls lg, vilket r det
+   *        enda villkoret som kan vcka processorn ur power-down.
+   ********************************************************************************/
+   enum class sense
+   {
+      low,     /* Lg niv p pinnen. */
+      any,     /* Bde stigande och fallande flank. */
+      falling, /* Fallande flank. */
+      rising   /* Stigande flank. */
+   };
+
+   /* Tidsstmpel fr latensmtning, skrivs av extint::timestamp: */
+   extern volatile uint8_t latency_stamp;
+
+   /********************************************************************************
+   * init: Initierar angivet externt avbrott. Pinnen stts till inport med
+   *       eventuell intern pullup-resistor och villkoret fr avbrott lagras
+   *       i registret EICRA. Avbrottet aktiveras via enable_interrupt.
+   *
+   *       - source  : Det externa avbrottet som ska initieras.
+   *       - sense   : Villkor fr avbrott.
+   *       - callback: Avbrottsrutin som lagras via dispatch-lagret (default =
+   *                   ingen, exempelvis vid bindning via INTERRUPT_BIND).
+   *       - pullup  : Indikerar ifall intern pullup-resistor ska aktiveras
+   *                   (default = aktiverad).
+   ********************************************************************************/
+   void init(const enum source source,
+             const enum sense sense,
+             void (*callback)(void) = nullptr,
+             const bool pullup = true);
+
+   /********************************************************************************
+   * set_sense: ndrar villkor fr avbrott fr angivet externt avbrott.
+   *            Avbrottsflaggan nollstlls, d byte av villkor kan stta den.
+   *
+   *            - source: Det externa avbrottet.
+   *            - sense : Nytt villkor fr avbrott.
+   ********************************************************************************/
+   void set_sense(const enum source source,
+                  const enum sense sense);
+
+   /********************************************************************************
+   * enable_interrupt: Aktiverar angivet externt avbrott. En eventuellt
+   *                   vntande avbrottsflagga nollstlls frst, s att ingen
+   *                   flank fre aktiveringen genererar avbrott.
+   *
+   *                   - source: Det externa avbrottet.
+   ********************************************************************************/
+   void enable_interrupt(const enum source source);
+
+   /********************************************************************************
+   * disable_interrupt: Inaktiverar angivet externt avbrott.
+   *
+   *                    - source: Det externa avbrottet.
+   ********************************************************************************/
+   void disable_interrupt(const enum source source);
+
+   /********************************************************************************
+   * interrupt_enabled: Indikerar ifall angivet externt avbrott r aktiverat.
+   *
+   *                    - source: Det externa avbrottet.
+   ********************************************************************************/
+   bool interrupt_enabled(const enum source source);
+
+   /********************************************************************************
+   * timestamp: Lagrar aktuellt vrde p Timer 0 fr latensmtning. Anropas
+   *            som frsta instruktion i en direkt bunden hanterare som ska
+   *            mtas via measure_latency, vilket kostar tv cykler.
+   ********************************************************************************/
+   static inline void timestamp(void)
+   {
+      latency_stamp = TCNT0;
+      return;
+   }
+
+   /********************************************************************************
+   * measure_latency: Mter antalet CPU-cykler frn flank till frsta
+   *                  instruktion i installerad hanterare. Pinnen stts
+   *                  tillflligt till utport och en stigande flank genereras
+   *                  av mjukvaran, medan Timer 0 rknar varje CPU-cykel.
+   *                  Hanteraren lser av Timer 0 via extint::timestamp.
+   *
+   *                  Om ingen avbrottsrutin r lagrad via dispatch-lagret
+   *                  anvnds en intern rutin, vilket mter latensen genom
+   *                  dispatch-lagret. En direkt bunden hanterare mste sjlv
+   *                  anropa extint::timestamp frst, och anropas d ven vid
+   *                  mtningen. Returnerar 0 om ingen tidsstmpel erhlls.
+   *                  Timer 0 samt pinnens och avbrottets instllningar
+   *                  terstlls efter mtningen. Krver aktiverade avbrott
+   *                  samt att pinnen inte drivs externt under mtningen.
+   *
+   *                  - source: Det externa avbrottet som ska mtas.
+   ********************************************************************************/
+   uint8_t measure_latency(const enum source source);
+}
+
+#endif /* EXTINT_HPP_ */
\ No newline at end of file
@@ -0,0 +1,141 @@
+/********************************************************************************
+* format.cpp: Innehller konvertering av heltal till text utan sprintf.
+********************************************************************************/
+#include "format.hpp"
+
+/********************************************************************************
+* to_digits: Konverterar ett osignerat heltal till decimala siffror i omvnd
+*            ordning (minst signifikanta siffran frst) och returnerar
+*            antalet siffror. Kvot och rest berknas i samma division.
+*
+*            - number : Heltalet som ska konverteras.
+*            - digits : Pekare till array om minst tio tecken.
+*            - minimum: Minsta antal siffror, dr inledande nollor fylls ut.
+********************************************************************************/
+static uint8_t to_digits(uint32_t number,
+                         char* digits,
+                         const uint8_t minimum = 1)
+{
+   uint8_t length = 0;
+
+   do
+   {
+      const auto quotient = number / 10;
+      digits[length++] = static_cast<char>('0' + (number - quotient * 10));
+      number = quotient;
+   } while (number || length < minimum);
+
+   return length;
+}
+
+/********************************************************************************
+* reverse_copy: Kopierar angivna siffror i omvnd ordning till angiven
+*               buffert och returnerar en pekare till tecknet efter sista
+*               siffran.
+*
+*               - digits: Pekare till siffrorna (minst signifikanta frst).
+*               - length: Antalet siffror.
+*               - s     : Pekare till bufferten.
+********************************************************************************/
+static char* reverse_copy(const char* digits,
+                          uint8_t length,
+                          char* s)
+{
+   while (length)
+   {
+      *s++ = digits[--length];
+   }
+   return s;
+}
+
+/********************************************************************************
+* magnitude: Returnerar absolutbeloppet av ett signerat heltal som osignerat
+*            heltal, vilket fungerar ven fr INT32_MIN.
+*
+*            - number: Det signerade heltalet.
+********************************************************************************/
+static inline uint32_t magnitude(const int32_t number)
+{
+   return number < 0 ? 0UL - static_cast<uint32_t>(number) : static_cast<uint32_t>(number);
+}
+
+/********************************************************************************
+* to_string: Konverterar ett osignerat heltal till text i decimal form.
+*
+*            - number: Heltalet som ska konverteras.
+*            - s     : Pekare till bufferten dr texten lagras.
+********************************************************************************/
+uint8_t format::to_string(uint32_t number,
+                          char* s)
+{
+   char digits[10];
+   const auto length = to_digits(number, digits);
+   *reverse_copy(digits, length, s) = '\0';
+   return length;
+}
+
+/********************************************************************************
+* to_string: Konverterar ett signerat heltal till text i decimal form.
+*
+*            - number: Heltalet som ska konverteras.
+*            - s     : Pekare till bufferten dr texten lagras.
+********************************************************************************/
+uint8_t format::to_string(const int32_t number,
+                          char* s)
+{
+   if (number >= 0) return format::to_string(static_cast<uint32_t>(number), s);
+   *s = '-';
+   return format::to_string(magnitude(number), s + 1) + 1;
+}
+
+/********************************************************************************
+* to_string: Konverterar ett signerat fixtal till text med angivet antal
+*            decimaler. Siffrorna fylls ut med inledande nollor s att det
+*            alltid finns minst en siffra fre decimalpunkten.
+*
+*            - number  : Fixtalet som ska konverteras, exempelvis 1234.
+*            - decimals: Antalet decimaler, 0 - 9.
+*            - s       : Pekare till bufferten dr texten lagras.
+********************************************************************************/
+uint8_t format::to_string(const int32_t number,
+                          const uint8_t decimals,
+                          char* s)
+{
+   if (!decimals || decimals > 9) return format::to_string(number, s);
+
+   char digits[10];
+   const auto length = to_digits(magnitude(number), digits, decimals + 1);
+   auto end = s;
+
+   if (number < 0) *end++ = '-';
+   end = reverse_copy(digits + decimals, length - decimals, end);
+   *end++ = '.';
+   end = reverse_copy(digits, decimals, end);
+   *end = '\0';
+   return static_cast<uint8_t>(end - s);
+}
+
+/********************************************************************************
+* to_hex: Konverterar ett osignerat heltal till text i hexadecimal form.
+*
+*         - number: Heltalet som ska konverteras.
+*         - s     : Pekare till bufferten dr texten lagras.
+*         - width : Minsta antal siffror, 1 - 8.
+********************************************************************************/
+uint8_t format::to_hex(uint32_t number,
+                       char* s,
+                       const uint8_t width)
+{
+   char digits[8];
+   uint8_t length = 0;
+
+   do
+   {
+      const uint8_t nibble = number & 0x0F;
+      digits[length++] = static_cast<char>(nibble < 10 ? '0' + nibble : 'A' + nibble - 10);
+      number >>= 4;
+   } while ((number || length < width) && length < 8);
+
+   *reverse_copy(digits, length, s) = '\0';
+   return length;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+/********************************************************************************
+* format.hpp: Innehller konvertering av heltal till text utan sprintf, vilket
+*             sparar flera kilobyte programminne samt ger en knd exekverings-
+*             tid. Konverteringen anvnds av seriell verfring samt av
+*             displaydrivrutiner, exempelvis sjusegmentsdisplayer.
+*
+*             Samtliga rutiner skriver en nollterminerad strng till angiven
+*             buffert, som mste rymma minst BUFFER_SIZE tecken, och returnerar
+*             antalet skrivna tecken (exklusive nolltecknet).
+********************************************************************************/
+#ifndef FORMAT_HPP_
+#define FORMAT_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+
+/********************************************************************************
+* format: Namnrymd innehllande konvertering av heltal till text.
+********************************************************************************/
+namespace format
+{
+   static constexpr uint8_t BUFFER_SIZE = 16; /* Minsta buffertstorlek (tecken, punkt, 10 siffror, nolltecken). */
+
+   /********************************************************************************
+   * to_string: Konverterar ett osignerat heltal till text i decimal form.
+   *
+   *            - number: Heltalet som ska konverteras.
+   *            - s     : Pekare till bufferten dr texten lagras.
+   ********************************************************************************/
+   uint8_t to_string(uint32_t number,
+                     char* s);
+
+   /********************************************************************************
+   * to_string: Konverterar ett signerat heltal till text i decimal form.
+   *
+   *            - number: Heltalet som ska konverteras.
+   *            - s     : Pekare till bufferten dr texten lagras.
+   ********************************************************************************/
+   uint8_t to_string(const int32_t number,
+                     char* s);
+
+   /********************************************************************************
+   * to_string: Konverterar ett signerat fixtal till text med angivet antal
+   *            decimaler, exempelvis 1234 med tv decimaler till "12.34" och
+   *            -5 med tv decimaler till "-0.05".
+   *
+   *            - number  : Fixtalet som ska konverteras, exempelvis 1234.
+   *            - decimals: Antalet decimaler, 0 - 9.
+   *            - s       : Pekare till bufferten dr texten lagras.
+   ********************************************************************************/
+   uint8_t to_string(const int32_t number,
+                     const uint8_t decimals,
+                     char* s);
+
+   /********************************************************************************
+   * to_hex: Konverterar ett osignerat heltal till text i hexadecimal form med
+   *         versaler, utfyllt med inledande nollor till angiven bredd.
+   *
+   *         - number: Heltalet som ska konverteras.
+   *         - s     : Pekare till bufferten dr texten lagras.
+   *         - width : Minsta antal siffror, 1 - 8 (default = 1).
+   ********************************************************************************/
+   uint8_t to_hex(uint32_t number,
+                  char* s,
+                  const uint8_t width = 1);
+}
+
+#endif /* FORMAT_HPP_ */
\ No newline at end of file
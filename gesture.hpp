@@ -0,0 +1,233 @@
+/********************************************************************************
+* gesture.hpp: Innehller gestigenknning fr tryckknappar via klassen
+*              gesture, som utifrn avstudsad niv genererar hndelser fr
+*              nedtryckning, uppslppning, klick, dubbelklick, lngt tryck
+*              samt upprepning s lnge knappen hlls nedtryckt.
+*
+*              Gestigenknningen drivs av en periodisk tick, dr update anropas
+*              med fast intervall, frslagsvis frn samma task som anropar
+*              debounce::update. Samtliga tider anges i millisekunder vid
+*              initiering och lagras som antalet ticks (max 255), vilket gr
+*              att varje tryckknapp endast krver ett tillstnd p sju byte.
+*
+*              Tryckknappen mste ha lagts till i debounce.hpp, eftersom
+*              avstudsad niv lses via debounce::is_pressed.
+*
+*              Ett enkelt klick rapporteras frst nr tiden fr dubbelklick
+*              har lpt ut utan en andra nedtryckning. Om dubbelklick inte
+*              anvnds (tiden stts till 0) rapporteras klick direkt vid
+*              uppslppning. Ett lngt tryck ger inget klick.
+********************************************************************************/
+#ifndef GESTURE_HPP_
+#define GESTURE_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "button.hpp"
+#include "debounce.hpp"
+
+/********************************************************************************
+* gesture: Klass fr gestigenknning via en tillstndsmaskin per tryckknapp.
+********************************************************************************/
+class gesture
+{
+public:
+
+   /********************************************************************************
+   * event: Enumeration fr hndelser, dr varje hndelse utgr en bit s att
+   *        flera hndelser kan returneras frn samma tick.
+   ********************************************************************************/
+   enum event
+   {
+      none         = 0x00, /* Ingen hndelse. */
+      press        = 0x01, /* Tryckknappen trycktes ned. */
+      release      = 0x02, /* Tryckknappen slpptes upp. */
+      click        = 0x04, /* Kort tryck utan efterfljande andra tryck. */
+      double_click = 0x08, /* Tv korta tryck i snabb fljd. */
+      long_press   = 0x10, /* Tryckknappen har hllits nedtryckt lnge. */
+      repeat       = 0x20  /* Upprepning medan tryckknappen hlls nedtryckt. */
+   };
+
+private:
+
+   /********************************************************************************
+   * state: Enumerationsklass fr tillstndsmaskinens tillstnd.
+   ********************************************************************************/
+   enum class state : uint8_t
+   {
+      idle,        /* Tryckknappen r uppslppt. */
+      down,        /* Frsta nedtryckningen pgr. */
+      wait_second, /* Vntar p en eventuell andra nedtryckning. */
+      second_down, /* Andra nedtryckningen pgr. */
+      held         /* Lngt tryck, upprepning pgr. */
+   };
+
+   const button* button_ = nullptr;  /* Pekare till tryckknappen. */
+   enum state state_ = state::idle;  /* Aktuellt tillstnd. */
+   uint8_t ticks_ = 0;               /* Antalet ticks i aktuellt tillstnd. */
+   uint8_t long_press_ticks_ = 0;    /* Antalet ticks fr ett lngt tryck. */
+   uint8_t double_click_ticks_ = 0;  /* Maximalt antal ticks mellan tv klick. */
+   uint8_t repeat_ticks_ = 0;        /* Antalet ticks mellan upprepningar (0 = av). */
+
+   /********************************************************************************
+   * to_ticks: Returnerar antalet ticks fr angiven tid, begrnsat till 255.
+   *
+   *           - time_ms: Tiden mtt i millisekunder.
+   *           - tick_ms: Tid mellan varje tick mtt i millisekunder.
+   ********************************************************************************/
+   static uint8_t to_ticks(const uint16_t time_ms,
+                           const uint8_t tick_ms)
+   {
+      const uint16_t ticks = tick_ms ? time_ms / tick_ms : 0;
+      return ticks > 0xFF ? 0xFF : static_cast<uint8_t>(ticks);
+   }
+
+   /********************************************************************************
+   * enter: Byter tillstnd och nollstller tiden i tillstndet.
+   *
+   *        - state: Det nya tillstndet.
+   ********************************************************************************/
+   void enter(const enum state state)
+   {
+      this->state_ = state;
+      this->ticks_ = 0;
+      return;
+   }
+
+public:
+
+   /********************************************************************************
+   * gesture: Defaultkonstruktor, initierar tomt objekt.
+   ********************************************************************************/
+   gesture(void) { }
+
+   /********************************************************************************
+   * gesture: Initierar gestigenknning fr angiven tryckknapp.
+   *
+   *          - button         : Referens till tryckknappen.
+   *          - tick_ms        : Tid mellan anrop av update mtt i millisekunder.
+   *          - long_press_ms  : Tid fr ett lngt tryck (default = 500 ms).
+   *          - double_click_ms: Maximal tid mellan tv klick (default = 300 ms).
+   *          - repeat_ms      : Tid mellan upprepningar efter ett lngt tryck
+   *                             (default = 100 ms, 0 = ingen upprepning).
+   ********************************************************************************/
+   gesture(const button& button,
+           const uint8_t tick_ms,
+           const uint16_t long_press_ms = 500,
+           const uint16_t double_click_ms = 300,
+           const uint16_t repeat_ms = 100)
+   {
+      this->init(button, tick_ms, long_press_ms, double_click_ms, repeat_ms);
+      return;
+   }
+
+   /********************************************************************************
+   * gesture: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   gesture(gesture&) = delete;
+
+   /********************************************************************************
+   * gesture: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   gesture& operator= (gesture&) = delete;
+
+   /********************************************************************************
+   * init: Initierar gestigenknning fr angiven tryckknapp.
+   *
+   *       - button         : Referens till tryckknappen.
+   *       - tick_ms        : Tid mellan anrop av update mtt i millisekunder.
+   *       - long_press_ms  : Tid fr ett lngt tryck (default = 500 ms).
+   *       - double_click_ms: Maximal tid mellan tv klick (default = 300 ms).
+   *       - repeat_ms      : Tid mellan upprepningar efter ett lngt tryck
+   *                          (default = 100 ms, 0 = ingen upprepning).
+   ********************************************************************************/
+   void init(const button& button,
+             const uint8_t tick_ms,
+             const uint16_t long_press_ms = 500,
+             const uint16_t double_click_ms = 300,
+             const uint16_t repeat_ms = 100)
+   {
+      this->button_ = &button;
+      this->long_press_ticks_ = to_ticks(long_press_ms, tick_ms);
+      this->double_click_ticks_ = to_ticks(double_click_ms, tick_ms);
+      this->repeat_ticks_ = to_ticks(repeat_ms, tick_ms);
+      this->enter(state::idle);
+      return;
+   }
+
+   /********************************************************************************
+   * is_held: Indikerar ifall tryckknappen har hllits nedtryckt lngre n
+   *          tiden fr ett lngt tryck.
+   ********************************************************************************/
+   bool is_held(void) const
+   {
+      return this->state_ == state::held;
+   }
+
+   /********************************************************************************
+   * update: Genomfr en tick i tillstndsmaskinen utifrn tryckknappens
+   *         avstudsade niv och returnerar genererade hndelser som en
+   *         bitmask, exempelvis (events & gesture::click).
+   ********************************************************************************/
+   uint8_t update(void)
+   {
+      if (!this->button_) return none;
+      const bool pressed = debounce::is_pressed(*this->button_);
+      if (this->ticks_ < 0xFF) this->ticks_++;
+
+      switch (this->state_)
+      {
+         case state::idle:
+            if (!pressed) return none;
+            this->enter(state::down);
+            return press;
+
+         case state::down:
+         case state::second_down:
+            if (pressed)
+            {
+               if (this->ticks_ < this->long_press_ticks_) return none;
+               this->enter(state::held);
+               return long_press;
+            }
+            else if (this->state_ == state::second_down)
+            {
+               this->enter(state::idle);
+               return release | double_click;
+            }
+            else if (this->double_click_ticks_)
+            {
+               this->enter(state::wait_second);
+               return release;
+            }
+            else
+            {
+               this->enter(state::idle);
+               return release | click;
+            }
+
+         case state::wait_second:
+            if (pressed)
+            {
+               this->enter(state::second_down);
+               return press;
+            }
+            if (this->ticks_ < this->double_click_ticks_) return none;
+            this->enter(state::idle);
+            return click;
+
+         case state::held:
+            if (!pressed)
+            {
+               this->enter(state::idle);
+               return release;
+            }
+            if (!this->repeat_ticks_ || this->ticks_ < this->repeat_ticks_) return none;
+            this->ticks_ = 0;
+            return repeat;
+      }
+      return none;
+   }
+};
+
+#endif /* GESTURE_HPP_ */
\ No newline at end of file
@@ -14,21 +14,73 @@
 #include "wdt.hpp"
 #include "pwm.hpp"
 #include "led_vector.hpp"
+#include "power.hpp"
+#include "scheduler.hpp"
+#include "events.hpp"
+#include "debounce.hpp"
+#include "gesture.hpp"
+#include "sequencer.hpp"
 
 /* Konstanter: */
 static constexpr auto TIMEOUT_ADDRESS = 100; /* Lagrar antalet passerade Watchdog timeouts. */
 static constexpr auto TIMEOUT_MAX = 5;       /* Maximalt antal timeouts innan programmet lses. */
 
+/* Hndelsetyper: */
+static constexpr uint8_t EVENT_B1_PRESSED = 0;  /* Tryckknapp b1 har tryckts ned. */
+static constexpr uint8_t EVENT_WDT_TIMEOUT = 1; /* Watchdog timeout har gt rum. */
+static constexpr uint8_t EVENT_B1_LONG_PRESS = 2; /* Tryckknapp b1 har hllits nedtryckt lnge. */
+
 /* Deklaration av globala objekt: */
 extern led l1, l2, l3;
 extern led_vector v1;
 extern button b1;
-extern timer t0, t1;
+extern gesture g1;
+extern timer t1;
 extern pwm<led_vector> pwm1;
+extern scheduler::task pwm_task;
+extern scheduler::task button_task;
+extern sequencer<led> status;
+extern scheduler::task status_task;
 
 /********************************************************************************
 * setup: Initierar det inbyggda systemet.
 ********************************************************************************/
 void setup(void);
 
+/********************************************************************************
+* button_update: Task fr avstudsning av tryckknappar.
+********************************************************************************/
+void button_update(void);
+
+/********************************************************************************
+* b1_pressed: Hndelsehanterare fr nedtryckning av tryckknapp b1.
+*
+*             - event: Referens till aktuell hndelse.
+********************************************************************************/
+void b1_pressed(const events::event& event);
+
+/********************************************************************************
+* b1_long_pressed: Hndelsehanterare fr lngt tryck p tryckknapp b1.
+*
+*                  - event: Referens till aktuell hndelse.
+********************************************************************************/
+void b1_long_pressed(const events::event& event);
+
+/********************************************************************************
+* t1_elapsed: Avbrottsrutin som anropas nr timer t1 lper ut.
+********************************************************************************/
+void t1_elapsed(void);
+
+/********************************************************************************
+* wdt_timeout: Avbrottsrutin som anropas vid Watchdog timeout.
+********************************************************************************/
+void wdt_timeout(void);
+
+/********************************************************************************
+* wdt_timeout_handler: Hndelsehanterare fr Watchdog timeout.
+*
+*                      - event: Referens till aktuell hndelse.
+********************************************************************************/
+void wdt_timeout_handler(const events::event& event);
+
 #endif /* HEADER_HPP_ */
\ No newline at end of file
@@ -0,0 +1,90 @@
+/********************************************************************************
+* interrupt.cpp: Innehller standardrutiner fr avbrottsvektorer med
+*                dispatch-std. Rutinerna deklareras som svaga symboler, s
+*                att en avbrottsrutin definierad p annat stlle (exempelvis
+*                via INTERRUPT_BIND) erstter motsvarande standardrutin vid
+*                lnkningen. Avbrottsvektorerna fr Timer 0 samt Timer 1 i
+*                CTC Mode implementeras i stllet i timer.cpp.
+********************************************************************************/
+#include "interrupt.hpp"
+
+/********************************************************************************
+* ISR (INT0_vect): Anropar lagrad avbrottsrutin fr externt avbrott p pin 2.
+********************************************************************************/
+ISR (INT0_vect, __attribute__((weak)))
+{
+   interrupt::dispatch<interrupt::vector::int0>();
+   return;
+}
+
+/********************************************************************************
+* ISR (INT1_vect): Anropar lagrad avbrottsrutin fr externt avbrott p pin 3.
+********************************************************************************/
+ISR (INT1_vect, __attribute__((weak)))
+{
+   interrupt::dispatch<interrupt::vector::int1>();
+   return;
+}
+
+/********************************************************************************
+* ISR (PCINT0_vect): Anropar lagrad avbrottsrutin fr PCI-avbrott p I/O-port B.
+********************************************************************************/
+ISR (PCINT0_vect, __attribute__((weak)))
+{
+   interrupt::dispatch<interrupt::vector::pcint0>();
+   return;
+}
+
+/********************************************************************************
+* ISR (PCINT1_vect): Anropar lagrad avbrottsrutin fr PCI-avbrott p I/O-port C.
+********************************************************************************/
+ISR (PCINT1_vect, __attribute__((weak)))
+{
+   interrupt::dispatch<interrupt::vector::pcint1>();
+   return;
+}
+
+/********************************************************************************
+* ISR (PCINT2_vect): Anropar lagrad avbrottsrutin fr PCI-avbrott p I/O-port D.
+********************************************************************************/
+ISR (PCINT2_vect, __attribute__((weak)))
+{
+   interrupt::dispatch<interrupt::vector::pcint2>();
+   return;
+}
+
+/********************************************************************************
+* ISR (WDT_vect): Anropar lagrad avbrottsrutin fr Watchdog timeout.
+********************************************************************************/
+ISR (WDT_vect, __attribute__((weak)))
+{
+   interrupt::dispatch<interrupt::vector::wdt>();
+   return;
+}
+
+/********************************************************************************
+* ISR (TIMER1_OVF_vect): Anropar lagrad avbrottsrutin fr overflow av Timer 1.
+********************************************************************************/
+ISR (TIMER1_OVF_vect, __attribute__((weak)))
+{
+   interrupt::dispatch<interrupt::vector::timer1_ovf>();
+   return;
+}
+
+/********************************************************************************
+* ISR (TIMER2_OVF_vect): Anropar lagrad avbrottsrutin fr overflow av Timer 2.
+********************************************************************************/
+ISR (TIMER2_OVF_vect, __attribute__((weak)))
+{
+   interrupt::dispatch<interrupt::vector::timer2_ovf>();
+   return;
+}
+
+/********************************************************************************
+* ISR (SPI_STC_vect): Anropar lagrad avbrottsrutin fr avslutad SPI-verfring.
+********************************************************************************/
+ISR (SPI_STC_vect, __attribute__((weak)))
+{
+   interrupt::dispatch<interrupt::vector::spi_stc>();
+   return;
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+/********************************************************************************
+* interrupt.hpp: Innehller ett dispatch-lager fr avbrott, vilket gr att
+*                drivrutiner (timer, button, wdt) kan ta emot en avbrottsrutin
+*                vid initiering i stllet fr att avbrottsvektorerna skrivs
+*                fr hand i en gemensam isr.cpp.
+*
+*                Varje avbrottsvektor har en egen statisk hanterare, som vljs
+*                via mallparametern vid kompileringen. Avbrottsrutinen lser
+*                drmed en fast adress och anropar lagrad funktion direkt,
+*                utan uppslagning i ngon tabell under krning. Lagrad
+*                funktion r drmed det enda indirekta anropet per avbrott.
+*                Avbrottsvektorer som endast anvnds av en drivrutin anropar
+*                i stllet drivrutinen direkt, ssom TIMER0_OVF_vect samt
+*                TIMER1_COMPA_vect i timer.cpp.
+*
+*                Standardrutinerna fr avbrottsvektorerna implementeras i
+*                interrupt.cpp som svaga symboler (weak). Nr bindningen r knd
+*                vid kompileringen ska makrot INTERRUPT_BIND anvndas i stllet,
+*                vilket erstter standardrutinen vid lnkningen med en rutin
+*                som anropar angiven funktion direkt (utan funktionspekare),
+*                s att kompilatorn kan inline-deklarera hela kedjan, exempelvis:
+*
+*                INTERRUPT_BIND (WDT_vect, wdt_timeout);
+*                INTERRUPT_BIND (TIMER1_COMPA_vect, t1.handle_interrupt<&t1_elapsed>);
+*
+*                I det senare fallet r avbrottsrutinen en mallparameter till
+*                timer::handle_interrupt, s att bde timern och rutinen r
+*                knda vid kompileringen. Lagring via attach anvnds endast
+*                som reserv nr bindningen vljs under krning.
+********************************************************************************/
+#ifndef INTERRUPT_HPP_
+#define INTERRUPT_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "atomic.hpp"
+
+/********************************************************************************
+* INTERRUPT_BIND: Makro fr bindning av angiven funktion till angiven
+*                 avbrottsvektor vid kompileringen. Funktionen anropas direkt
+*                 frn avbrottsrutinen och kan drmed inline-deklareras av
+*                 kompilatorn. Standardrutinen i interrupt.cpp erstts.
+*
+*                 - vector_name: Avbrottsvektorn, exempelvis PCINT0_vect.
+*                 - function   : Funktionen som ska anropas vid avbrott.
+********************************************************************************/
+#define INTERRUPT_BIND(vector_name, function) ISR (vector_name) { function(); }
+
+/********************************************************************************
+* interrupt: Namnrymd innehllande dispatch-lager fr avbrott.
+********************************************************************************/
+namespace interrupt
+{
+   /********************************************************************************
+   * vector: Enumerationsklass fr val av avbrottsvektor med dispatch-std.
+   ********************************************************************************/
+   enum class vector
+   {
+      int0,         /* INT0_vect (pin 2). */
+      int1,         /* INT1_vect (pin 3). */
+      pcint0,       /* PCINT0_vect (I/O-port B). */
+      pcint1,       /* PCINT1_vect (I/O-port C). */
+      pcint2,       /* PCINT2_vect (I/O-port D). */
+      wdt,          /* WDT_vect. */
+      timer1_ovf,   /* TIMER1_OVF_vect. */
+      timer2_ovf,   /* TIMER2_OVF_vect. */
+      spi_stc       /* SPI_STC_vect. */
+   };
+
+   /********************************************************************************
+   * handler: Strukt innehllande lagrad avbrottsrutin fr angiven
+   *          avbrottsvektor. Varje vektor fr en egen statisk pekare, vars
+   *          adress r knd vid kompileringen.
+   ********************************************************************************/
+   template<vector V>
+   struct handler
+   {
+      static void (*callback)(void); /* Pekare till lagrad avbrottsrutin. */
+   };
+
+   /* Definition av lagrad avbrottsrutin fr respektive avbrottsvektor: */
+   template<vector V>
+   void (*handler<V>::callback)(void) = nullptr;
+
+   /********************************************************************************
+   * attach: Lagrar angiven funktion som avbrottsrutin fr angiven avbrottsvektor.
+   *         Lagringen sker med avbrott inaktiverade, s att en halvskriven
+   *         pekare aldrig kan anropas.
+   *
+   *         - callback: Pekare till funktionen som ska anropas vid avbrott.
+   ********************************************************************************/
+   template<vector V>
+   inline void attach(void (*callback)(void))
+   {
+      critical_section lock;
+      handler<V>::callback = callback;
+      return;
+   }
+
+   /********************************************************************************
+   * detach: Tar bort lagrad avbrottsrutin fr angiven avbrottsvektor.
+   ********************************************************************************/
+   template<vector V>
+   inline void detach(void)
+   {
+      interrupt::attach<V>(nullptr);
+      return;
+   }
+
+   /********************************************************************************
+   * attached: Indikerar ifall en avbrottsrutin r lagrad fr angiven vektor.
+   ********************************************************************************/
+   template<vector V>
+   inline bool attached(void)
+   {
+      return handler<V>::callback != nullptr;
+   }
+
+   /********************************************************************************
+   * dispatch: Anropar lagrad avbrottsrutin fr angiven avbrottsvektor, frutsatt
+   *           att en sdan finns. Anropas frn motsvarande avbrottsrutin.
+   ********************************************************************************/
+   template<vector V>
+   inline void dispatch(void)
+   {
+      const auto callback = handler<V>::callback;
+      if (callback) callback();
+      return;
+   }
+
+   /********************************************************************************
+   * attach_pcint: Lagrar angiven funktion som avbrottsrutin fr PCI-avbrott p
+   *               angiven I/O-port, dr avbrottsvektorn vljs under krning.
+   *
+   *               - io_port : I/O-porten vars avbrottsvektor ska anvndas.
+   *               - callback: Pekare till funktionen som ska anropas vid avbrott.
+   ********************************************************************************/
+   inline void attach_pcint(const enum io_port io_port,
+                            void (*callback)(void))
+   {
+      if (io_port == io_port::b)
+      {
+         interrupt::attach<vector::pcint0>(callback);
+      }
+      else if (io_port == io_port::c)
+      {
+         interrupt::attach<vector::pcint1>(callback);
+      }
+      else if (io_port == io_port::d)
+      {
+         interrupt::attach<vector::pcint2>(callback);
+      }
+      return;
+   }
+}
+
+#endif /* INTERRUPT_HPP_ */
@@ -1,91 +1,103 @@
 /********************************************************************************
-* isr.cpp: Innehller avbrottsrutiner.
+* isr.cpp: Innehller avbrottsrutiner, vilka binds till respektive
+*          avbrottsvektor vid kompileringen via INTERRUPT_BIND lngst ned,
+*          s att varje avbrottsvektor anropar sin rutin direkt utan
+*          funktionspekare. Tryckknapp b1 avlses via en task och anvnder
+*          drmed inget avbrott.
+*
+*          Avbrottsrutinerna utfr endast det som mste ske direkt och postar
+*          i vrigt en hndelse via events.hpp. Tidskrvande arbete, ssom
+*          seriell verfring och skrivning till EEPROM-minnet, utfrs sedan
+*          av motsvarande hndelsehanterare frn huvudloopen.
 ********************************************************************************/
 #include "header.hpp"
 
 /********************************************************************************
-* ISR (PCINT0_vect): Avbrottsrutin som ger rum vid nedtryckning/uppslppning
-*                    av tryckknapp b1 ansluten till pin 13 (PORTB5).
-*                    Vid nedtryckning terstlls Watchdog-timern, vilket
-*                    skrivs ut i ansluten seriell terminal. Dremot vid
-*                    uppslppning grs ingenting.
-*
-*                    Oavsett vad som orsakade avbrottet inaktiveras PCI-avbrott
-*                    p I/O-port B i 300 millisekunder via timer 0 fr att
-*                    undvika multipla avbrott orsakade av kontaktstudsar.
+* button_update: Task som krs var 5:e millisekund och avstudsar samtliga
+*                tryckknappar via debounce::update, fljt av gestigenknning
+*                fr tryckknapp b1. Vid nedtryckning postas hndelsen
+*                EVENT_B1_PRESSED och vid lngt tryck EVENT_B1_LONG_PRESS.
 ********************************************************************************/
-ISR (PCINT0_vect)
+void button_update(void)
 {
-   misc::disable_pin_change_interrupt(io_port::b);
-   t0.enable_interrupt();
+   debounce::update();
+   const auto gestures = g1.update();
 
-   if (b1.is_pressed())
+   if (gestures & gesture::press)
+   {
+      events::post(EVENT_B1_PRESSED);
+   }
+   if (gestures & gesture::long_press)
    {
-      wdt::reset();
-      serial::print("Watchdog timer reset!\n");
+      events::post(EVENT_B1_LONG_PRESS);
    }
 
    return;
 }
 
-/********************************************************************************
-* ISR (TIMER0_OVF_vect): Avbrottsrutin som ger rum vid overflow av Timer 0,
-*                        dvs. upprkning till 256, vilket sker var 0.128:e
-*                        millisekund nr timern r aktiverad.
-*
-*                        Timern rknas upp via upprkning av varje passerat
-*                        avbrott. Nr timern lper ut (nr berknat antal
-*                        avbrott fr specificerad tid har rknats upp) s
-*                        teraktiveras PCI-avbrott p I/O-port B (som har
-*                        stngts av i 300 millisekunder fr att undvika
-*                        multipla avbrott orsakat av kontaktstudsar), fljt
-*                        av att timern stngs av.
+/********************************************************************************
+* b1_pressed: Hndelsehanterare fr nedtryckning av tryckknapp b1. Watchdog-
+*             timern terstlls, vilket skrivs ut i ansluten seriell terminal.
+*
+*             - event: Referens till aktuell hndelse (anvnds ej).
 ********************************************************************************/
-ISR (TIMER0_OVF_vect)
+void b1_pressed(const events::event& event)
 {
-   t0.count();
-
-   if (t0.elapsed())
-   {
-      misc::enable_pin_change_interrupt(io_port::b);
-      t0.disable_interrupt();
-   }
+   wdt::reset();
+   serial::print("Watchdog timer reset!\n");
+   return;
+}
 
+/********************************************************************************
+* b1_long_pressed: Hndelsehanterare fr lngt tryck (en sekund) p tryckknapp
+*                  b1. Krtidsstatistik fr samtliga tasks skrivs ut i ansluten
+*                  seriell terminal.
+*
+*                  - event: Referens till aktuell hndelse (anvnds ej).
+********************************************************************************/
+void b1_long_pressed(const events::event& event)
+{
+   scheduler::print_stats();
    return;
 }
 
 /********************************************************************************
-* ISR (TIMER1_COMPA_vect): Avbrottsrutin som ger rum vid upprkning till 256 av
-*                          Timer 1 i CTC Mode, vilket sker var 0.128:e
-*                          millisekund nr timern r aktiverad.
-*
-*                          Timern rknas upp via upprkning av varje passerat
-*                          avbrott. Nr timern lper ut (var 50:e millisekund
-*                          nr timern r aktiverad) togglas lysdiod l1.
+* t1_elapsed: Avbrottsrutin som ger rum nr timer t1 lper ut, vilket sker
+*             var 50:e millisekund nr timern r aktiverad. Lysdiod l1 togglas.
 ********************************************************************************/
-ISR (TIMER1_COMPA_vect)
+void t1_elapsed(void)
 {
-   t1.count();
-
-   if (t1.elapsed())
-   {
-      l1.toggle();
-   }
-
+   l1.toggle();
    return;
 }
 
 /********************************************************************************
-* ISR (WDT_vect): Avbrottsrutin som ger rum vid Watchdog timeout, vilket sker
-*                 om Watchdog-timern inte blir terslld var 1024:e millisekund.
-*                 Antalet timeouts rknas upp och skrivs ut i ansluten seriell
-*                 terminal. Nr maximalt antal timeouts har genomfrts lses
-*                 systemet i ett tillstnd dr lysdioden ansluten till pin 8
-*                 (PORTB0) blinkar var 50:e millisekund.
+* wdt_timeout: Avbrottsrutin som ger rum vid Watchdog timeout, vilket sker om
+*              Watchdog-timern inte blir terslld var 8192:e millisekund.
+*              Hndelsen EVENT_WDT_TIMEOUT postas, fljt av att Watchdog-
+*              avbrott teraktiveras.
 ********************************************************************************/
-ISR (WDT_vect)
+void wdt_timeout(void)
 {
-   static volatile auto system_lockdown = false;
+   events::post(EVENT_WDT_TIMEOUT);
+   wdt::enable_interrupt();
+   return;
+}
+
+/********************************************************************************
+* wdt_timeout_handler: Hndelsehanterare fr Watchdog timeout. Antalet
+*                      timeouts rknas upp och skrivs ut i ansluten seriell
+*                      terminal. Nr maximalt antal timeouts har genomfrts
+*                      lses systemet i ett tillstnd dr lysdioden ansluten
+*                      till pin 8 (PORTB0) blinkar var 50:e millisekund och
+*                      lysdioden ansluten till pin 9 (PORTB1) visar SOS i
+*                      morsekod via sekvenseraren.
+*
+*                      - event: Referens till aktuell hndelse (anvnds ej).
+********************************************************************************/
+void wdt_timeout_handler(const events::event& event)
+{
+   static auto system_lockdown = false;
 
    if (!system_lockdown)
    {
@@ -101,10 +113,14 @@ ISR (WDT_vect)
          serial::print("Maximum number of timeouts has elapsed!\n");
          serial::print("System lockdown!\n");
 
+         button_task.disable();
+         debounce::remove(b1);
          b1.clear();
-         t0.clear();
          pwm1.disable();
+         pwm_task.disable();
          t1.enable_interrupt();
+         status.start(sequence::sos);
+         status_task.enable();
       }
       else
       {
@@ -112,6 +128,14 @@ ISR (WDT_vect)
       }
    }
 
-   wdt::enable_interrupt();
    return;
 }
+
+/********************************************************************************
+* Bindning av avbrottsrutiner: Timer t1 rknas upp direkt frn
+*                              TIMER1_COMPA_vect, dr t1_elapsed r en
+*                              mallparameter, och WDT_vect anropar
+*                              wdt_timeout direkt.
+********************************************************************************/
+INTERRUPT_BIND (TIMER1_COMPA_vect, t1.handle_interrupt<&t1_elapsed>);
+INTERRUPT_BIND (WDT_vect, wdt_timeout);
@@ -0,0 +1,608 @@
+/********************************************************************************
+* kernel.cpp: Innehller preemptiv realtidskrna med fast prioritet, dr
+*             kontextbytet implementeras i assembler.
+*
+*             Bde tick-avbrottet och kernel::yield anropar en gemensam rutin
+*             som sparar kontextet, vljer nsta task, terstller kontextet
+*             och avslutas med RET. Ett kontext som sparats i tick-avbrottet
+*             tervnder drmed alltid in i avbrottsrutinen, som avslutas med
+*             RETI, medan ett kontext som sparats via kernel::yield tervnder
+*             till anroparen med sitt eget sparade SREG. Det spelar drmed
+*             ingen roll vilken vg ett kontext terstlls via. Detsamma gller
+*             kontextbyten via kernel::isr_exit, som tervnder in i
+*             avbrottsrutinen och drefter avslutas med RETI.
+********************************************************************************/
+#include "kernel.hpp"
+
+/********************************************************************************
+* KERNEL_SAVE_CONTEXT: Sparar r0, SREG samt r1 - r31 p aktuell stack med
+*                      avbrott inaktiverade och lagrar stackpekaren i aktuell
+*                      tasks kontrollblock. r1 nollstlls enligt kompilatorns
+*                      anropskonvention.
+********************************************************************************/
+#define KERNEL_SAVE_CONTEXT                 \
+   "push r0                            \n\t" \
+   "in   r0, __SREG__                  \n\t" \
+   "cli                                \n\t" \
+   "push r0                            \n\t" \
+   "push r1                            \n\t" \
+   "clr  r1                            \n\t" \
+   "push r2                            \n\t" \
+   "push r3                            \n\t" \
+   "push r4                            \n\t" \
+   "push r5                            \n\t" \
+   "push r6                            \n\t" \
+   "push r7                            \n\t" \
+   "push r8                            \n\t" \
+   "push r9                            \n\t" \
+   "push r10                           \n\t" \
+   "push r11                           \n\t" \
+   "push r12                           \n\t" \
+   "push r13                           \n\t" \
+   "push r14                           \n\t" \
+   "push r15                           \n\t" \
+   "push r16                           \n\t" \
+   "push r17                           \n\t" \
+   "push r18                           \n\t" \
+   "push r19                           \n\t" \
+   "push r20                           \n\t" \
+   "push r21                           \n\t" \
+   "push r22                           \n\t" \
+   "push r23                           \n\t" \
+   "push r24                           \n\t" \
+   "push r25                           \n\t" \
+   "push r26                           \n\t" \
+   "push r27                           \n\t" \
+   "push r28                           \n\t" \
+   "push r29                           \n\t" \
+   "push r30                           \n\t" \
+   "push r31                           \n\t" \
+   "lds  r26, kernel_current_task      \n\t" \
+   "lds  r27, kernel_current_task + 1  \n\t" \
+   "in   r0, __SP_L__                  \n\t" \
+   "st   x+, r0                        \n\t" \
+   "in   r0, __SP_H__                  \n\t" \
+   "st   x+, r0                        \n\t"
+
+/********************************************************************************
+* KERNEL_RESTORE_CONTEXT: Lser stackpekaren frn aktuell tasks kontrollblock
+*                         och terstller r31 - r1, SREG samt r0 frn stacken.
+********************************************************************************/
+#define KERNEL_RESTORE_CONTEXT              \
+   "lds  r26, kernel_current_task      \n\t" \
+   "lds  r27, kernel_current_task + 1  \n\t" \
+   "ld   r28, x+                       \n\t" \
+   "out  __SP_L__, r28                 \n\t" \
+   "ld   r29, x+                       \n\t" \
+   "out  __SP_H__, r29                 \n\t" \
+   "pop  r31                           \n\t" \
+   "pop  r30                           \n\t" \
+   "pop  r29                           \n\t" \
+   "pop  r28                           \n\t" \
+   "pop  r27                           \n\t" \
+   "pop  r26                           \n\t" \
+   "pop  r25                           \n\t" \
+   "pop  r24                           \n\t" \
+   "pop  r23                           \n\t" \
+   "pop  r22                           \n\t" \
+   "pop  r21                           \n\t" \
+   "pop  r20                           \n\t" \
+   "pop  r19                           \n\t" \
+   "pop  r18                           \n\t" \
+   "pop  r17                           \n\t" \
+   "pop  r16                           \n\t" \
+   "pop  r15                           \n\t" \
+   "pop  r14                           \n\t" \
+   "pop  r13                           \n\t" \
+   "pop  r12                           \n\t" \
+   "pop  r11                           \n\t" \
+   "pop  r10                           \n\t" \
+   "pop  r9                            \n\t" \
+   "pop  r8                            \n\t" \
+   "pop  r7                            \n\t" \
+   "pop  r6                            \n\t" \
+   "pop  r5                            \n\t" \
+   "pop  r4                            \n\t" \
+   "pop  r3                            \n\t" \
+   "pop  r2                            \n\t" \
+   "pop  r1                            \n\t" \
+   "pop  r0                            \n\t" \
+   "out  __SREG__, r0                  \n\t" \
+   "pop  r0                            \n\t"
+
+/* Konstanter: */
+static constexpr uint16_t IDLE_STACK_SIZE = kernel::MIN_STACK_SIZE; /* Stackstorlek fr idle-tasken. */
+static constexpr uint8_t CONTEXT_SIZE = 33;                          /* Antalet byte i ett sparat kontext (r0 - r31 samt SREG). */
+static constexpr uint8_t STACK_FILL = 0xA5;                          /* Mnster fr mtning av stackanvndning. */
+static constexpr uint8_t IDLE_INDEX = 0xFF;                          /* Index fr idle-tasken. */
+
+/* Aktuell task, lses och skrivs via symbolnamnet i kontextbytet: */
+extern "C" { kernel::tcb* volatile kernel_current_task = nullptr; }
+
+/* Statiska variabler: */
+static kernel::tcb* tasks[kernel::MAX_TASKS]; /* Tillagda tasks. */
+static uint8_t num_tasks = 0;                 /* Antalet tillagda tasks. */
+static uint8_t current_index = IDLE_INDEX;    /* Index fr aktuell task. */
+static kernel::tcb idle_task;                 /* Idle-taskens kontrollblock. */
+static uint8_t idle_stack[IDLE_STACK_SIZE];   /* Idle-taskens stack. */
+static volatile uint32_t tick_count = 0;      /* Antalet ticks sedan start. */
+static uint8_t tick_step = 16;                /* Tickintervall mtt i ticks fr tidsbasen. */
+static uint8_t next_compare = 0;              /* Tidsbasens vrde vid nsta tick. */
+static bool started = false;                  /* Indikerar ifall krnan har startats. */
+static volatile bool isr_active = false;      /* Indikerar att en avbrottsrutin via KERNEL_ISR krs. */
+static volatile bool switch_pending = false;  /* Indikerar kontextbyte vid avbrottets slut. */
+
+/********************************************************************************
+* task_exit: Anropas om en task returnerar. Tasken suspenderas och krs inte
+*            igen.
+********************************************************************************/
+static void task_exit(void)
+{
+   asm("CLI");
+   kernel::current()->state = kernel::state::suspended;
+   kernel::yield();
+   while (1);
+}
+
+/********************************************************************************
+* idle: Idle-task som krs nr ingen annan task r redo. Processorn frstts
+*       i Idle Mode, dr Timer 2 fortstter rkna, s att nsta tick vcker
+*       processorn.
+********************************************************************************/
+static void idle(void)
+{
+   while (1)
+   {
+      SMCR = (1 << SE);
+      asm("SLEEP");
+      SMCR = 0x00;
+   }
+}
+
+/********************************************************************************
+* init_stack: Frbereder angiven stack s att den ser ut som om tasken hade
+*             gjort ett kontextbyte precis innan angiven funktion. verst
+*             ligger returadressen till task_exit, fljt av funktionens adress
+*             (som terhoppsadress fr RET) samt ett kontext dr samtliga
+*             register r noll och avbrott r aktiverade i SREG. Returadresser
+*             lagras med den minst signifikanta byten p den hgre adressen.
+*
+*             - stack     : Pekare till stacken.
+*             - stack_size: Stackens storlek i byte.
+*             - function  : Pekare till taskens funktion.
+********************************************************************************/
+static volatile uint8_t* init_stack(uint8_t* stack,
+                                    const uint16_t stack_size,
+                                    void (*function)(void))
+{
+   for (uint16_t i = 0; i < stack_size; ++i)
+   {
+      stack[i] = STACK_FILL;
+   }
+
+   auto sp = stack + stack_size - 1;
+   const auto exit_address = static_cast<uint16_t>(reinterpret_cast<uintptr_t>(&task_exit));
+   const auto function_address = static_cast<uint16_t>(reinterpret_cast<uintptr_t>(function));
+
+   *sp-- = static_cast<uint8_t>(exit_address);
+   *sp-- = static_cast<uint8_t>(exit_address >> 8);
+   *sp-- = static_cast<uint8_t>(function_address);
+   *sp-- = static_cast<uint8_t>(function_address >> 8);
+
+   *sp-- = 0x00;         /* r0. */
+   *sp-- = (1 << SREG_I); /* SREG. */
+
+   for (uint8_t i = 1; i < CONTEXT_SIZE - 1; ++i)
+   {
+      *sp-- = 0x00;      /* r1 - r31. */
+   }
+   return sp;
+}
+
+/********************************************************************************
+* kernel_select: Vljer den task med hgst prioritet som r redo. Skningen
+*                startar efter aktuell task, s att tasks med samma prioritet
+*                turas om. Om ingen task r redo vljs idle-tasken. Anropas
+*                frn kontextbytet med avbrott inaktiverade.
+********************************************************************************/
+extern "C" __attribute__((used)) void kernel_select(void)
+{
+   auto next = IDLE_INDEX;
+   auto index = current_index == IDLE_INDEX ? num_tasks - 1 : current_index;
+
+   for (uint8_t i = 0; i < num_tasks; ++i)
+   {
+      if (++index >= num_tasks) index = 0;
+      const auto task = tasks[index];
+
+      if (task->state == kernel::state::ready &&
+          (next == IDLE_INDEX || task->priority > tasks[next]->priority))
+      {
+         next = index;
+      }
+   }
+
+   current_index = next;
+   kernel_current_task = next == IDLE_INDEX ? &idle_task : tasks[next];
+   return;
+}
+
+/********************************************************************************
+* kernel_tick: Rknar upp antalet ticks och vcker sovande tasks vars tid har
+*              lpt ut, frutsatt att tidsbasen har ntt nsta tick. Annars
+*              orsakades avbrottet av reschedule, som programmerar ett tidigare
+*              compare-vrde fr att tvinga fram ett kontextbyte. Drefter
+*              programmeras nsta tick och nsta task vljs. Om avbrottet har
+*              frdrjts mer n ett tickintervall rknas samtliga passerade
+*              ticks, s att OCR2B aldrig programmeras till ett passerat vrde.
+********************************************************************************/
+extern "C" __attribute__((used)) void kernel_tick(void)
+{
+   while (static_cast<int8_t>(TCNT2 - next_compare) >= 0)
+   {
+      next_compare += tick_step;
+      tick_count = tick_count + 1;
+
+      for (uint8_t i = 0; i < num_tasks; ++i)
+      {
+         const auto task = tasks[i];
+
+         if (task->state == kernel::state::sleeping &&
+             static_cast<int32_t>(tick_count - task->wake_tick) >= 0)
+         {
+            task->state = kernel::state::ready;
+         }
+      }
+   }
+
+   OCR2B = next_compare;
+   kernel_select();
+   return;
+}
+
+/********************************************************************************
+* kernel_switch: Sparar aktuellt kontext, vljer nsta task och terstller
+*                dess kontext. Anropas frn kernel::yield.
+********************************************************************************/
+extern "C" __attribute__((naked, used, noinline)) void kernel_switch(void)
+{
+   asm volatile(KERNEL_SAVE_CONTEXT
+                "call kernel_select \n\t"
+                KERNEL_RESTORE_CONTEXT
+                "ret                \n\t");
+}
+
+/********************************************************************************
+* kernel_tick_switch: Sparar aktuellt kontext, hanterar tick, vljer nsta
+*                     task och terstller dess kontext. Anropas frn
+*                     tick-avbrottet.
+********************************************************************************/
+extern "C" __attribute__((naked, used, noinline)) void kernel_tick_switch(void)
+{
+   asm volatile(KERNEL_SAVE_CONTEXT
+                "call kernel_tick   \n\t"
+                KERNEL_RESTORE_CONTEXT
+                "ret                \n\t");
+}
+
+/********************************************************************************
+* kernel_start_first: terstller kontextet fr vald task utan att spara
+*                     ngot, vilket startar den frsta tasken.
+********************************************************************************/
+extern "C" __attribute__((naked, used, noinline)) void kernel_start_first(void)
+{
+   asm volatile(KERNEL_RESTORE_CONTEXT
+                "ret                \n\t");
+}
+
+/********************************************************************************
+* create: Initierar angivet kontrollblock med angiven stack, funktion samt
+*         prioritet och lgger till tasken i krnan. Returnerar false om
+*         krnan redan innehller MAX_TASKS tasks eller om stacken r fr liten.
+*
+*         - task      : Referens till taskens kontrollblock.
+*         - stack     : Pekare till taskens stack.
+*         - stack_size: Stackens storlek i byte.
+*         - function  : Pekare till funktionen som utgr tasken.
+*         - priority  : Prioritet, dr hgre vrde ger hgre prioritet.
+********************************************************************************/
+bool kernel::create(tcb& task,
+                    uint8_t* stack,
+                    const uint16_t stack_size,
+                    void (*function)(void),
+                    const uint8_t priority)
+{
+   if (num_tasks >= MAX_TASKS || stack_size < MIN_STACK_SIZE) return false;
+
+   task.sp = init_stack(stack, stack_size, function);
+   task.priority = priority;
+   task.base_priority = priority;
+   task.state = state::ready;
+   task.waiting_on = nullptr;
+   task.waiting_on_mutex = false;
+   tasks[num_tasks++] = &task;
+   return true;
+}
+
+/********************************************************************************
+* init: Initierar krnan med angivet tickintervall. Compare-register OCR2B
+*       fr Timer 2 programmeras till nsta tick, varefter compare-avbrott
+*       aktiveras nr krnan startas.
+*
+*       - tick_us: Tid mellan varje tick mtt i mikrosekunder.
+********************************************************************************/
+void kernel::init(const uint16_t tick_us)
+{
+   const auto step = static_cast<uint16_t>(tick_us / power::TICK_US + 0.5);
+   tick_step = step < 1 ? 1 : step > 127 ? 127 : static_cast<uint8_t>(step);
+
+   idle_task.sp = init_stack(idle_stack, IDLE_STACK_SIZE, &idle);
+   idle_task.priority = 0;
+   idle_task.base_priority = 0;
+   idle_task.state = state::ready;
+   tick_count = 0;
+   return;
+}
+
+/********************************************************************************
+* start: Startar krnan genom att vxla till den task med hgst prioritet.
+*        Anropet returnerar aldrig.
+********************************************************************************/
+void kernel::start(void)
+{
+   asm("CLI");
+   next_compare = TCNT2 + tick_step;
+   OCR2B = next_compare;
+   TIFR2 = (1 << OCF2B);
+   TIMSK2 |= (1 << OCIE2B);
+
+   current_index = IDLE_INDEX;
+   started = true;
+   kernel_select();
+   asm volatile("jmp kernel_start_first");
+   while (1);
+}
+
+/********************************************************************************
+* yield: Ger upp processorn till nsta task med samma eller hgre prioritet.
+*        Alla register sparas av kontextbytet, s ingen registerlista krvs.
+********************************************************************************/
+void kernel::yield(void)
+{
+   asm volatile("call kernel_switch" ::: "memory");
+   return;
+}
+
+/********************************************************************************
+* sleep: Frstter aktuell task i vila under angivet antal ticks.
+*
+*        - num_ticks: Antalet ticks som tasken ska vila.
+********************************************************************************/
+void kernel::sleep(const uint32_t num_ticks)
+{
+   if (!num_ticks) return;
+   critical_section lock;
+   kernel_current_task->wake_tick = tick_count + num_ticks;
+   kernel_current_task->state = state::sleeping;
+   kernel::yield();
+   return;
+}
+
+/********************************************************************************
+* sleep_ms: Frstter aktuell task i vila under angiven tid, avrundat uppt
+*           till nrmaste tick.
+*
+*           - time_ms: Tiden mtt i millisekunder.
+********************************************************************************/
+void kernel::sleep_ms(const uint32_t time_ms)
+{
+   const auto tick_time_us = kernel::tick_us();
+   kernel::sleep(static_cast<uint32_t>((time_ms * 1000.0 + tick_time_us - 1) / tick_time_us));
+   return;
+}
+
+/********************************************************************************
+* ticks: Returnerar antalet ticks sedan krnan startades.
+********************************************************************************/
+uint32_t kernel::ticks(void)
+{
+   critical_section lock;
+   return tick_count;
+}
+
+/********************************************************************************
+* tick_us: Returnerar faktisk tid mellan varje tick mtt i mikrosekunder.
+********************************************************************************/
+double kernel::tick_us(void)
+{
+   return tick_step * power::TICK_US;
+}
+
+/********************************************************************************
+* current: Returnerar en pekare till kontrollblocket fr aktuell task.
+********************************************************************************/
+kernel::tcb* kernel::current(void)
+{
+   return kernel_current_task;
+}
+
+/********************************************************************************
+* block: Blockerar aktuell task p angivet objekt och vxlar till nsta task.
+*        Tasken vljs inte igen frrn den har vckts via wake.
+*
+*        - object  : Pekare till objektet som tasken vntar p.
+*        - is_mutex: Indikerar ifall objektet r en mutex.
+********************************************************************************/
+void kernel::block(const void* object,
+                   const bool is_mutex)
+{
+   kernel_current_task->waiting_on = object;
+   kernel_current_task->waiting_on_mutex = is_mutex;
+   kernel_current_task->state = state::blocked;
+   kernel::yield();
+   return;
+}
+
+/********************************************************************************
+* wake: Vcker den task med hgst prioritet som vntar p angivet objekt och
+*       returnerar en pekare till dess kontrollblock, alternativt nullptr.
+*
+*       - object: Pekare till objektet som tasken vntar p.
+********************************************************************************/
+kernel::tcb* kernel::wake(const void* object)
+{
+   tcb* woken = nullptr;
+
+   for (uint8_t i = 0; i < num_tasks; ++i)
+   {
+      const auto task = tasks[i];
+
+      if (task->state == state::blocked && task->waiting_on == object &&
+          (!woken || task->priority > woken->priority))
+      {
+         woken = task;
+      }
+   }
+
+   if (woken)
+   {
+      woken->state = state::ready;
+      woken->waiting_on = nullptr;
+      woken->waiting_on_mutex = false;
+   }
+   return woken;
+}
+
+/********************************************************************************
+* reschedule: Vxlar till en vckt task om den har hgre prioritet n aktuell
+*             task. I en avbrottsrutin definierad via KERNEL_ISR markeras
+*             kontextbytet till isr_exit. Om avbrott i vrigt r inaktiverade
+*             (annan avbrottsrutin eller kritisk sektion) programmeras OCR2B
+*             till nsta tick i tidsbasen, varvid kontextbytet sker i
+*             tick-avbrottet inom 64 us. Innan krnan har startats sker inget.
+*
+*             - woken: Pekare till kontrollblocket fr den vckta tasken.
+********************************************************************************/
+void kernel::reschedule(const tcb* woken)
+{
+   if (!started || !woken || woken->priority <= kernel_current_task->priority) return;
+
+   if (SREG & (1 << SREG_I))
+   {
+      kernel::yield();
+   }
+   else if (isr_active)
+   {
+      switch_pending = true;
+   }
+   else if (static_cast<uint8_t>(next_compare - TCNT2) > 1)
+   {
+      OCR2B = TCNT2 + 1;
+   }
+   return;
+}
+
+/********************************************************************************
+* isr_enter: Markerar att en avbrottsrutin definierad via KERNEL_ISR krs.
+********************************************************************************/
+void kernel::isr_enter(void)
+{
+   isr_active = true;
+   return;
+}
+
+/********************************************************************************
+* isr_exit: Vxlar till nsta task via samma kontextbyte som kernel::yield,
+*           frutsatt att reschedule har markerat ett kontextbyte. Avbrott r
+*           inaktiverade, s det sparade kontextet terstlls med avbrott
+*           inaktiverade och tervnder hit, varefter avbrottsrutinen
+*           avslutas med RETI som vanligt.
+********************************************************************************/
+void kernel::isr_exit(void)
+{
+   isr_active = false;
+   if (!switch_pending) return;
+
+   switch_pending = false;
+   kernel::yield();
+   return;
+}
+
+/********************************************************************************
+* inherit_priority: Lter garen till en mutex rva angiven prioritet. Om
+*                   garen i sin tur vntar p en annan mutex rver ven den
+*                   mutexens gare prioriteten, och s vidare.
+*
+*                   - owner   : Pekare till mutexens gare.
+*                   - priority: Prioriteten som ska rvas.
+********************************************************************************/
+void kernel::inherit_priority(tcb* owner,
+                              const uint8_t priority)
+{
+   while (owner && owner->priority < priority)
+   {
+      owner->priority = priority;
+      if (owner->state != state::blocked || !owner->waiting_on_mutex) break;
+      owner = const_cast<tcb*>(static_cast<const mutex*>(owner->waiting_on)->owner());
+   }
+   return;
+}
+
+/********************************************************************************
+* restore_priority: terstller aktuell tasks prioritet till tilldelad
+*                   prioritet eller till den hgsta prioriteten bland tasks
+*                   som vntar p en mutex som aktuell task fortfarande hller.
+********************************************************************************/
+void kernel::restore_priority(void)
+{
+   auto priority = kernel_current_task->base_priority;
+
+   for (uint8_t i = 0; i < num_tasks; ++i)
+   {
+      const auto task = tasks[i];
+
+      if (task->state == state::blocked && task->waiting_on_mutex &&
+          static_cast<const mutex*>(task->waiting_on)->owner() == kernel_current_task &&
+          task->priority > priority)
+      {
+         priority = task->priority;
+      }
+   }
+
+   kernel_current_task->priority = priority;
+   return;
+}
+
+/********************************************************************************
+* benchmark_switch: Mter genomsnittlig tid fr ett kontextbyte via angivet
+*                   antal anrop av kernel::yield och returnerar resultatet i
+*                   klockcykler. Tiden mts via tidsbasen, vars upplsning p
+*                   64 us (1024 klockcykler) frdelas ver samtliga iterationer.
+*
+*                   - iterations: Antalet kontextbyten.
+********************************************************************************/
+uint32_t kernel::benchmark_switch(const uint16_t iterations)
+{
+   if (!iterations) return 0;
+   const auto start = power::now();
+
+   for (uint16_t i = 0; i < iterations; ++i)
+   {
+      kernel::yield();
+   }
+
+   const auto elapsed = power::now() - start;
+   return static_cast<uint32_t>(elapsed * power::TICK_US * (F_CPU / 1000000UL) / iterations + 0.5);
+}
+
+/********************************************************************************
+* ISR (TIMER2_COMPB_vect): Tick-avbrott fr krnan. Rutinen saknar prolog
+*                          och epilog, eftersom kontextbytet sparar samtliga
+*                          register. Kontextet sparas i kernel_tick_switch,
+*                          s att terhoppsadressen pekar p RETI nedan.
+********************************************************************************/
+ISR (TIMER2_COMPB_vect, ISR_NAKED)
+{
+   asm volatile("call kernel_tick_switch \n\t"
+                "reti                    \n\t");
+}
@@ -0,0 +1,575 @@
+/********************************************************************************
+* kernel.hpp: Innehller en liten preemptiv realtidskrna med fast prioritet.
+*             Ett fast antal tasks med statiskt allokerade stackar krs
+*             parallellt, dr den task med hgst prioritet som r redo alltid
+*             krs. Tasks med samma prioritet delar p processorn (round-robin)
+*             vid varje tick. Kontextbyte sker vid varje tick, nr en task
+*             blockeras eller ger upp processorn via kernel::yield, samt nr
+*             en task med hgre prioritet blir redo via en semafor, en k
+*             eller en mutex.
+*
+*             Avbrottsrutiner som signalerar en semafor eller en k definieras
+*             via makrot KERNEL_ISR, s att en vckt task med hgre prioritet
+*             krs direkt nr avbrottet avslutas, exempelvis:
+*
+*             KERNEL_ISR (INT0_vect, on_sensor);
+*
+*             I vriga avbrottsrutiner sker bytet i stllet vid nsta tick i
+*             tidsbasen, dvs. upp till 64 us senare.
+*
+*             Tick genereras via compare-register OCR2B fr Timer 2, som redan
+*             rknar kontinuerligt som tidsbas i power.hpp, s ingen ytterligare
+*             hrdvarutimer krvs. Tickintervallet vljs vid initiering i steg
+*             om tidsbasens upplsning (64 us), mellan 64 us och 8.128 ms.
+*             power::init mste drmed anropas innan kernel::init.
+*
+*             Kontextbytet r skrivet i assembler. Samtliga 32 register samt
+*             statusregistret SREG sparas p aktuell tasks stack, varefter
+*             stackpekaren lagras i taskens kontrollblock. Drefter vljs nsta
+*             task och dess register terstlls frn dess stack. Avbrottsrutiner
+*             krs p aktuell tasks stack, s varje stack mste rymma taskens
+*             egen anvndning plus ett sparat kontext (37 byte) samt det strsta
+*             avbrottet i systemet, drav MIN_STACK_SIZE. Ett kontextbyte i
+*             KERNEL_ISR sker ovanp avbrottsrutinens egna sparade register,
+*             vilket krver upp till ytterligare ca 20 byte.
+*
+*             Synkroniseringsprimitiver:
+*
+*             - mutex    : msesidig uteslutning med prioritetsarv, dvs. en task
+*                          med lg prioritet som hller en mutex som en task med
+*                          hgre prioritet vntar p rver den hgre prioriteten
+*                          tills mutexen slpps (ven i flera led).
+*             - semaphore: Rknande semafor, som kan signaleras frn avbrottsrutiner.
+*             - queue    : K med fast kapacitet, dr sndaren blockeras nr kn
+*                          r full och mottagaren blockeras nr kn r tom.
+*
+*             Exempel:
+*
+*             kernel::task<128> control(&control_loop, 3);
+*             kernel::task<192> logger(&print_log, 1);
+*
+*             power::init();
+*             kernel::init(1000);
+*             kernel::start();
+*
+*             Kontextbytestiden kan mtas via kernel::benchmark_switch, som
+*             returnerar genomsnittligt antal klockcykler per kontextbyte.
+********************************************************************************/
+#ifndef KERNEL_HPP_
+#define KERNEL_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "power.hpp"
+#include "atomic.hpp"
+#include "queue.hpp"
+
+/********************************************************************************
+* KERNEL_ISR: Makro fr definition av avbrottsrutiner som kan vcka en task.
+*             Angiven funktion anropas direkt frn avbrottsrutinen, varefter
+*             kernel::isr_exit vxlar till en vckt task med hgre prioritet
+*             innan avbrottet avslutas med RETI.
+*
+*             - vector_name: Avbrottsvektorn, exempelvis INT0_vect.
+*             - function   : Funktionen som ska anropas vid avbrott.
+********************************************************************************/
+#define KERNEL_ISR(vector_name, function) \
+   ISR (vector_name)                       \
+   {                                       \
+      kernel::isr_enter();                 \
+      function();                          \
+      kernel::isr_exit();                  \
+   }
+
+/********************************************************************************
+* kernel: Namnrymd innehllande preemptiv realtidskrna.
+********************************************************************************/
+namespace kernel
+{
+   static constexpr uint8_t MAX_TASKS = 6;        /* Maximalt antal tasks (exklusive idle-tasken). */
+   static constexpr uint16_t MIN_STACK_SIZE = 96; /* Minsta tilltna stackstorlek i byte. */
+
+   /********************************************************************************
+   * state: Enumerationsklass fr en tasks tillstnd.
+   ********************************************************************************/
+   enum class state : uint8_t
+   {
+      ready,    /* Redo att kras (eller krs). */
+      blocked,  /* Vntar p en mutex, en semafor eller en k. */
+      sleeping, /* Vntar p att angivet antal ticks ska passera. */
+      suspended /* Avslutad, krs inte igen. */
+   };
+
+   /********************************************************************************
+   * tcb: Strukt fr en tasks kontrollblock. Stackpekaren mste ligga frst,
+   *      eftersom den lses och skrivs via dess adress i kontextbytet.
+   ********************************************************************************/
+   struct tcb
+   {
+      volatile uint8_t* sp = nullptr;           /* Sparad stackpekare (mste ligga frst). */
+      uint8_t priority = 0;                     /* Aktuell prioritet (inklusive rvd prioritet). */
+      uint8_t base_priority = 0;                /* Tilldelad prioritet. */
+      volatile enum state state = state::ready; /* Taskens tillstnd. */
+      uint32_t wake_tick = 0;                   /* Tick d en sovande task ska vckas. */
+      const void* waiting_on = nullptr;         /* Objekt som en blockerad task vntar p. */
+      bool waiting_on_mutex = false;            /* Indikerar ifall objektet r en mutex. */
+   };
+
+   /********************************************************************************
+   * create: Initierar angivet kontrollblock med angiven stack, funktion samt
+   *         prioritet och lgger till tasken i krnan. Stacken frbereds s
+   *         att den ser ut som om tasken hade gjort ett kontextbyte precis
+   *         innan funktionens frsta instruktion. Om tasken returnerar
+   *         suspenderas den. Returnerar false om krnan redan innehller
+   *         MAX_TASKS tasks eller om stacken r fr liten.
+   *
+   *         - task      : Referens till taskens kontrollblock.
+   *         - stack     : Pekare till taskens stack.
+   *         - stack_size: Stackens storlek i byte.
+   *         - function  : Pekare till funktionen som utgr tasken.
+   *         - priority  : Prioritet, dr hgre vrde ger hgre prioritet.
+   ********************************************************************************/
+   bool create(tcb& task,
+               uint8_t* stack,
+               const uint16_t stack_size,
+               void (*function)(void),
+               const uint8_t priority);
+
+   /********************************************************************************
+   * task: Klass fr tasks med statiskt allokerad stack av angiven storlek.
+   *       Tasken lggs till i krnan nr objektet skapas, vilket gr att
+   *       tasks deklareras som globala eller statiska objekt.
+   ********************************************************************************/
+   template<uint16_t STACK_SIZE>
+   class task : public tcb
+   {
+   private:
+      static_assert(STACK_SIZE >= MIN_STACK_SIZE, "Task stack is too small!");
+      uint8_t stack_[STACK_SIZE]; /* Taskens stack. */
+
+   public:
+
+      /********************************************************************************
+      * task: Initierar ny task med angiven funktion och prioritet.
+      *
+      *       - function: Pekare till funktionen som utgr tasken.
+      *       - priority: Prioritet, dr hgre vrde ger hgre prioritet.
+      ********************************************************************************/
+      task(void (*function)(void),
+           const uint8_t priority)
+      {
+         kernel::create(*this, this->stack_, STACK_SIZE, function, priority);
+         return;
+      }
+
+      /********************************************************************************
+      * task: Kopieringskonstruktor raderad.
+      ********************************************************************************/
+      task(task&) = delete;
+
+      /********************************************************************************
+      * task: Tilldelningsoperator raderad.
+      ********************************************************************************/
+      task& operator= (task&) = delete;
+
+      /********************************************************************************
+      * stack_used: Returnerar maximalt anvnt stackutrymme i byte, vilket mts
+      *             genom att rkna hur stor del av stacken som har skrivits
+      *             ver sedan den fylldes med mnstret 0xA5 vid initiering.
+      ********************************************************************************/
+      uint16_t stack_used(void) const
+      {
+         uint16_t unused = 0;
+         while (unused < STACK_SIZE && this->stack_[unused] == 0xA5) unused++;
+         return STACK_SIZE - unused;
+      }
+   };
+
+   /********************************************************************************
+   * init: Initierar krnan med angivet tickintervall, vilket avrundas till
+   *       nrmaste multipel av tidsbasens upplsning (64 us).
+   *
+   *       - tick_us: Tid mellan varje tick mtt i mikrosekunder (default = 1000).
+   ********************************************************************************/
+   void init(const uint16_t tick_us = 1000);
+
+   /********************************************************************************
+   * start: Startar krnan genom att vxla till den task med hgst prioritet.
+   *        Anropet returnerar aldrig och huvudprogrammets stack anvnds inte
+   *        drefter.
+   ********************************************************************************/
+   void start(void);
+
+   /********************************************************************************
+   * yield: Ger upp processorn till nsta task med samma eller hgre prioritet.
+   ********************************************************************************/
+   void yield(void);
+
+   /********************************************************************************
+   * sleep: Frstter aktuell task i vila under angivet antal ticks.
+   *
+   *        - num_ticks: Antalet ticks som tasken ska vila.
+   ********************************************************************************/
+   void sleep(const uint32_t num_ticks);
+
+   /********************************************************************************
+   * sleep_ms: Frstter aktuell task i vila under angiven tid, avrundat uppt
+   *           till nrmaste tick.
+   *
+   *           - time_ms: Tiden mtt i millisekunder.
+   ********************************************************************************/
+   void sleep_ms(const uint32_t time_ms);
+
+   /********************************************************************************
+   * ticks: Returnerar antalet ticks sedan krnan startades.
+   ********************************************************************************/
+   uint32_t ticks(void);
+
+   /********************************************************************************
+   * tick_us: Returnerar faktisk tid mellan varje tick mtt i mikrosekunder.
+   ********************************************************************************/
+   double tick_us(void);
+
+   /********************************************************************************
+   * current: Returnerar en pekare till kontrollblocket fr aktuell task.
+   ********************************************************************************/
+   tcb* current(void);
+
+   /********************************************************************************
+   * block: Blockerar aktuell task p angivet objekt och vxlar till nsta task.
+   *        Returnerar nr tasken har vckts via wake. Avbrott mste vara
+   *        inaktiverade vid anrop och r det ven vid terkomst. Anvnds av
+   *        synkroniseringsprimitiverna.
+   *
+   *        - object  : Pekare till objektet som tasken vntar p.
+   *        - is_mutex: Indikerar ifall objektet r en mutex.
+   ********************************************************************************/
+   void block(const void* object,
+              const bool is_mutex = false);
+
+   /********************************************************************************
+   * wake: Vcker den task med hgst prioritet som vntar p angivet objekt och
+   *       returnerar en pekare till dess kontrollblock, alternativt nullptr om
+   *       ingen task vntar. Avbrott mste vara inaktiverade vid anrop.
+   *
+   *       - object: Pekare till objektet som tasken vntar p.
+   ********************************************************************************/
+   tcb* wake(const void* object);
+
+   /********************************************************************************
+   * reschedule: Vxlar till en vckt task om den har hgre prioritet n aktuell
+   *             task. Frn en avbrottsrutin definierad via KERNEL_ISR sker
+   *             bytet nr avbrottet avslutas. Frn vriga avbrottsrutiner
+   *             (eller med avbrott inaktiverade) sker bytet i stllet vid
+   *             nsta tick i tidsbasen, dvs. inom 64 us.
+   *
+   *             - woken: Pekare till kontrollblocket fr den vckta tasken.
+   ********************************************************************************/
+   void reschedule(const tcb* woken);
+
+   /********************************************************************************
+   * isr_enter: Markerar att en avbrottsrutin definierad via KERNEL_ISR krs,
+   *            s att reschedule skjuter upp kontextbytet till isr_exit.
+   ********************************************************************************/
+   void isr_enter(void);
+
+   /********************************************************************************
+   * isr_exit: Vxlar till den task med hgst prioritet som r redo, frutsatt
+   *           att en task med hgre prioritet n aktuell task har vckts under
+   *           avbrottet. Anropas sist i avbrottsrutiner definierade via
+   *           KERNEL_ISR. Den avbrutna tasken fortstter hrifrn, och
+   *           avslutar drmed avbrottsrutinen, nr den vljs igen.
+   ********************************************************************************/
+   void isr_exit(void);
+
+   /********************************************************************************
+   * inherit_priority: Lter garen till angiven mutex rva angiven prioritet,
+   *                   samt garen till den mutex som garen i sin tur vntar
+   *                   p, och s vidare. Avbrott mste vara inaktiverade.
+   *
+   *                   - owner   : Pekare till mutexens gare.
+   *                   - priority: Prioriteten som ska rvas.
+   ********************************************************************************/
+   void inherit_priority(tcb* owner,
+                         const uint8_t priority);
+
+   /********************************************************************************
+   * restore_priority: terstller aktuell tasks prioritet till tilldelad
+   *                   prioritet eller till den hgsta prioriteten bland tasks
+   *                   som fortfarande vntar p en mutex som aktuell task
+   *                   hller. Avbrott mste vara inaktiverade.
+   ********************************************************************************/
+   void restore_priority(void);
+
+   /********************************************************************************
+   * benchmark_switch: Mter genomsnittlig tid fr ett kontextbyte via angivet
+   *                   antal anrop av kernel::yield och returnerar resultatet
+   *                   i klockcykler. Br anropas frn den task med hgst
+   *                   prioritet nr ingen annan task har samma prioritet,
+   *                   varvid varje anrop sparar och terstller ett fullt
+   *                   kontext samt vljer nsta task. Resultatet inkluderar
+   *                   drmed hela kontextbytet, inklusive valet av task.
+   *
+   *                   - iterations: Antalet kontextbyten (default = 1000).
+   ********************************************************************************/
+   uint32_t benchmark_switch(const uint16_t iterations = 1000);
+
+   /********************************************************************************
+   * mutex: Klass fr msesidig uteslutning med prioritetsarv. En mutex fr
+   *        endast lsas och lsas upp frn tasks, aldrig frn avbrottsrutiner.
+   ********************************************************************************/
+   class mutex
+   {
+   private:
+      tcb* owner_ = nullptr; /* Pekare till tasken som hller mutexen. */
+
+   public:
+
+      /********************************************************************************
+      * mutex: Defaultkonstruktor, initierar olst mutex.
+      ********************************************************************************/
+      mutex(void) { }
+
+      /********************************************************************************
+      * mutex: Kopieringskonstruktor raderad.
+      ********************************************************************************/
+      mutex(mutex&) = delete;
+
+      /********************************************************************************
+      * mutex: Tilldelningsoperator raderad.
+      ********************************************************************************/
+      mutex& operator= (mutex&) = delete;
+
+      /********************************************************************************
+      * owner: Returnerar en pekare till tasken som hller mutexen.
+      ********************************************************************************/
+      const tcb* owner(void) const
+      {
+         return this->owner_;
+      }
+
+      /********************************************************************************
+      * try_lock: Lser mutexen om den r ledig och returnerar true, annars false.
+      ********************************************************************************/
+      bool try_lock(void)
+      {
+         critical_section lock;
+         if (this->owner_) return false;
+         this->owner_ = kernel::current();
+         return true;
+      }
+
+      /********************************************************************************
+      * lock: Lser mutexen. Om mutexen hlls av en annan task blockeras aktuell
+      *       task, varvid garen rver aktuell tasks prioritet om den r hgre.
+      *       Mutexen verlmnas direkt till vntande task vid upplsning.
+      ********************************************************************************/
+      void lock(void)
+      {
+         critical_section lock;
+         if (!this->owner_)
+         {
+            this->owner_ = kernel::current();
+            return;
+         }
+
+         kernel::inherit_priority(this->owner_, kernel::current()->priority);
+         kernel::block(this, true);
+         return;
+      }
+
+      /********************************************************************************
+      * unlock: Lser upp mutexen. rvd prioritet terstlls och mutexen
+      *         verlmnas till den vntande task med hgst prioritet. Byte
+      *         till den vckta tasken sker efter den kritiska sektionen.
+      ********************************************************************************/
+      void unlock(void)
+      {
+         tcb* woken = nullptr;
+         {
+            critical_section lock;
+            if (this->owner_ != kernel::current()) return;
+
+            woken = kernel::wake(this);
+            this->owner_ = woken;
+            kernel::restore_priority();
+         }
+         kernel::reschedule(woken);
+         return;
+      }
+   };
+
+   /********************************************************************************
+   * semaphore: Klass fr rknande semaforer. Signalering kan ske bde frn
+   *            tasks och avbrottsrutiner, medan vntan endast fr ske frn tasks.
+   ********************************************************************************/
+   class semaphore
+   {
+   private:
+      volatile uint8_t count_ = 0; /* Semaforens rknare. */
+
+   public:
+
+      /********************************************************************************
+      * semaphore: Initierar semafor med angivet startvrde.
+      *
+      *            - count: Semaforens startvrde (default = 0).
+      ********************************************************************************/
+      semaphore(const uint8_t count = 0)
+         : count_(count) { }
+
+      /********************************************************************************
+      * semaphore: Kopieringskonstruktor raderad.
+      ********************************************************************************/
+      semaphore(semaphore&) = delete;
+
+      /********************************************************************************
+      * semaphore: Tilldelningsoperator raderad.
+      ********************************************************************************/
+      semaphore& operator= (semaphore&) = delete;
+
+      /********************************************************************************
+      * count: Returnerar semaforens rknare.
+      ********************************************************************************/
+      uint8_t count(void) const
+      {
+         return this->count_;
+      }
+
+      /********************************************************************************
+      * try_wait: Rknar ned semaforen och returnerar true om rknaren r strre
+      *           n noll, annars returneras false utan vntan.
+      ********************************************************************************/
+      bool try_wait(void)
+      {
+         critical_section lock;
+         if (!this->count_) return false;
+         this->count_ = this->count_ - 1;
+         return true;
+      }
+
+      /********************************************************************************
+      * wait: Rknar ned semaforen. Om rknaren r noll blockeras aktuell task
+      *       tills semaforen signaleras.
+      ********************************************************************************/
+      void wait(void)
+      {
+         critical_section lock;
+
+         if (this->count_)
+         {
+            this->count_ = this->count_ - 1;
+         }
+         else
+         {
+            kernel::block(this);
+         }
+         return;
+      }
+
+      /********************************************************************************
+      * signal: Signalerar semaforen. Om en task vntar vcks den med hgst
+      *         prioritet direkt, annars rknas rknaren upp. Byte till den
+      *         vckta tasken sker efter den kritiska sektionen, s att
+      *         reschedule kan avgra om anropet sker frn en avbrottsrutin.
+      ********************************************************************************/
+      void signal(void)
+      {
+         tcb* woken = nullptr;
+         {
+            critical_section lock;
+            woken = kernel::wake(this);
+            if (!woken && this->count_ < 0xFF) this->count_ = this->count_ + 1;
+         }
+         kernel::reschedule(woken);
+         return;
+      }
+   };
+
+   /********************************************************************************
+   * queue: Generisk klass fr ker mellan tasks med plats fr N - 1 element.
+   *        Sndaren blockeras nr kn r full och mottagaren nr kn r tom.
+   *        try_send kan anropas frn avbrottsrutiner.
+   ********************************************************************************/
+   template<class T, uint8_t N>
+   class queue
+   {
+   private:
+      ::queue<T, N> buffer_; /* Ringbuffert fr lagrade element. */
+      semaphore items_;      /* Antalet lagrade element. */
+      semaphore spaces_;     /* Antalet lediga platser. */
+
+   public:
+
+      /********************************************************************************
+      * queue: Defaultkonstruktor, initierar tom k.
+      ********************************************************************************/
+      queue(void)
+         : spaces_(N - 1) { }
+
+      /********************************************************************************
+      * queue: Kopieringskonstruktor raderad.
+      ********************************************************************************/
+      queue(queue&) = delete;
+
+      /********************************************************************************
+      * queue: Tilldelningsoperator raderad.
+      ********************************************************************************/
+      queue& operator= (queue&) = delete;
+
+      /********************************************************************************
+      * size: Returnerar antalet element lagrade i kn.
+      ********************************************************************************/
+      uint8_t size(void) const
+      {
+         return this->buffer_.size();
+      }
+
+      /********************************************************************************
+      * send: Lgger till angivet element sist i kn. Om kn r full blockeras
+      *       aktuell task tills en plats blir ledig.
+      *
+      *       - item: Referens till elementet som ska lggas till.
+      ********************************************************************************/
+      void send(const T& item)
+      {
+         this->spaces_.wait();
+         this->buffer_.push_shared(item);
+         this->items_.signal();
+         return;
+      }
+
+      /********************************************************************************
+      * try_send: Lgger till angivet element sist i kn om det finns plats och
+      *           returnerar true, annars false utan vntan.
+      *
+      *           - item: Referens till elementet som ska lggas till.
+      ********************************************************************************/
+      bool try_send(const T& item)
+      {
+         if (!this->spaces_.try_wait()) return false;
+         this->buffer_.push_shared(item);
+         this->items_.signal();
+         return true;
+      }
+
+      /********************************************************************************
+      * receive: Lser och tar bort frsta elementet i kn. Om kn r tom
+      *          blockeras aktuell task tills ett element finns.
+      *
+      *          - item: Referens till variabel dr elementet lagras.
+      ********************************************************************************/
+      void receive(T& item)
+      {
+         this->items_.wait();
+         {
+            critical_section lock;
+            this->buffer_.pop(item);
+         }
+         this->spaces_.signal();
+         return;
+      }
+   };
+}
+
+#endif /* KERNEL_HPP_ */
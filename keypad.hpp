@@ -0,0 +1,366 @@
+/********************************************************************************
+* keypad.hpp: Innehller drivrutiner fr matristangentbord med 4 x 4 tangenter
+*             via klassen keypad, vilket krver tta pinnar i stllet fr
+*             sexton.
+*
+*             Tangentbordet avsks med en rad per tick, dr scan anropas
+*             periodiskt frn en timer eller en task, frslagsvis var
+*             millisekund. Vald rad dras lg medan vriga rader lmnas
+*             hgimpediva, s att tv nedtryckta tangenter i samma kolumn
+*             inte kortsluter tv drivande utgngar. Kolumnerna r inportar
+*             med intern pullup-resistor, s nedtryckt tangent lses som lg.
+*             Kolumnerna lses i tick efter att raden valdes, vilket ger
+*             ledningarna en hel tick att stlla in sig.
+*
+*             Nr samtliga rader har lsts avstudsas alla sexton tangenter
+*             parallellt via vertikala rknare (samma metod som debounce.hpp),
+*             dr SAMPLES stabila avskningar krvs fr en flank. SAMPLES r
+*             fast satt till 4, eftersom rknarna har tv bitplan. Vid 1 kHz
+*             avsks hela tangentbordet var 4:e millisekund, vilket ger en
+*             avstudsningstid p 16 ms. En tick kostar ca 60 CPU-cykler och
+*             var fjrde tick ca 150 cykler till, vilket motsvarar under
+*             1 % CPU-last vid 1 kHz och 16 MHz.
+*
+*             Utan dioder vid tangenterna uppstr spkning nr tre tangenter
+*             i hrnen av en rektangel r nedtryckta, eftersom det fjrde
+*             hrnet d ocks lses som nedtryckt. Spkning detekteras genom
+*             att tv rader delar minst tv nedtryckta kolumner, varvid nya
+*             nedtryckningar hlls inne tills mnstret upphr. Uppslppningar
+*             rapporteras alltid. Med en diod per tangent kan kontrollen
+*             stngas av, vilket ger fullstndig n-key rollover.
+*
+*             Avstudsade flanker lggs i en lsfri k (queue.hpp), s att scan
+*             kan anropas frn en avbrottsrutin och hndelserna lsas frn
+*             huvudloopen via read.
+********************************************************************************/
+#ifndef KEYPAD_HPP_
+#define KEYPAD_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "atomic.hpp"
+#include "queue.hpp"
+
+/********************************************************************************
+* keypad: Klass fr avskning av matristangentbord med 4 x 4 tangenter.
+*         Tangenternas index r rad * 4 + kolumn, dvs. 0 - 15.
+********************************************************************************/
+class keypad
+{
+public:
+   static constexpr uint8_t ROWS = 4;       /* Antalet rader. */
+   static constexpr uint8_t COLUMNS = 4;    /* Antalet kolumner. */
+   static constexpr uint8_t SAMPLES = 4;    /* Antalet stabila avskningar som krvs fr en flank (fast vrde). */
+   static constexpr uint8_t QUEUE_SIZE = 8; /* Antalet platser i hndelsekn (7 hndelser). */
+
+   static_assert(SAMPLES == 4, "The keypad's vertical counters have two bit planes, i.e. four samples!");
+
+   /********************************************************************************
+   * event: Strukt innehllande en avstudsad hndelse fr en tangent.
+   ********************************************************************************/
+   struct event
+   {
+      uint8_t key;  /* Tangentens index, 0 - 15. */
+      bool pressed; /* Indikerar nedtryckning (true) eller uppslppning (false). */
+   };
+
+private:
+
+   /********************************************************************************
+   * line: Strukt innehllande register och bitmask fr en rad eller kolumn.
+   ********************************************************************************/
+   struct line
+   {
+      volatile uint8_t* reg = nullptr; /* Riktningsregister (rad) eller pinregister (kolumn). */
+      uint8_t mask = 0;                /* Bitmask fr pinnen i registret. */
+   };
+
+   line rows_[ROWS];                          /* Rader, vars riktningsregister anvnds vid avskning. */
+   line columns_[COLUMNS];                    /* Kolumner, vars pinregister lses vid avskning. */
+   const char* keymap_ = nullptr;             /* Tecken fr respektive tangent. */
+   uint8_t row_ = 0;                          /* Aktuell vald rad. */
+   bool diodes_ = false;                      /* Indikerar dioder vid tangenterna (ingen spkning). */
+   volatile bool ghosting_ = false;           /* Indikerar pgende spkning. */
+   uint16_t frame_ = 0;                       /* Avlsning fr aktuell avskning. */
+   uint16_t level_ = 0;                       /* Avstudsad niv, bit n = tangent n nedtryckt. */
+   uint16_t count0_ = 0;                      /* Bit 0 i respektive tangents vertikala rknare. */
+   uint16_t count1_ = 0;                      /* Bit 1 i respektive tangents vertikala rknare. */
+   atomic<uint16_t> dropped_;                 /* Antalet hndelser som inte fick plats i kn. */
+   ::queue<event, QUEUE_SIZE> events_;        /* K fr avstudsade hndelser. */
+
+   /********************************************************************************
+   * init_line: Tar fram register och bitmask fr angiven pin. Rader ges
+   *            riktningsregistret och kolumner pinregistret. Pinnen stts
+   *            till inport, med intern pullup-resistor fr kolumner samt
+   *            lg utniv (hgimpediv tills raden vljs) fr rader.
+   *
+   *            - line  : Referens till raden eller kolumnen som ska initieras.
+   *            - pin   : Pin-nummer p Arduino Uno, exempelvis 4 eller A0.
+   *            - column: Indikerar ifall pinnen r en kolumn.
+   ********************************************************************************/
+   static void init_line(line& line,
+                         const uint8_t pin,
+                         const bool column)
+   {
+      volatile uint8_t* ddr = nullptr;
+      volatile uint8_t* port = nullptr;
+
+      if (pin <= 7)
+      {
+         line.mask = (1 << pin);
+         ddr = &DDRD;
+         port = &PORTD;
+         line.reg = column ? &PIND : &DDRD;
+      }
+      else if (pin <= 13)
+      {
+         line.mask = (1 << (pin - 8));
+         ddr = &DDRB;
+         port = &PORTB;
+         line.reg = column ? &PINB : &DDRB;
+      }
+      else if (pin <= 19)
+      {
+         line.mask = (1 << (pin - 14));
+         ddr = &DDRC;
+         port = &PORTC;
+         line.reg = column ? &PINC : &DDRC;
+      }
+      else
+      {
+         return;
+      }
+
+      *ddr &= ~line.mask;
+
+      if (column)
+      {
+         *port |= line.mask;
+      }
+      else
+      {
+         *port &= ~line.mask;
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * ghosted: Indikerar ifall angiven niv innehller en rektangel av
+   *          nedtryckta tangenter, dvs. tv rader som delar minst tv
+   *          nedtryckta kolumner, vilket kan vara en spktangent.
+   *
+   *          - level: Niv fr samtliga tangenter, bit n = tangent n.
+   ********************************************************************************/
+   static bool ghosted(const uint16_t level)
+   {
+      for (uint8_t i = 0; i < ROWS - 1; ++i)
+      {
+         const uint8_t a = (level >> (i * COLUMNS)) & 0x0F;
+         if ((a & (a - 1)) == 0) continue;
+
+         for (uint8_t j = i + 1; j < ROWS; ++j)
+         {
+            const uint8_t shared = a & (level >> (j * COLUMNS));
+            if (shared & (shared - 1)) return true;
+         }
+      }
+      return false;
+   }
+
+   /********************************************************************************
+   * debounce: Avstudsar samtliga tangenter parallellt utifrn en fullstndig
+   *           avskning och lgger genererade flanker i hndelsekn.
+   *
+   *           changed = level ^ sample
+   *           count0  = ~(count0 & changed)
+   *           count1  = count0 ^ (count1 & changed)
+   *           toggle  = changed & count0 & count1
+   *
+   *           - sample: Avlst niv fr samtliga tangenter, bit n = tangent n.
+   ********************************************************************************/
+   void debounce(const uint16_t sample)
+   {
+      const uint16_t changed = this->level_ ^ sample;
+      this->count0_ = ~(this->count0_ & changed);
+      this->count1_ = this->count0_ ^ (this->count1_ & changed);
+
+      uint16_t toggle = changed & this->count0_ & this->count1_;
+      if (!toggle) return;
+
+      if (!this->diodes_)
+      {
+         this->ghosting_ = ghosted(this->level_ ^ toggle);
+         if (this->ghosting_) toggle &= this->level_;
+      }
+
+      this->level_ ^= toggle;
+
+      for (uint8_t key = 0; toggle; ++key, toggle >>= 1)
+      {
+         if (!(toggle & 0x01)) continue;
+         const event event = { key, static_cast<bool>((this->level_ >> key) & 0x01) };
+         if (!this->events_.push(event)) ++this->dropped_;
+      }
+      return;
+   }
+
+public:
+
+   /********************************************************************************
+   * keypad: Defaultkonstruktor, initierar tomt objekt.
+   ********************************************************************************/
+   keypad(void) { }
+
+   /********************************************************************************
+   * keypad: Initierar tangentbord med angivna rader och kolumner.
+   *
+   *         - rows   : Pin-nummer fr raderna, exempelvis { 4, 5, 6, 7 }.
+   *         - columns: Pin-nummer fr kolumnerna, exempelvis { A0, A1, A2, A3 }.
+   *         - keymap : Tecken fr respektive tangent (default = "123A456B789C*0#D").
+   *         - diodes : Indikerar dioder vid tangenterna, vilket stnger av
+   *                    detektering av spkning (default = inga dioder).
+   ********************************************************************************/
+   keypad(const uint8_t (&rows)[ROWS],
+          const uint8_t (&columns)[COLUMNS],
+          const char* keymap = "123A456B789C*0#D",
+          const bool diodes = false)
+   {
+      this->init(rows, columns, keymap, diodes);
+      return;
+   }
+
+   /********************************************************************************
+   * keypad: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   keypad(keypad&) = delete;
+
+   /********************************************************************************
+   * keypad: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   keypad& operator= (keypad&) = delete;
+
+   /********************************************************************************
+   * init: Initierar tangentbord med angivna rader och kolumner. Samtliga
+   *       tangenter utgr frn uppslppt lge och frsta raden vljs.
+   *
+   *       - rows   : Pin-nummer fr raderna, exempelvis { 4, 5, 6, 7 }.
+   *       - columns: Pin-nummer fr kolumnerna, exempelvis { A0, A1, A2, A3 }.
+   *       - keymap : Tecken fr respektive tangent (default = "123A456B789C*0#D").
+   *       - diodes : Indikerar dioder vid tangenterna, vilket stnger av
+   *                  detektering av spkning (default = inga dioder).
+   ********************************************************************************/
+   void init(const uint8_t (&rows)[ROWS],
+             const uint8_t (&columns)[COLUMNS],
+             const char* keymap = "123A456B789C*0#D",
+             const bool diodes = false)
+   {
+      critical_section lock;
+
+      for (uint8_t i = 0; i < ROWS; ++i)
+      {
+         init_line(this->rows_[i], rows[i], false);
+      }
+      for (uint8_t i = 0; i < COLUMNS; ++i)
+      {
+         init_line(this->columns_[i], columns[i], true);
+      }
+
+      this->keymap_ = keymap;
+      this->diodes_ = diodes;
+      this->ghosting_ = false;
+      this->row_ = 0;
+      this->frame_ = 0;
+      this->level_ = 0;
+      this->count0_ = 0xFFFF;
+      this->count1_ = 0xFFFF;
+      this->events_.clear();
+      *this->rows_[0].reg |= this->rows_[0].mask;
+      return;
+   }
+
+   /********************************************************************************
+   * scan: Lser kolumnerna fr vald rad, vljer nsta rad och avstudsar
+   *       samtliga tangenter nr hela tangentbordet har avskts. Anropas
+   *       periodiskt frn en timer eller task, frslagsvis var millisekund.
+   ********************************************************************************/
+   void scan(void)
+   {
+      uint8_t sample = 0;
+
+      for (uint8_t i = 0; i < COLUMNS; ++i)
+      {
+         if (!(*this->columns_[i].reg & this->columns_[i].mask)) sample |= (1 << i);
+      }
+
+      *this->rows_[this->row_].reg &= ~this->rows_[this->row_].mask;
+      this->frame_ |= static_cast<uint16_t>(sample) << (this->row_ * COLUMNS);
+
+      if (++this->row_ >= ROWS)
+      {
+         this->row_ = 0;
+         this->debounce(this->frame_);
+         this->frame_ = 0;
+      }
+
+      *this->rows_[this->row_].reg |= this->rows_[this->row_].mask;
+      return;
+   }
+
+   /********************************************************************************
+   * read: Lser nsta hndelse frn hndelsekn. Returnerar false om kn r tom.
+   *
+   *       - event: Referens till variabel dr hndelsen lagras.
+   ********************************************************************************/
+   bool read(event& event)
+   {
+      return this->events_.pop(event);
+   }
+
+   /********************************************************************************
+   * is_pressed: Indikerar ifall angiven tangent r nedtryckt efter avstudsning.
+   *
+   *             - key: Tangentens index, 0 - 15.
+   ********************************************************************************/
+   bool is_pressed(const uint8_t key) const
+   {
+      return this->state() & (1 << key);
+   }
+
+   /********************************************************************************
+   * state: Returnerar avstudsad niv fr samtliga tangenter, bit n = tangent n.
+   ********************************************************************************/
+   uint16_t state(void) const
+   {
+      critical_section lock;
+      return this->level_;
+   }
+
+   /********************************************************************************
+   * ghosting: Indikerar ifall spkning detekterades vid senaste flank, vilket
+   *           innebr att nya nedtryckningar hlls inne.
+   ********************************************************************************/
+   bool ghosting(void) const
+   {
+      return this->ghosting_;
+   }
+
+   /********************************************************************************
+   * dropped: Returnerar antalet hndelser som inte fick plats i kn.
+   ********************************************************************************/
+   uint16_t dropped(void) const
+   {
+      return this->dropped_.load();
+   }
+
+   /********************************************************************************
+   * to_char: Returnerar tecknet fr angiven tangent enligt lagrad teckentabell.
+   *
+   *          - key: Tangentens index, 0 - 15.
+   ********************************************************************************/
+   char to_char(const uint8_t key) const
+   {
+      return this->keymap_ && key < ROWS * COLUMNS ? this->keymap_[key] : '\0';
+   }
+};
+
+#endif /* KEYPAD_HPP_ */
@@ -0,0 +1,477 @@
+/********************************************************************************
+* lcd.hpp: Innehller en icke-blockerande drivrutin fr teckenbaserade
+*          LCD-displayer med styrkretsen HD44780 i 4-bitarslge via klassen
+*          lcd, exempelvis 16x2 eller 20x4.
+*
+*          HD44780 r lngsam: varje byte tar ca 40 us att exekvera och
+*          rensning av displayen ca 1.5 ms. I stllet fr att vnta p
+*          displayen skriver programmet till en skuggbuffert i RAM via set
+*          samt print, vilket endast tar ngra cykler per tecken. En kopia
+*          av displayens faktiska innehll hlls ocks i RAM. Vid varje
+*          anrop av tick skickas hgst en halvbyte (nibble) till displayen,
+*          dr endast tecken som skiljer sig mellan buffertarna skickas.
+*          Adressrknaren i displayen rknas upp automatiskt, s intilliggande
+*          ndrade tecken skickas utan ny positionering, medan en ny position
+*          kostar ett kommando (en byte). Att uppdatera ett vrde om fyra
+*          tecken kostar drmed fem byte p bussen i stllet fr 80 byte vid
+*          omritning av en hel 20x4-display. Kommandot fr rensning anvnds
+*          aldrig, eftersom clear endast fyller skuggbufferten med blanksteg.
+*
+*          tick anropas periodiskt frn en timer eller en task med minst
+*          50 us mellanrum, s att fregende byte hinner exekveras, exempelvis:
+*
+*          lcd<20, 4> display(rs_pin, en_pin, data_pins);
+*          scheduler::task lcd_task([]() { display.tick(); }, 1);
+*
+*          Med tick var 128:e us tar en omritning av hela 20x4-displayen
+*          ca 22 ms, med tick var millisekund ca 170 ms. Rader som inte har
+*          ndrats sedan de senast jmfrdes hoppas ver, s ett anrop utan
+*          ndringar tar endast ngra cykler.
+*
+*          Skrivning till skuggbufferten och tick ska ske frn samma kontext,
+*          eller med tick frn en avbrottsrutin. Initieringen blockerar i ca
+*          60 ms enligt databladets startsekvens och grs drfr vid uppstart.
+*          R/W ansluts till jord.
+********************************************************************************/
+#ifndef LCD_HPP_
+#define LCD_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "format.hpp"
+
+/********************************************************************************
+* lcd: Generisk klass fr teckenbaserade LCD-displayer med styrkretsen HD44780
+*      med C kolumner och R rader.
+********************************************************************************/
+template<uint8_t C = 16, uint8_t R = 2>
+class lcd
+{
+private:
+   static_assert(C >= 1 && R >= 1 && R <= 4 && C * R <= 80, "Invalid display size (HD44780 supports up to 80 characters)!");
+
+   static constexpr uint8_t SIZE = C * R;  /* Antalet tecken. */
+   static constexpr uint8_t NONE = 0xFF;   /* Indikerar att inget tecken har ndrats. */
+
+   /********************************************************************************
+   * command: Enumeration fr kommandon till HD44780.
+   ********************************************************************************/
+   enum command : uint8_t
+   {
+      clear_display = 0x01, /* Rensar displayen (ca 1.5 ms). */
+      entry_mode    = 0x06, /* Adressrknaren rknas upp efter varje tecken. */
+      display_on    = 0x0C, /* Display p, markr och blinkning av. */
+      function_set  = 0x20, /* 4-bitarslge, ettstll bit 3 fr tv rader. */
+      two_lines     = 0x08, /* Tv rader (fyra rader adresseras som tv). */
+      set_address   = 0x80  /* Stter adressrknaren till angiven DDRAM-adress. */
+   };
+
+   char shadow_[SIZE];                /* nskat innehll (skuggbuffert). */
+   char display_[SIZE];               /* Displayens faktiska innehll. */
+   volatile uint8_t* ports_[6] = {};  /* Dataregister fr RS, E samt D4 - D7. */
+   uint8_t masks_[6] = {};            /* Bitmaskar fr RS, E samt D4 - D7. */
+   volatile uint8_t dirty_ = 0;       /* Rader som kan innehlla ndringar (bit n = rad n). */
+   uint8_t scan_ = 0;                 /* Tecknet som jmfrelsen startar frn. */
+   uint8_t cursor_ = 0;               /* Adressrknarens vrde i displayen. */
+   uint8_t byte_ = 0;                 /* Byte som skickas. */
+   bool low_pending_ = false;         /* Indikerar att lgsta halvbyten terstr. */
+   uint16_t traffic_ = 0;             /* Antalet skickade byte sedan start. */
+
+   /********************************************************************************
+   * write_pin: Stter angiven pin (0 = RS, 1 = E, 2 - 5 = D4 - D7) till angiven
+   *            niv.
+   *
+   *            - index: Pinnens index.
+   *            - value: Pinnens nya niv.
+   ********************************************************************************/
+   void write_pin(const uint8_t index,
+                  const bool value)
+   {
+      if (value)
+      {
+         *this->ports_[index] |= this->masks_[index];
+      }
+      else
+      {
+         *this->ports_[index] &= ~this->masks_[index];
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * write_nibble: Lgger ut angiven halvbyte p D4 - D7 och pulsar E, vilket
+   *               klockar in halvbyten p fallande flank. E hlls hg i
+   *               minst 450 ns enligt databladet.
+   *
+   *               - nibble: Halvbyten som ska skickas (bit 0 - 3).
+   ********************************************************************************/
+   void write_nibble(const uint8_t nibble)
+   {
+      for (uint8_t i = 0; i < 4; ++i)
+      {
+         this->write_pin(2 + i, nibble & (1 << i));
+      }
+
+      this->write_pin(1, true);
+      _delay_us(1);
+      this->write_pin(1, false);
+      return;
+   }
+
+   /********************************************************************************
+   * write_blocking: Skickar en hel byte och vntar tills den har exekverats.
+   *                 Anvnds endast vid initiering.
+   *
+   *                 - value   : Byten som ska skickas.
+   *                 - data    : Indikerar data (RS hg) eller kommando (RS lg).
+   *                 - delay_us: Exekveringstid mtt i mikrosekunder.
+   ********************************************************************************/
+   void write_blocking(const uint8_t value,
+                       const bool data,
+                       const uint16_t delay_us = 50)
+   {
+      this->write_pin(0, data);
+      this->write_nibble(value >> 4);
+      this->write_nibble(value & 0x0F);
+      misc::delay_us(delay_us);
+      return;
+   }
+
+   /********************************************************************************
+   * address: Returnerar DDRAM-adressen fr angivet tecken. Rad 0 och 1 brjar
+   *          p adress 0x00 respektive 0x40, medan rad 2 och 3 r
+   *          fortsttningar p dessa.
+   *
+   *          - cell: Tecknets index i bufferten.
+   ********************************************************************************/
+   static uint8_t address(const uint8_t cell)
+   {
+      const uint8_t row = cell / C;
+      const uint8_t column = cell - row * C;
+      return (row & 0x01 ? 0x40 : 0x00) + (row >> 1) * C + column;
+   }
+
+   /********************************************************************************
+   * next_address: Returnerar adressrknarens vrde efter att ett tecken har
+   *               skrivits p angiven adress.
+   *
+   *               - address: Adressen dr tecknet skrevs.
+   ********************************************************************************/
+   static uint8_t next_address(const uint8_t address)
+   {
+      if (R == 1) return address >= 0x4F ? 0x00 : address + 1;
+      if (address == 0x27) return 0x40;
+      if (address >= 0x67) return 0x00;
+      return address + 1;
+   }
+
+   /********************************************************************************
+   * find_change: Returnerar index fr nsta tecken som skiljer sig mellan
+   *              skuggbufferten och displayen, med start frn senast
+   *              skrivna tecken s att intilliggande ndringar skickas i
+   *              fljd. Endast rader markerade som ndrade jmfrs, och en
+   *              rad avmarkeras nr den har jmfrts utan skillnader.
+   ********************************************************************************/
+   uint8_t find_change(void)
+   {
+      const uint8_t start_row = this->scan_ / C;
+      const uint8_t start_column = this->scan_ - start_row * C;
+
+      for (uint8_t n = 0; n <= R; ++n)
+      {
+         const uint8_t row = (start_row + n) % R;
+         const uint8_t mask = (1 << row);
+         if (!(this->dirty_ & mask)) continue;
+
+         const uint8_t first = n == 0 ? start_column : 0;
+         const uint8_t last = n == R ? start_column : C;
+         const uint8_t base = row * C;
+
+         for (uint8_t column = first; column < last; ++column)
+         {
+            if (this->shadow_[base + column] != this->display_[base + column]) return base + column;
+         }
+
+         if (n == 0 && start_column) continue;
+         this->dirty_ &= ~mask;
+      }
+      return NONE;
+   }
+
+public:
+
+   static constexpr uint8_t COLUMNS = C; /* Antalet kolumner. */
+   static constexpr uint8_t ROWS = R;    /* Antalet rader. */
+
+   /********************************************************************************
+   * lcd: Defaultkonstruktor, initierar tomt objekt.
+   ********************************************************************************/
+   lcd(void) { }
+
+   /********************************************************************************
+   * lcd: Initierar display med angivna pinnar.
+   *
+   *      - rs_pin   : Pin-nummer fr RS.
+   *      - en_pin   : Pin-nummer fr E.
+   *      - data_pins: Pekare till array med pin-nummer fr D4 - D7.
+   ********************************************************************************/
+   lcd(const uint8_t rs_pin,
+       const uint8_t en_pin,
+       const uint8_t* data_pins)
+   {
+      this->init(rs_pin, en_pin, data_pins);
+      return;
+   }
+
+   /********************************************************************************
+   * lcd: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   lcd(lcd&) = delete;
+
+   /********************************************************************************
+   * lcd: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   lcd& operator= (lcd&) = delete;
+
+   /********************************************************************************
+   * init: Initierar displayen i 4-bitarslge enligt databladets startsekvens,
+   *       vilket blockerar i ca 60 ms. Displayen rensas och bda buffertarna
+   *       fylls med blanksteg.
+   *
+   *       - rs_pin   : Pin-nummer fr RS.
+   *       - en_pin   : Pin-nummer fr E.
+   *       - data_pins: Pekare till array med pin-nummer fr D4 - D7.
+   ********************************************************************************/
+   void init(const uint8_t rs_pin,
+             const uint8_t en_pin,
+             const uint8_t* data_pins)
+   {
+      const uint8_t pins[6] = { rs_pin, en_pin, data_pins[0], data_pins[1], data_pins[2], data_pins[3] };
+
+      for (uint8_t i = 0; i < 6; ++i)
+      {
+         const auto pin = pins[i];
+
+         if (pin <= 7)
+         {
+            this->ports_[i] = &PORTD;
+            this->masks_[i] = (1 << pin);
+            DDRD |= this->masks_[i];
+         }
+         else if (pin <= 13)
+         {
+            this->ports_[i] = &PORTB;
+            this->masks_[i] = (1 << (pin - 8));
+            DDRB |= this->masks_[i];
+         }
+         else
+         {
+            this->ports_[i] = &PORTC;
+            this->masks_[i] = (1 << (pin - 14));
+            DDRC |= this->masks_[i];
+         }
+
+         this->write_pin(i, false);
+      }
+
+      misc::delay_ms(50);
+      this->write_nibble(0x03);
+      misc::delay_us(4500);
+      this->write_nibble(0x03);
+      misc::delay_us(150);
+      this->write_nibble(0x03);
+      misc::delay_us(150);
+      this->write_nibble(0x02);
+      misc::delay_us(150);
+
+      this->write_blocking(R > 1 ? function_set | two_lines : function_set, false);
+      this->write_blocking(display_on, false);
+      this->write_blocking(clear_display, false, 2000);
+      this->write_blocking(entry_mode, false);
+
+      for (uint8_t i = 0; i < SIZE; ++i)
+      {
+         this->shadow_[i] = ' ';
+         this->display_[i] = ' ';
+      }
+
+      this->dirty_ = 0;
+      this->scan_ = 0;
+      this->cursor_ = 0;
+      this->low_pending_ = false;
+      this->traffic_ = 0;
+      return;
+   }
+
+   /********************************************************************************
+   * tick: Skickar hgst en halvbyte till displayen. Om lgsta halvbyten av en
+   *       byte terstr skickas den. Annars sks nsta ndrade tecken, dr
+   *       ett positioneringskommando skickas om adressrknaren inte redan
+   *       pekar p tecknet, och drefter tecknet sjlvt. Anropas periodiskt
+   *       med minst 50 us mellanrum.
+   ********************************************************************************/
+   void tick(void)
+   {
+      if (this->low_pending_)
+      {
+         this->write_nibble(this->byte_ & 0x0F);
+         this->low_pending_ = false;
+         return;
+      }
+
+      if (!this->dirty_) return;
+      const uint8_t cell = this->find_change();
+      if (cell == NONE) return;
+
+      const uint8_t address = lcd::address(cell);
+
+      if (address != this->cursor_)
+      {
+         this->byte_ = set_address | address;
+         this->cursor_ = address;
+         this->write_pin(0, false);
+      }
+      else
+      {
+         this->byte_ = static_cast<uint8_t>(this->shadow_[cell]);
+         this->display_[cell] = this->shadow_[cell];
+         this->cursor_ = next_address(address);
+         this->scan_ = cell + 1 < SIZE ? cell + 1 : 0;
+         this->write_pin(0, true);
+      }
+
+      this->write_nibble(this->byte_ >> 4);
+      this->low_pending_ = true;
+      this->traffic_++;
+      return;
+   }
+
+   /********************************************************************************
+   * busy: Indikerar ifall ndringar terstr att skicka till displayen.
+   ********************************************************************************/
+   bool busy(void) const
+   {
+      return this->low_pending_ || this->dirty_;
+   }
+
+   /********************************************************************************
+   * traffic: Returnerar antalet byte (tecken samt kommandon) som har skickats
+   *          till displayen sedan initieringen.
+   ********************************************************************************/
+   uint16_t traffic(void) const
+   {
+      return this->traffic_;
+   }
+
+   /********************************************************************************
+   * set: Skriver angivet tecken till skuggbufferten p angiven position.
+   *
+   *      - row      : Radens index, 0 - R - 1.
+   *      - column   : Kolumnens index, 0 - C - 1.
+   *      - character: Tecknet som ska visas.
+   ********************************************************************************/
+   void set(const uint8_t row,
+            const uint8_t column,
+            const char character)
+   {
+      if (row >= R || column >= C) return;
+      this->shadow_[row * C + column] = character;
+      this->dirty_ |= (1 << row);
+      return;
+   }
+
+   /********************************************************************************
+   * get: Returnerar tecknet i skuggbufferten p angiven position.
+   *
+   *      - row   : Radens index, 0 - R - 1.
+   *      - column: Kolumnens index, 0 - C - 1.
+   ********************************************************************************/
+   char get(const uint8_t row,
+            const uint8_t column) const
+   {
+      if (row >= R || column >= C) return ' ';
+      return this->shadow_[row * C + column];
+   }
+
+   /********************************************************************************
+   * print: Skriver angiven text till skuggbufferten med start p angiven
+   *        position. Text som inte ryms p raden kortas av. Antalet skrivna
+   *        tecken returneras.
+   *
+   *        - row   : Radens index, 0 - R - 1.
+   *        - column: Kolumnens index, 0 - C - 1.
+   *        - s     : Pekare till texten.
+   ********************************************************************************/
+   uint8_t print(const uint8_t row,
+                 const uint8_t column,
+                 const char* s)
+   {
+      uint8_t count = 0;
+
+      for (auto i = s; *i && column + count < C; ++i, ++count)
+      {
+         this->set(row, column + count, *i);
+      }
+      return count;
+   }
+
+   /********************************************************************************
+   * print: Skriver angivet tal hgerjusterat i ett flt med angiven bredd,
+   *        dr talet tolkas som ett fixtal med angivet antal decimaler.
+   *        Tal som inte ryms i fltet visas som stjrnor.
+   *
+   *        - row     : Radens index, 0 - R - 1.
+   *        - column  : Kolumnens index fr fltets brjan.
+   *        - number  : Talet som ska visas.
+   *        - width   : Fltets bredd mtt i tecken.
+   *        - decimals: Antalet decimaler (default = 0).
+   ********************************************************************************/
+   void print(const uint8_t row,
+              const uint8_t column,
+              const int32_t number,
+              const uint8_t width,
+              const uint8_t decimals = 0)
+   {
+      char s[format::BUFFER_SIZE];
+      const auto length = format::to_string(number, decimals, s);
+
+      for (uint8_t i = 0; i < width; ++i)
+      {
+         char character = '*';
+         if (length <= width) character = i < width - length ? ' ' : s[i - (width - length)];
+         this->set(row, column + i, character);
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * fill_row: Fyller angiven rad med angivet tecken.
+   *
+   *           - row      : Radens index, 0 - R - 1.
+   *           - character: Tecknet som raden fylls med (default = blanksteg).
+   ********************************************************************************/
+   void fill_row(const uint8_t row,
+                 const char character = ' ')
+   {
+      for (uint8_t i = 0; i < C; ++i)
+      {
+         this->set(row, i, character);
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * clear: Fyller skuggbufferten med blanksteg. Endast tecken som inte redan
+   *        r blanka skickas drefter till displayen.
+   ********************************************************************************/
+   void clear(void)
+   {
+      for (uint8_t i = 0; i < R; ++i)
+      {
+         this->fill_row(i);
+      }
+      return;
+   }
+};
+
+#endif /* LCD_HPP_ */
\ No newline at end of file
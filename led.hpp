@@ -1,12 +1,22 @@
 /********************************************************************************
 * led.hpp: Innehller drivrutiner fr lysdioder och andra digitala utportar 
-*          via klassen led.
+*          via klassen led. Fr lysdioder vars pin r knd vid kompileringen
+*          finns ven klassen basic_led, som har samma grnssnitt men bygger
+*          p pin<N> i pin.hpp och drmed kompileras till enstaka
+*          sbi/cbi-instruktioner utan RAM-tgng fr registren.
+*
+*          En lysdiod kan ocks mappas mot en bit i ett register i RAM via
+*          init_register, exempelvis en utgng p en 74HC595-expander
+*          (expander.hpp). Efter varje ndring anropas d en lagrad rutin
+*          som fr ut registret till hrdvaran.
 ********************************************************************************/
 #ifndef LED_HPP_
 #define LED_HPP_
 
 /* Inkluderingsdirektiv: */
 #include "misc.hpp"
+#include "coroutine.hpp"
+#include "pin.hpp"
 
 /********************************************************************************
 * led: Klass innehllande drivrutiner fr lysdioder och andra digitala utportar.
@@ -18,6 +28,7 @@ private:
    volatile uint8_t* ddr_ = 0;    /* Pekare till datariktningsregister. */
    volatile uint8_t* output_ = 0; /* Pekare till dataregister (fr tndning/slckning). */
    volatile uint8_t* input_ = 0;  /* Pekare till pinregister (fr lsning av insignaler). */
+   void (*commit_)(void) = nullptr; /* Rutin som fr ut ett mappat register till hrdvaran. */
 
 public:
 
@@ -68,26 +79,49 @@ public:
       return this->pin_;
    }
 
+   /********************************************************************************
+   * port: Returnerar I/O-porten som lysdioden r ansluten till.
+   ********************************************************************************/
+   enum io_port port(void) const
+   {
+      if (this->output_ == &PORTB) return io_port::b;
+      if (this->output_ == &PORTC) return io_port::c;
+      if (this->output_ == &PORTD) return io_port::d;
+      return io_port::none;
+   }
+
    /********************************************************************************
    * enabled: Indikerar ifall lysdioden r tnd.
    ********************************************************************************/
    bool enabled(void) const
    {
+      if (!this->input_) return this->output_ && (*(this->output_) & (1 << this->pin_));
       return *(this->input_) & (1 << this->pin_);
    }
 
+   /********************************************************************************
+   * mapped: Indikerar ifall lysdioden r mappad mot ett register i RAM via
+   *         init_register i stllet fr en I/O-port.
+   ********************************************************************************/
+   bool mapped(void) const
+   {
+      return this->output_ && !this->input_;
+   }
+
    /********************************************************************************
    * clear: Nollstller lysdiod samt motsvarande pin.
    ********************************************************************************/
    void clear(void)
    {
-      *(this->ddr_) &= ~(1 << this->pin_);
-      *(this->output_) &= ~(1 << this->pin_);
+      if (this->ddr_) *(this->ddr_) &= ~(1 << this->pin_);
+      if (this->output_) *(this->output_) &= ~(1 << this->pin_);
+      if (this->commit_) this->commit_();
       
       this->pin_ = 0;
       this->ddr_ = 0;
       this->output_ = 0;
       this->input_ = 0;
+      this->commit_ = nullptr;
       return;
    }
 
@@ -129,12 +163,39 @@ public:
       return;
    }
 
+   /********************************************************************************
+   * init_register: Initierar lysdiod mappad mot angiven bit i ett register i
+   *                RAM, exempelvis en skuggbuffert fr en utgngsexpander.
+   *                Efter varje ndring anropas angiven rutin, som ansvarar fr
+   *                att fra ut registret till hrdvaran.
+   *
+   *                - reg      : Referens till registret.
+   *                - bit      : Lysdiodens bit i registret, 0 - 7.
+   *                - commit   : Rutin som anropas efter varje ndring
+   *                             (default = ingen).
+   *                - start_val: Lysdiodens startvrde (default = 0, dvs. slckt).
+   ********************************************************************************/
+   void init_register(volatile uint8_t& reg,
+                      const uint8_t bit,
+                      void (*commit)(void) = nullptr,
+                      const uint8_t start_val = 0)
+   {
+      this->pin_ = bit;
+      this->ddr_ = nullptr;
+      this->output_ = &reg;
+      this->input_ = nullptr;
+      this->commit_ = commit;
+      this->write(start_val);
+      return;
+   }
+
    /********************************************************************************
    * on: Tnder angiven lysdiod.
    ********************************************************************************/
    void on(void)
    {
       *(this->output_) |= (1 << this->pin_);
+      if (this->commit_) this->commit_();
       return;
    }
 
@@ -144,6 +205,25 @@ public:
    void off(void)
    {
       *(this->output_) &= ~(1 << this->pin_);
+      if (this->commit_) this->commit_();
+      return;
+   }
+
+   /********************************************************************************
+   * write: Tnder eller slcker angiven lysdiod.
+   *
+   *        - value: Lysdiodens nya vrde (true = tnd).
+   ********************************************************************************/
+   void write(const bool value)
+   {
+      if (value)
+      {
+         this->on();
+      }
+      else
+      {
+         this->off();
+      }
       return;
    }
 
@@ -154,7 +234,15 @@ public:
    ********************************************************************************/
    void toggle(void)
    {
-      *(this->input_) = (1 << this->pin_);
+      if (this->input_)
+      {
+         *(this->input_) = (1 << this->pin_);
+      }
+      else
+      {
+         *(this->output_) ^= (1 << this->pin_);
+         if (this->commit_) this->commit_();
+      }
       return;
    }
 
@@ -169,6 +257,165 @@ public:
       misc::delay_ms(blink_speed_ms);
       return;
    }
+
+   /********************************************************************************
+   * blink: Blinkar lysdiod en gng med angiven blinkhastighet utan att blockera
+   *        anroparen. Anropas kontinuerligt tills true returneras, vilket
+   *        indikerar att blinkningen r slutfrd.
+   *
+   *        - co            : Referens till korutinens tillstnd.
+   *        - blink_speed_ms: Blinkhastigheten mtt i millisekunder.
+   ********************************************************************************/
+   bool blink(coroutine& co,
+              const uint16_t blink_speed_ms)
+   {
+      CO_BEGIN(co);
+      this->toggle();
+      CO_AWAIT_MS(co, blink_speed_ms);
+      CO_END(co);
+   }
+};
+
+/********************************************************************************
+* basic_led: Generisk klass fr lysdioder vars pin bestms vid kompileringen
+*            via angiven pin-typ, exempelvis pin<8>, med samma grnssnitt som
+*            klassen led. Samtliga medlemmar r statiska och klassen saknar
+*            datamedlemmar, s varje anrop kompileras till samma instruktion
+*            som motsvarande anrop via pin<N>, exempelvis:
+*
+*            basic_led<pin<8>> red;
+*            red.on();
+*
+*            Klassen kan inte anvndas i led_vector, pwm eller expander, som
+*            krver pekare till objekt av klassen led.
+********************************************************************************/
+template<class Pin>
+class basic_led
+{
+public:
+
+   /********************************************************************************
+   * basic_led: Initierar ny lysdiod p angiven pin.
+   *
+   *            - start_val: Lysdiodens startvrde (default = 0, dvs. slckt).
+   ********************************************************************************/
+   basic_led(const uint8_t start_val = 0)
+   {
+      basic_led::init(start_val);
+      return;
+   }
+
+   /********************************************************************************
+   * pin: Returnerar lysdiodens pin-nummer p aktuell I/O-port.
+   ********************************************************************************/
+   static constexpr uint8_t pin(void)
+   {
+      return Pin::BIT;
+   }
+
+   /********************************************************************************
+   * port: Returnerar I/O-porten som lysdioden r ansluten till.
+   ********************************************************************************/
+   static constexpr enum io_port port(void)
+   {
+      return Pin::PORT;
+   }
+
+   /********************************************************************************
+   * enabled: Indikerar ifall lysdioden r tnd.
+   ********************************************************************************/
+   static inline bool enabled(void)
+   {
+      return Pin::read();
+   }
+
+   /********************************************************************************
+   * clear: Nollstller lysdiod samt motsvarande pin.
+   ********************************************************************************/
+   static inline void clear(void)
+   {
+      Pin::set_input(false);
+      return;
+   }
+
+   /********************************************************************************
+   * init: Initierar lysdioden som utport med angivet startvrde.
+   *
+   *       - start_val: Lysdiodens startvrde (default = 0, dvs. slckt).
+   ********************************************************************************/
+   static inline void init(const uint8_t start_val = 0)
+   {
+      Pin::write(start_val);
+      Pin::set_output();
+      return;
+   }
+
+   /********************************************************************************
+   * on: Tnder angiven lysdiod (sbi).
+   ********************************************************************************/
+   static inline void on(void)
+   {
+      Pin::set();
+      return;
+   }
+
+   /********************************************************************************
+   * off: Slcker angiven lysdiod (cbi).
+   ********************************************************************************/
+   static inline void off(void)
+   {
+      Pin::clear();
+      return;
+   }
+
+   /********************************************************************************
+   * write: Tnder eller slcker angiven lysdiod.
+   *
+   *        - value: Lysdiodens nya vrde (true = tnd).
+   ********************************************************************************/
+   static inline void write(const bool value)
+   {
+      Pin::write(value);
+      return;
+   }
+
+   /********************************************************************************
+   * toggle: Togglar utsignalen p angiven lysdiod via pinregistret.
+   ********************************************************************************/
+   static inline void toggle(void)
+   {
+      Pin::toggle();
+      return;
+   }
+
+   /********************************************************************************
+   * blink: Blinkar lysdiod en gng med angiven blinkhastighet.
+   *
+   *        - blink_speed_ms: Referens till blinkhastigheten mtt i millisekunder.
+   ********************************************************************************/
+   static void blink(const uint16_t& blink_speed_ms)
+   {
+      basic_led::toggle();
+      misc::delay_ms(blink_speed_ms);
+      return;
+   }
+
+   /********************************************************************************
+   * blink: Blinkar lysdiod en gng med angiven blinkhastighet utan att blockera
+   *        anroparen. Anropas kontinuerligt tills true returneras, vilket
+   *        indikerar att blinkningen r slutfrd.
+   *
+   *        - co            : Referens till korutinens tillstnd.
+   *        - blink_speed_ms: Blinkhastigheten mtt i millisekunder.
+   ********************************************************************************/
+   static bool blink(coroutine& co,
+                     const uint16_t blink_speed_ms)
+   {
+      CO_BEGIN(co);
+      basic_led::toggle();
+      CO_AWAIT_MS(co, blink_speed_ms);
+      CO_END(co);
+   }
 };
 
 #endif /* LED_HPP_ */
\ No newline at end of file
@@ -6,6 +6,26 @@
 *
 *                 Lysdioder kan lggas till dynamiskt eller genom att en pekare
 *                 till en statisk array innehllande lysdiodspekare passeras.
+*
+*                 Vid initiering samt nr lysdioder lggs till eller tas bort
+*                 berknas en bitmask per I/O-port fr samtliga lagrade
+*                 lysdioder. Drmed utfrs on, off, toggle samt write med hgst
+*                 en skrivning per I/O-port, oavsett antalet lysdioder, och
+*                 samtliga lysdioder p samma port ndras p samma klockflank
+*                 (utan glitchar). Samtliga operationer som ndrar vektorns
+*                 innehll (init, assign, push, emplace, insert, pop, erase,
+*                 resize samt clear) uppdaterar bitmaskerna. Endast om
+*                 pekarna skrivs direkt via data eller leds ska update_masks
+*                 anropas. Lysdioder som r
+*                 mappade mot ett register i RAM (exempelvis utgngar p en
+*                 74HC595-expander) saknar I/O-port och uppdateras drfr en
+*                 och en efter portarna.
+*
+*                 Lagringen av lysdiodspekarna vljs via mallparametern:
+*                 led_vector lagrar dem p heapen via vector, static_led_vector
+*                 lagrar hgst N pekare i objektet via static_vector utan
+*                 dynamisk minnesallokering, och led_span refererar till en
+*                 befintlig array via span (utan push och resize).
 ********************************************************************************/
 #ifndef LED_VECTOR_HPP_
 #define LED_VECTOR_HPP_
@@ -13,123 +33,329 @@
 /* Inkluderingsdirektiv: */
 #include "misc.hpp"
 #include "vector.hpp"
+#include "static_vector.hpp"
+#include "span.hpp"
 #include "led.hpp"
+#include "atomic.hpp"
 
 /********************************************************************************
-* led_vector: Dynamisk vektor fr lagring och styrning av led-objekt, vilket
-*             kan utgras av lysdioder eller andra digitala utportar. Klassen
-*             vector rvs fr implementering av vektor-operationer, ssom
-*             omallokering, push, pop samt frigrande av minne.
+* basic_led_vector: Vektor fr lagring och styrning av led-objekt, vilket kan
+*                   utgras av lysdioder eller andra digitala utportar.
+*                   Lagringsklassen S rvs fr implementering av vektor-
+*                   operationer, ssom push, pop samt frigrande av minne, och
+*                   utgrs av vector<led*>, static_vector<led*, N> eller
+*                   span<led*>.
 ********************************************************************************/
-class led_vector : public vector<led*>
+template<class S = vector<led*>>
+class basic_led_vector : public S
 {
+private:
+   uint8_t masks_[3] = { 0, 0, 0 }; /* Bitmask fr lagrade lysdioder p I/O-port B, C och D. */
+   bool mapped_ = false;            /* Indikerar lagrade lysdioder mappade mot register i RAM. */
+
+   /********************************************************************************
+   * apply: Stter lysdioderna p angiven I/O-port enligt angivet mnster med en
+   *        enda skrivning till dataregistret. Avbrott inaktiveras under
+   *        ls-modifiera-skriv, s att en avbrottsrutin som skriver till samma
+   *        port inte fr sin ndring verskriven.
+   *
+   *        - output : Referens till I/O-portens dataregister.
+   *        - mask   : Bitmask fr lagrade lysdioder p I/O-porten.
+   *        - pattern: Bitmask fr lysdioder som ska tndas (vriga slcks).
+   ********************************************************************************/
+   static inline void apply(volatile uint8_t& output,
+                            const uint8_t mask,
+                            const uint8_t pattern)
+   {
+      if (!mask) return;
+      critical_section lock;
+      output = (output & ~mask) | (pattern & mask);
+      return;
+   }
+
 public:
 
    /********************************************************************************
-   * led_vector: Defaultkonstruktor, initierar ny tom vektor.
+   * basic_led_vector: Defaultkonstruktor, initierar ny tom vektor.
    ********************************************************************************/
-   led_vector(void) { }
+   basic_led_vector(void) { }
 
     /********************************************************************************
-   * led_vector: Initierar ny vektor med angiven storlek.
+   * basic_led_vector: Initierar ny vektor med angiven storlek.
    *
-   *             - size: Vektorns storlek, dvs. antalet lysdioder den rymmer.
+   *                   - size: Vektorns storlek, dvs. antalet lysdioder den
+   *                           rymmer.
    ********************************************************************************/
-   led_vector(const size_t size)
+   basic_led_vector(const size_t size)
    {
       this->resize(size);
       return;
    }
 
    /********************************************************************************
-   * led_vector: Initierar vektor med en array innehllande pekare till angivet
-   *             antal lysdioder.
+   * basic_led_vector: Initierar vektor med en array innehllande pekare till
+   *                   angivet antal lysdioder.
    *      
-   *             - leds    : Pekare till array innehllande pekare till lysdioder.
-   *             - num_leds: Antalet refererade lysdioder i arrayen.
+   *                   - leds    : Pekare till array innehllande pekare till
+   *                               lysdioder.
+   *                   - num_leds: Antalet refererade lysdioder i arrayen.
    ********************************************************************************/
-   led_vector(led** leds, 
-              const size_t num_leds)
+   basic_led_vector(led** leds, 
+                    const size_t num_leds)
    {
       this->init(leds, num_leds);
       return;
    }
 
    /********************************************************************************
-   * ~led_vector: Destruktor, frigr allokerat minne innan vektorn gr ur scope.
-   ********************************************************************************/
-   ~led_vector(void) 
-   { 
-      this->clear(); 
-      return;
-   }
-
-   /********************************************************************************
-   * led_vector: Kopieringskonstruktor raderad.
+   * basic_led_vector: Kopieringskonstruktor raderad.
    ********************************************************************************/
-   led_vector(led_vector&) = delete;         
+   basic_led_vector(basic_led_vector&) = delete;         
 
    /********************************************************************************
-   * led_vector: Tilldelningsoperator raderad.
+   * basic_led_vector: Tilldelningsoperator raderad.
    ********************************************************************************/
-   led_vector& operator= (led_vector&) = delete;
+   basic_led_vector& operator= (basic_led_vector&) = delete;
 
    /********************************************************************************
    * leds: Returnerar en pekare till fltet innehllande lysdioderna. 
    ********************************************************************************/
    struct led** leds(void) const
    {
-      return this->data_;
+      return this->data();
    }
 
    /********************************************************************************
    * init: Initierar vektor med en array innehllande pekare till angivet antal
-   *       lysdioder.
+   *       lysdioder. vector och static_vector kopierar pekarna, medan span
+   *       refererar till arrayen utan kopiering. Ifall pekarna ryms
+   *       returneras 0, annars felkod 1, varvid vektorn lmnas tom.
    *      
    *       - leds    : Pekare till array innehllande pekare till lysdioder.
    *       - num_leds: Antalet refererade lysdioder i arrayen.
    ********************************************************************************/
-   void init(led** leds, 
-             const size_t num_leds)
+   int init(led** leds, 
+            const size_t num_leds)
+   {
+      return this->assign(leds, num_leds);
+   }
+
+   /********************************************************************************
+   * push: Lgger till en lysdiod lngst bak i vektorn och uppdaterar
+   *       bitmasken fr dess I/O-port. Ifall minnesallokeringen lyckas s
+   *       returneras 0, annars felkod 1.
+   *
+   *       - new_led: Pekare till lysdioden som ska lggas till.
+   ********************************************************************************/
+   int push(led* new_led)
+   {
+      if (S::push(new_led)) return 1;
+      this->update_masks();
+      return 0;
+   }
+
+   /********************************************************************************
+   * emplace: Lgger till en lysdiod lngst bak i vektorn och uppdaterar
+   *          bitmaskerna. Ifall det lyckas returneras 0, annars felkod 1.
+   *
+   *          - new_led: Pekare till lysdioden som ska lggas till.
+   ********************************************************************************/
+   int emplace(led* new_led)
+   {
+      return this->push(new_led);
+   }
+
+   /********************************************************************************
+   * insert: Lgger till en lysdiod p angivet index i vektorn och uppdaterar
+   *         bitmaskerna. Ifall det lyckas returneras 0, annars felkod 1.
+   *
+   *         - index  : Index fr den nya lysdioden, 0 - size.
+   *         - new_led: Pekare till lysdioden som ska lggas till.
+   ********************************************************************************/
+   int insert(const size_t index,
+              led* new_led)
+   {
+      if (S::insert(index, new_led)) return 1;
+      this->update_masks();
+      return 0;
+   }
+
+   /********************************************************************************
+   * assign: Erstter vektorns innehll med angivet antal lysdiodspekare och
+   *         uppdaterar bitmaskerna. Ifall det lyckas returneras 0, annars
+   *         felkod 1.
+   *
+   *         - leds    : Pekare till array innehllande pekare till lysdioder.
+   *         - num_leds: Antalet refererade lysdioder i arrayen.
+   ********************************************************************************/
+   int assign(led** leds,
+              const size_t num_leds)
+   {
+      const auto result = S::assign(leds, num_leds);
+      this->update_masks();
+      return result;
+   }
+
+   /********************************************************************************
+   * pop: Tar bort den sista lysdioden i vektorn och uppdaterar bitmaskerna.
+   ********************************************************************************/
+   void pop(void)
    {
-      this->data_ = leds;
-      this->size_ = num_leds;
+      S::pop();
+      this->update_masks();
       return;
    }
 
    /********************************************************************************
-   * on: Tnder samtliga lysdioder lagrade i angiven vektor.
+   * erase: Tar bort lysdioden p angivet index i vektorn och uppdaterar
+   *        bitmaskerna. Ifall indexet r giltigt returneras 0, annars
+   *        felkod 1.
+   *
+   *        - index: Index fr lysdioden som ska tas bort.
    ********************************************************************************/
-   void on(void)
+   int erase(const size_t index)
+   {
+      if (S::erase(index)) return 1;
+      this->update_masks();
+      return 0;
+   }
+
+   /********************************************************************************
+   * resize: ndrar vektorns storlek, dr samtliga pekare stts till angivet
+   *         startvrde, och uppdaterar bitmaskerna. Ifall det lyckas
+   *         returneras 0, annars felkod 1.
+   *
+   *         - new_size : Vektorns nya storlek (antalet lysdioder).
+   *         - start_val: Startvrde fr pekarna (default = nullptr).
+   ********************************************************************************/
+   int resize(const size_t new_size,
+              led* const& start_val = nullptr)
+   {
+      const auto result = S::resize(new_size, start_val);
+      this->update_masks();
+      return result;
+   }
+
+   /********************************************************************************
+   * clear: Tmmer vektorn och nollstller bitmaskerna.
+   ********************************************************************************/
+   void clear(void)
+   {
+      S::clear();
+      this->update_masks();
+      return;
+   }
+
+   /********************************************************************************
+   * update_masks: Berknar bitmasken per I/O-port fr samtliga lagrade
+   *               lysdioder. Anropas automatiskt av samtliga operationer som
+   *               ndrar vektorns innehll.
+   ********************************************************************************/
+   void update_masks(void)
    {
+      this->masks_[0] = this->masks_[1] = this->masks_[2] = 0;
+      this->mapped_ = false;
+
       for (auto& i : *this)
       {
-         i->on();
+         if (!i) continue;
+         if (i->mapped()) this->mapped_ = true;
+         if (i->port() == io_port::none) continue;
+         this->masks_[static_cast<uint8_t>(i->port())] |= (1 << i->pin());
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * on: Tnder samtliga lysdioder lagrade i angiven vektor, med en skrivning
+   *     per I/O-port.
+   ********************************************************************************/
+   void on(void)
+   {
+      apply(PORTB, this->masks_[0], 0xFF);
+      apply(PORTC, this->masks_[1], 0xFF);
+      apply(PORTD, this->masks_[2], 0xFF);
+
+      if (this->mapped_)
+      {
+         for (auto& i : *this)
+         {
+            if (i && i->mapped()) i->on();
+         }
       }
       return;
    }
 
    /********************************************************************************
-   * off: Slcker samtliga lysdioder lagrade i angiven vektor.
+   * off: Slcker samtliga lysdioder lagrade i angiven vektor, med en
+   *      skrivning per I/O-port.
    ********************************************************************************/
    void off(void)
    {
-      for (auto& i : *this)
+      apply(PORTB, this->masks_[0], 0x00);
+      apply(PORTC, this->masks_[1], 0x00);
+      apply(PORTD, this->masks_[2], 0x00);
+
+      if (this->mapped_)
       {
-         i->off();
+         for (auto& i : *this)
+         {
+            if (i && i->mapped()) i->off();
+         }
       }
       return;
    }
 
    /********************************************************************************
-   * toggle: Togglar samtliga lysdioder lagrade i angiven vektor.
+   * toggle: Togglar samtliga lysdioder lagrade i angiven vektor genom att
+   *         bitmasken skrivs till respektive pinregister, vilket varken
+   *         krver lsning av porten eller inaktiverade avbrott.
    ********************************************************************************/
    void toggle(void)
    {
+      if (this->masks_[0]) PINB = this->masks_[0];
+      if (this->masks_[1]) PINC = this->masks_[1];
+      if (this->masks_[2]) PIND = this->masks_[2];
+
+      if (this->mapped_)
+      {
+         for (auto& i : *this)
+         {
+            if (i && i->mapped()) i->toggle();
+         }
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * write: Stter samtliga lysdioder enligt angivet mnster, dr bit n tnder
+   *        (1) eller slcker (0) lysdiod n i vektorn. Mnstret verstts till
+   *        en bitmask per I/O-port, som sedan skrivs med en skrivning per
+   *        port, s att lysdioderna p samma port ndras samtidigt.
+   *
+   *        - pattern: Mnster fr lysdioderna, bit n = lysdiod n.
+   ********************************************************************************/
+   void write(const uint32_t pattern)
+   {
+      uint8_t values[3] = { 0, 0, 0 };
+      uint32_t bit = 1;
+
       for (auto& i : *this)
       {
-         i->toggle();
+         if (i && i->mapped())
+         {
+            i->write(pattern & bit);
+         }
+         else if ((pattern & bit) && i && i->port() != io_port::none)
+         {
+            values[static_cast<uint8_t>(i->port())] |= (1 << i->pin());
+         }
+         bit <<= 1;
       }
+
+      apply(PORTB, this->masks_[0], values[0]);
+      apply(PORTC, this->masks_[1], values[1]);
+      apply(PORTD, this->masks_[2], values[2]);
       return;
    }
 
@@ -149,6 +375,27 @@ public:
       return;
    }
 
+   /********************************************************************************
+   * blink_collectively: Genomfr kollektiv (synkroniserad) blinkning av samtliga
+   *                     lysdioder utan att blockera anroparen. Anropas
+   *                     kontinuerligt tills true returneras, vilket indikerar
+   *                     att blinkningen r slutfrd.
+   *
+   *                     - co            : Referens till korutinens tillstnd.
+   *                     - blink_speed_ms: Lysdiodernas blinkhastighet mtt i
+   *                                       millisekunder.
+   ********************************************************************************/
+   bool blink_collectively(coroutine& co,
+                           const uint16_t blink_speed_ms)
+   {
+      CO_BEGIN(co);
+      this->on();
+      CO_AWAIT_MS(co, blink_speed_ms);
+      this->off();
+      CO_AWAIT_MS(co, blink_speed_ms);
+      CO_END(co);
+   }
+
    /********************************************************************************
    * blink_sequentially: Genomfr sekventiell blinkning av samtliga lysdioder 
    *                     lagrade i angiven vektor. Drmed blinkar lysdioderna 
@@ -170,6 +417,52 @@ public:
 
       return;
    }
+
+   /********************************************************************************
+   * blink_sequentially: Genomfr sekventiell blinkning av samtliga lysdioder
+   *                     utan att blockera anroparen. Index fr aktuell lysdiod
+   *                     lagras i korutinens rknare, eftersom lokala variabler
+   *                     inte behller sina vrden under vntan. Anropas
+   *                     kontinuerligt tills true returneras, vilket indikerar
+   *                     att sekvensen r slutfrd.
+   *
+   *                     - co            : Referens till korutinens tillstnd.
+   *                     - blink_speed_ms: Lysdiodernas blinkhastighet mtt i
+   *                                       millisekunder.
+   ********************************************************************************/
+   bool blink_sequentially(coroutine& co,
+                           const uint16_t blink_speed_ms)
+   {
+      CO_BEGIN(co);
+      this->off();
+
+      for (co.counter() = 0; co.counter() < this->size(); co.counter()++)
+      {
+         this->data()[co.counter()]->on();
+         CO_AWAIT_MS(co, blink_speed_ms);
+         this->data()[co.counter()]->off();
+      }
+
+      CO_END(co);
+   }
 };
 
+/********************************************************************************
+* led_vector: Vektor fr lysdioder lagrad p heapen via vector.
+********************************************************************************/
+using led_vector = basic_led_vector<vector<led*>>;
+
+/********************************************************************************
+* static_led_vector: Vektor fr hgst N lysdioder lagrad i objektet via
+*                    static_vector, utan dynamisk minnesallokering.
+********************************************************************************/
+template<size_t N>
+using static_led_vector = basic_led_vector<static_vector<led*, N>>;
+
+/********************************************************************************
+* led_span: Vektor fr lysdioder som refererar till en befintlig array via
+*           span, utan kopiering eller allokering.
+********************************************************************************/
+using led_span = basic_led_vector<span<led*>>;
+
 #endif /* LED_VECTOR_HPP_ */
\ No newline at end of file
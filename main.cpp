@@ -11,10 +11,9 @@
 *           pin 8 (PORTB0) blinkar var 50:e millisekund via Timer 1.
 *
 *           Utskrift sker via seriell verfring efter varje Watchdog timeout,
-*           vid Watchdog reset samt vid lsning av systemet. Fr att undvika
-*           multipla avbrott orsakat av kontaktstudsar inaktiveras PCI-avbrott
-*           p I/O-port B i 300 millisekunder efter nedtryckning, implementerat
-*           via Timer 0.
+*           vid Watchdog reset samt vid lsning av systemet. Tryckknappen
+*           avstudsas av en task som lser av I/O-porten var 5:e millisekund,
+*           vilket varken krver PCI-avbrott eller ngon hrdvarutimer.
 ********************************************************************************/
 #include "header.hpp"
 
@@ -27,7 +26,10 @@
 *       var 50:e millisekund tills en total systemterstllning genomfrs.
 *       vrig tid sker PWM-styrning av lysdioder l1 - l3 anslutna till pin
 *       8 - 10 (PORTB0 - PORTB2) via en potentiometer ansluten till analog
-*       pin A0 (PORTC0).
+*       pin A0 (PORTC0) via en task i schemalggaren, som utfr ett steg av
+*       PWM-styrningen varje millisekund utan att blockera (periodtid 10 ms).
+*       Nr ingen task r redo, exempelvis efter lsning d
+*       PWM-tasken r inaktiverad, frstts processorn i vila.
 ********************************************************************************/
 int main(void)
 {
@@ -35,7 +37,7 @@ int main(void)
    
    while (1)
    {
-      pwm1.run();
+      scheduler::run();
    }
 
    return 0;
@@ -0,0 +1,505 @@
+/********************************************************************************
+* matrix.cpp: Innehller drivrutiner fr multiplexade LED-matriser samt
+*             charlieplexade lysdiodsgrupper via Timer 0.
+********************************************************************************/
+#include "matrix.hpp"
+#include "atomic.hpp"
+
+/********************************************************************************
+* image: Strukt fr lagring av en portbild, allts vrdena fr DDRx och PORTx
+*        fr ytornas pinnar p I/O-portar B, C och D (index enligt io_port).
+********************************************************************************/
+struct image
+{
+   uint8_t ddr[3] = {};  /* Datariktning fr ytornas pinnar. */
+   uint8_t port[3] = {}; /* Utsignal (eller pullup) fr ytornas pinnar. */
+};
+
+/********************************************************************************
+* surface: Strukt fr lagring av en yta. Pinnarna lagras kodade som
+*          (port << 3) | bit, dr raderna lagras frst fljt av kolumnerna.
+*          Fr charlieplexade grupper utgr samma pinnar bde rader och
+*          kolumner.
+********************************************************************************/
+struct surface
+{
+   uint8_t lines[matrix::ROWS + matrix::COLUMNS] = {};         /* Kodade pinnar. */
+   uint8_t rows = 0;                                           /* Antalet rader. */
+   uint8_t columns = 0;                                        /* Antalet kolumner. */
+   bool charlieplex = false;                                   /* Indikerar charlieplexad grupp. */
+   bool rows_active_high = true;                               /* Indikerar ifall aktiv rad drivs hg. */
+   bool columns_active_high = false;                           /* Indikerar ifall tnd kolumn drivs hg. */
+   uint8_t pixels[matrix::ROWS * matrix::COLUMNS / 2] = {};    /* Ljusstyrka, tv pixlar per byte. */
+};
+
+static_assert(matrix::BITS <= 4, "Pixel buffer stores at most four bits per pixel!");
+
+/* Statiska variabler: */
+static surface surfaces[matrix::SURFACES];                     /* Tillagda ytor. */
+static uint8_t num_surfaces = 0;                               /* Antalet tillagda ytor. */
+static uint8_t num_rows = 0;                                   /* Antalet rader som skannas. */
+static image idle;                                             /* Portbild med samtliga pixlar slckta. */
+static uint8_t masks[3] = {};                                  /* Ytornas pinnar per I/O-port. */
+static image buffers[2][matrix::ROWS * matrix::BITS];          /* Frmre och bakre buffert med portbilder. */
+static volatile uint8_t front = 0;                             /* Index fr bufferten som visas. */
+static volatile bool swap_pending = false;                     /* Indikerar begrt byte av buffert. */
+static volatile uint16_t frame_count = 0;                      /* Antalet visade bilder. */
+static const image* scan = buffers[0];                         /* Nsta portbild (anvnds endast av avbrottsrutinen). */
+static const image* scan_end = buffers[0];                     /* Slutet av aktuell bild (anvnds endast av avbrottsrutinen). */
+static uint8_t plane = 0;                                      /* Aktuellt bitplan (anvnds endast av avbrottsrutinen). */
+
+/********************************************************************************
+* encode: Returnerar angiven pin kodad som (port << 3) | bit, dr port utgr
+*         index enligt io_port.
+*
+*         - pin: Pin-nummer p Arduino Uno, exempelvis 8 eller A0.
+********************************************************************************/
+static uint8_t encode(const uint8_t pin)
+{
+   if (pin <= 7) return (static_cast<uint8_t>(io_port::d) << 3) | pin;
+   if (pin <= 13) return (static_cast<uint8_t>(io_port::b) << 3) | (pin - 8);
+   return (static_cast<uint8_t>(io_port::c) << 3) | (pin - 14);
+}
+
+/********************************************************************************
+* drive: Stter angiven kodad pin till utport med angiven niv i portbilden.
+*
+*        - img  : Referens till portbilden.
+*        - line : Kodad pin.
+*        - value: Pinnens niv.
+********************************************************************************/
+static inline void drive(image& img,
+                         const uint8_t line,
+                         const bool value)
+{
+   const uint8_t mask = (1 << (line & 0x07));
+   img.ddr[line >> 3] |= mask;
+
+   if (value)
+   {
+      img.port[line >> 3] |= mask;
+   }
+   else
+   {
+      img.port[line >> 3] &= ~mask;
+   }
+   return;
+}
+
+/********************************************************************************
+* release: Stter angiven kodad pin till inport utan pullup i portbilden
+*          (hgimpediv).
+*
+*          - img : Referens till portbilden.
+*          - line: Kodad pin.
+********************************************************************************/
+static inline void release(image& img,
+                           const uint8_t line)
+{
+   const uint8_t mask = (1 << (line & 0x07));
+   img.ddr[line >> 3] &= ~mask;
+   img.port[line >> 3] &= ~mask;
+   return;
+}
+
+/********************************************************************************
+* level: Returnerar ljusstyrkan fr angiven pixel p angiven yta.
+*
+*        - s: Referens till ytan.
+*        - x: Pixelns kolumn.
+*        - y: Pixelns rad.
+********************************************************************************/
+static inline uint8_t level(const surface& s,
+                            const uint8_t x,
+                            const uint8_t y)
+{
+   const uint8_t index = y * matrix::COLUMNS + x;
+   const uint8_t value = s.pixels[index >> 1];
+   return index & 0x01 ? value >> 4 : value & 0x0F;
+}
+
+/********************************************************************************
+* apply: Skriver angiven portbild till I/O-portarna. Ytornas pinnar stts
+*        frst till inportar, s att inga felaktiga lysdioder tnds under
+*        vergngen, varefter utsignal och datariktning skrivs. vriga
+*        pinnar pverkas inte.
+*
+*        - img: Referens till portbilden.
+********************************************************************************/
+static inline void apply(const image& img)
+{
+   DDRB &= ~masks[0];
+   DDRC &= ~masks[1];
+   DDRD &= ~masks[2];
+   PORTB = (PORTB & ~masks[0]) | img.port[0];
+   PORTC = (PORTC & ~masks[1]) | img.port[1];
+   PORTD = (PORTD & ~masks[2]) | img.port[2];
+   DDRB |= img.ddr[0];
+   DDRC |= img.ddr[1];
+   DDRD |= img.ddr[2];
+   return;
+}
+
+/********************************************************************************
+* compile: Berknar portbilder fr samtliga rader och bitplan i angiven
+*          buffert utifrn pixelbufferten. Varje portbild utgr frn
+*          vilolget, varefter aktuell rad aktiveras p samtliga ytor och de
+*          kolumner vars pixel har aktuell bit ettstlld tnds.
+*
+*          - buffer: Pekare till bufferten.
+********************************************************************************/
+static void compile(image* buffer)
+{
+   for (uint8_t y = 0; y < num_rows; ++y)
+   {
+      for (uint8_t b = 0; b < matrix::BITS; ++b)
+      {
+         auto& img = buffer[y * matrix::BITS + b];
+         img = idle;
+
+         for (uint8_t i = 0; i < num_surfaces; ++i)
+         {
+            const auto& s = surfaces[i];
+            if (y >= s.rows) continue;
+
+            if (s.charlieplex)
+            {
+               drive(img, s.lines[y], true);
+
+               for (uint8_t x = 0; x < s.columns; ++x)
+               {
+                  if (x != y && (level(s, x, y) & (1 << b))) drive(img, s.lines[x], false);
+               }
+            }
+            else
+            {
+               drive(img, s.lines[y], s.rows_active_high);
+
+               for (uint8_t x = 0; x < s.columns; ++x)
+               {
+                  if (level(s, x, y) & (1 << b)) drive(img, s.lines[s.rows + x], s.columns_active_high);
+               }
+            }
+         }
+      }
+   }
+   return;
+}
+
+/********************************************************************************
+* add_surface: Reserverar nsta lediga yta och returnerar en pekare till
+*              denna, eller nullptr om maximalt antal ytor redan har lagts
+*              till. Skanningen stoppas, eftersom portbilderna mste berknas
+*              om.
+********************************************************************************/
+static surface* add_surface(void)
+{
+   if (num_surfaces >= matrix::SURFACES) return nullptr;
+   matrix::stop();
+   auto& s = surfaces[num_surfaces++];
+   s = surface();
+   return &s;
+}
+
+/********************************************************************************
+* add_matrix: Lgger till en multiplexad LED-matris med angivna rad- samt
+*             kolumnpinnar, vilka stts till utportar i vilolge.
+*
+*             - row_pins           : Pekare till array med radernas pinnar.
+*             - rows               : Antalet rader, 1 - 8.
+*             - column_pins        : Pekare till array med kolumnernas pinnar.
+*             - columns            : Antalet kolumner, 1 - 8.
+*             - rows_active_high   : Indikerar ifall aktiv rad drivs hg.
+*             - columns_active_high: Indikerar ifall tnd kolumn drivs hg.
+********************************************************************************/
+bool matrix::add_matrix(const uint8_t* row_pins,
+                        const uint8_t rows,
+                        const uint8_t* column_pins,
+                        const uint8_t columns,
+                        const bool rows_active_high,
+                        const bool columns_active_high)
+{
+   if (!rows || rows > ROWS || !columns || columns > COLUMNS) return false;
+   auto s = add_surface();
+   if (!s) return false;
+
+   s->rows = rows;
+   s->columns = columns;
+   s->rows_active_high = rows_active_high;
+   s->columns_active_high = columns_active_high;
+
+   for (uint8_t i = 0; i < rows; ++i)
+   {
+      s->lines[i] = encode(row_pins[i]);
+      drive(idle, s->lines[i], !rows_active_high);
+   }
+
+   for (uint8_t i = 0; i < columns; ++i)
+   {
+      s->lines[rows + i] = encode(column_pins[i]);
+      drive(idle, s->lines[rows + i], !columns_active_high);
+   }
+
+   for (uint8_t i = 0; i < rows + columns; ++i)
+   {
+      masks[s->lines[i] >> 3] |= (1 << (s->lines[i] & 0x07));
+   }
+
+   if (rows > num_rows) num_rows = rows;
+   apply(idle);
+   return true;
+}
+
+/********************************************************************************
+* add_charlieplex: Lgger till en charlieplexad lysdiodsgrupp med angivna
+*                  pinnar, vilka stts till inportar utan pullup i vilolge.
+*
+*                  - pins : Pekare till array med gruppens pinnar.
+*                  - count: Antalet pinnar, 2 - 8.
+********************************************************************************/
+bool matrix::add_charlieplex(const uint8_t* pins,
+                             const uint8_t count)
+{
+   if (count < 2 || count > ROWS || count > COLUMNS) return false;
+   auto s = add_surface();
+   if (!s) return false;
+
+   s->rows = count;
+   s->columns = count;
+   s->charlieplex = true;
+
+   for (uint8_t i = 0; i < count; ++i)
+   {
+      s->lines[i] = encode(pins[i]);
+      release(idle, s->lines[i]);
+      masks[s->lines[i] >> 3] |= (1 << (s->lines[i] & 0x07));
+   }
+
+   if (count > num_rows) num_rows = count;
+   apply(idle);
+   return true;
+}
+
+/********************************************************************************
+* start: Berknar portbilder fr aktuellt innehll och startar skanningen.
+*        Timer 0 stts i CTC Mode med prescaler 64 (4 us per tick), dr
+*        frsta intervallet r en tidsenhet.
+********************************************************************************/
+void matrix::start(void)
+{
+   matrix::stop();
+   if (!num_rows) return;
+
+   compile(buffers[front]);
+   swap_pending = false;
+   scan = buffers[front];
+   scan_end = scan + num_rows * BITS;
+   plane = 0;
+   frame_count = 0;
+
+   TCCR0A = (1 << WGM01);
+   TCNT0 = 0;
+   OCR0A = UNIT_TICKS - 1;
+   TIFR0 = (1 << OCF0A);
+   TIMSK0 = (1 << OCIE0A);
+   TCCR0B = (1 << CS01) | (1 << CS00);
+   asm("SEI");
+   return;
+}
+
+/********************************************************************************
+* stop: Stoppar Timer 0 och skriver vilolget till I/O-portarna.
+********************************************************************************/
+void matrix::stop(void)
+{
+   TIMSK0 &= ~(1 << OCIE0A);
+   TCCR0B = 0x00;
+   TCCR0A = 0x00;
+   apply(idle);
+   return;
+}
+
+/********************************************************************************
+* clear: Stoppar skanningen, stter ytornas pinnar till inportar utan pullup
+*        samt tar bort samtliga ytor.
+********************************************************************************/
+void matrix::clear(void)
+{
+   matrix::stop();
+   idle = image();
+   apply(idle);
+
+   masks[0] = masks[1] = masks[2] = 0;
+   num_surfaces = 0;
+   num_rows = 0;
+   swap_pending = false;
+   return;
+}
+
+/********************************************************************************
+* set: Stter ljusstyrkan fr angiven pixel i pixelbufferten.
+*
+*      - surface: Ytans index.
+*      - x      : Pixelns kolumn.
+*      - y      : Pixelns rad.
+*      - level  : Ljusstyrka, 0 - 15 (0 = slckt).
+********************************************************************************/
+void matrix::set(const uint8_t surface,
+                 const uint8_t x,
+                 const uint8_t y,
+                 const uint8_t level)
+{
+   if (surface >= num_surfaces || x >= COLUMNS || y >= ROWS) return;
+   const uint8_t index = y * COLUMNS + x;
+   const uint8_t value = level < LEVELS ? level : LEVELS - 1;
+   auto& pixel = surfaces[surface].pixels[index >> 1];
+
+   if (index & 0x01)
+   {
+      pixel = (pixel & 0x0F) | (value << 4);
+   }
+   else
+   {
+      pixel = (pixel & 0xF0) | value;
+   }
+   return;
+}
+
+/********************************************************************************
+* get: Returnerar ljusstyrkan fr angiven pixel i pixelbufferten.
+*
+*      - surface: Ytans index.
+*      - x      : Pixelns kolumn.
+*      - y      : Pixelns rad.
+********************************************************************************/
+uint8_t matrix::get(const uint8_t surface,
+                    const uint8_t x,
+                    const uint8_t y)
+{
+   if (surface >= num_surfaces || x >= COLUMNS || y >= ROWS) return 0;
+   return level(surfaces[surface], x, y);
+}
+
+/********************************************************************************
+* fill: Stter samtliga pixlar p angiven yta till angiven ljusstyrka.
+*
+*       - surface: Ytans index.
+*       - level  : Ljusstyrka, 0 - 15.
+********************************************************************************/
+void matrix::fill(const uint8_t surface,
+                  const uint8_t level)
+{
+   if (surface >= num_surfaces) return;
+   const uint8_t value = level < LEVELS ? level : LEVELS - 1;
+
+   for (auto& i : surfaces[surface].pixels)
+   {
+      i = (value << 4) | value;
+   }
+   return;
+}
+
+/********************************************************************************
+* draw_row: Stter angiven rad frn en bitmask, dr bit x motsvarar kolumn x.
+*
+*           - surface: Ytans index.
+*           - y      : Radens index.
+*           - bits   : Bitmask fr radens pixlar.
+*           - level  : Ljusstyrka fr tnda pixlar.
+********************************************************************************/
+void matrix::draw_row(const uint8_t surface,
+                      const uint8_t y,
+                      const uint8_t bits,
+                      const uint8_t level)
+{
+   for (uint8_t x = 0; x < COLUMNS; ++x)
+   {
+      matrix::set(surface, x, y, bits & (1 << x) ? level : 0);
+   }
+   return;
+}
+
+/********************************************************************************
+* show: Berknar portbilder fr pixelbufferten i den bakre bufferten och
+*       begr byte till denna i brjan av nsta bild. Om fregende byte
+*       nnu inte har genomfrts returneras false. Om skanningen inte r
+*       startad byts bufferten direkt.
+********************************************************************************/
+bool matrix::show(void)
+{
+   if (swap_pending) return false;
+   compile(buffers[front ^ 0x01]);
+
+   if (TIMSK0 & (1 << OCIE0A))
+   {
+      swap_pending = true;
+   }
+   else
+   {
+      front ^= 0x01;
+   }
+   return true;
+}
+
+/********************************************************************************
+* pending: Indikerar ifall en begrd byte av buffert nnu inte har genomfrts.
+********************************************************************************/
+bool matrix::pending(void)
+{
+   return swap_pending;
+}
+
+/********************************************************************************
+* refresh_rate: Returnerar berknad uppdateringsfrekvens mtt i Hz, allts
+*               1 / (rader * 15 tidsenheter).
+********************************************************************************/
+uint16_t matrix::refresh_rate(void)
+{
+   if (!num_rows) return 0;
+   return static_cast<uint16_t>(1000000UL / (static_cast<uint32_t>(num_rows) * (LEVELS - 1) * UNIT_US));
+}
+
+/********************************************************************************
+* frames: Returnerar antalet visade bilder sedan start.
+********************************************************************************/
+uint16_t matrix::frames(void)
+{
+   critical_section lock;
+   return frame_count;
+}
+
+/********************************************************************************
+* ISR (TIMER0_COMPA_vect): Avbrottsrutin som ger rum nr aktuellt bitplan
+*                          har visats frdigt. Nsta portbild skrivs till
+*                          I/O-portarna och dess lngd (1, 2, 4 eller 8
+*                          tidsenheter) programmeras in i OCR0A. Eftersom
+*                          rknaren precis har nollstllts hinner skrivningen
+*                          normalt ske innan rknaren nr det nya vrdet. Om
+*                          avbrottet har frdrjts s att rknaren redan har
+*                          passerat vrdet frkortas intervallet i stllet fr
+*                          att rknaren slr runt (ca 1 ms). Efter sista
+*                          portbilden i bilden byts buffert om s har begrts.
+*                          Rutinen har samma lngd fr samtliga rader.
+********************************************************************************/
+ISR (TIMER0_COMPA_vect)
+{
+   apply(*scan);
+   const uint8_t compare = (matrix::UNIT_TICKS << plane) - 1;
+   OCR0A = compare;
+   if (TCNT0 >= compare) TCNT0 = compare - 1;
+   if (++plane == matrix::BITS) plane = 0;
+
+   if (++scan == scan_end)
+   {
+      if (swap_pending)
+      {
+         front ^= 0x01;
+         swap_pending = false;
+      }
+
+      scan = buffers[front];
+      scan_end = scan + num_rows * matrix::BITS;
+      frame_count++;
+   }
+   return;
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+/********************************************************************************
+* matrix.hpp: Innehller drivrutiner fr multiplexade LED-matriser samt
+*             charlieplexade lysdiodsgrupper, vilka uppdateras rad fr rad
+*             frn Timer 0 i CTC Mode.
+*
+*             Upp till tv ytor (en matris samt en charlieplexad grupp, eller
+*             tv av samma slag) kan lggas till. Ytorna skannas parallellt,
+*             dr rad n p samtliga ytor r aktiv samtidigt, s att antalet
+*             rader (max 8) och drmed uppdateringsfrekvensen bestms av den
+*             yta som har flest rader. Ytornas pinnar fr inte verlappa.
+*
+*             Varje pixel har en ljusstyrka 0 - 15, som realiseras via
+*             bit-vinkelmodulering (BAM): varje rad visas under fyra
+*             bitplan med lngden 1, 2, 4 respektive 8 tidsenheter  32 us,
+*             dr pixeln r tnd under de bitplan vars bit r ettstlld i
+*             ljusstyrkan. Fr varje rad och bitplan berknas i frvg en
+*             portbild, allts vrdena fr DDRx samt PORTx p samtliga
+*             I/O-portar, s att avbrottsrutinen endast skriver tre portar
+*             och programmerar nsta intervall. Avbrottsrutinens lngd r
+*             drmed konstant oavsett innehll.
+*
+*             Ritning sker i en pixelbuffert via set, fill med mera, vilken
+*             inte pverkar displayen. Vid anrop av show berknas portbilderna
+*             i en bakre buffert, som avbrottsrutinen byter till i brjan av
+*             nsta bild (dubbelbuffring). Drmed uppstr ingen rivning.
+*
+*             Prestanda vid 16 MHz och 8 rader:
+*
+*             Bildlngd               8 rader * 15 enheter * 32 us = 3.84 ms
+*             Uppdateringsfrekvens    ca 260 Hz
+*             Avbrott                 4 per rad, 32 per bild, ca 8300 per sekund
+*             Avbrottsrutin           ca 130 cykler (ca 8 us), varav ca 50 fr
+*                                     prolog och epilog
+*             CPU-belastning          ca 7 %
+*             RAM-tgng              2 * 8 * 4 * 6 = 384 byte portbilder samt
+*                                     32 byte pixelbuffert per yta
+*
+*             Med frre rader kar uppdateringsfrekvensen i motsvarande grad,
+*             exempelvis ca 520 Hz fr en charlieplexad grupp med fyra pinnar,
+*             medan CPU-belastningen r ofrndrad. Uppmtt frekvens kan
+*             kontrolleras via frames.
+*
+*             Timer 0 anvnds exklusivt av denna drivrutin nr matrix::start
+*             har anropats, vilket innebr att timer-objekt inte fr anvnda
+*             timer::sel::timer0 och att extint::measure_latency inte fr
+*             anropas samtidigt. Avbrottsvektorn TIMER0_COMPA_vect
+*             implementeras i matrix.cpp.
+*
+*             Avbrottsrutinen lser, modifierar och skriver DDRx samt PORTx,
+*             men ndrar endast ytornas pinnar. vriga pinnar p samma port
+*             kan drmed anvndas fritt, frutsatt att de ndras odelbart
+*             (exempelvis via output_pin<N> eller en kritisk sektion).
+********************************************************************************/
+#ifndef MATRIX_HPP_
+#define MATRIX_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+
+/********************************************************************************
+* matrix: Namnrymd innehllande drivrutiner fr multiplexade LED-matriser samt
+*         charlieplexade lysdiodsgrupper.
+********************************************************************************/
+namespace matrix
+{
+   static constexpr uint8_t ROWS = 8;              /* Maximalt antal rader per yta. */
+   static constexpr uint8_t COLUMNS = 8;           /* Maximalt antal kolumner per yta. */
+   static constexpr uint8_t SURFACES = 2;          /* Maximalt antal ytor. */
+   static constexpr uint8_t BITS = 4;              /* Antalet bitplan. */
+   static constexpr uint8_t LEVELS = 1 << BITS;    /* Antalet ljusstyrkeniver. */
+   static constexpr uint8_t UNIT_TICKS = 8;        /* Tidsenhetens lngd mtt i ticks  4 us. */
+   static constexpr uint16_t UNIT_US = UNIT_TICKS * 4; /* Tidsenhetens lngd mtt i mikrosekunder. */
+
+   /********************************************************************************
+   * add_matrix: Lgger till en multiplexad LED-matris med angivna rad- samt
+   *             kolumnpinnar, vilka stts till utportar. Ytan fr nsta lediga
+   *             index (0 fr den frsta ytan, 1 fr den andra). Om maximalt
+   *             antal ytor redan har lagts till, eller om antalet rader eller
+   *             kolumner r ogiltigt, returneras false.
+   *
+   *             - row_pins           : Pekare till array med radernas pinnar.
+   *             - rows               : Antalet rader, 1 - 8.
+   *             - column_pins        : Pekare till array med kolumnernas pinnar.
+   *             - columns            : Antalet kolumner, 1 - 8.
+   *             - rows_active_high   : Indikerar ifall aktiv rad drivs hg
+   *                                    (default = true, gemensam anod).
+   *             - columns_active_high: Indikerar ifall tnd kolumn drivs hg
+   *                                    (default = false).
+   ********************************************************************************/
+   bool add_matrix(const uint8_t* row_pins,
+                   const uint8_t rows,
+                   const uint8_t* column_pins,
+                   const uint8_t columns,
+                   const bool rows_active_high = true,
+                   const bool columns_active_high = false);
+
+   /********************************************************************************
+   * add_charlieplex: Lgger till en charlieplexad lysdiodsgrupp med angivna
+   *                  pinnar. Med n pinnar kan n * (n - 1) lysdioder styras,
+   *                  dr pixel (x, y) avser lysdioden med anod p pinne y
+   *                  och katod p pinne x (x != y). Ytan fr nsta lediga
+   *                  index. Om maximalt antal ytor redan har lagts till,
+   *                  eller om antalet pinnar r ogiltigt, returneras false.
+   *
+   *                  - pins : Pekare till array med gruppens pinnar.
+   *                  - count: Antalet pinnar, 2 - 8.
+   ********************************************************************************/
+   bool add_charlieplex(const uint8_t* pins,
+                        const uint8_t count);
+
+   /********************************************************************************
+   * start: Berknar portbilder fr aktuellt innehll och startar skanningen
+   *        via Timer 0.
+   ********************************************************************************/
+   void start(void);
+
+   /********************************************************************************
+   * stop: Stoppar skanningen och slcker samtliga ytor.
+   ********************************************************************************/
+   void stop(void);
+
+   /********************************************************************************
+   * clear: Stoppar skanningen, stter ytornas pinnar till inportar samt tar
+   *        bort samtliga ytor.
+   ********************************************************************************/
+   void clear(void);
+
+   /********************************************************************************
+   * set: Stter ljusstyrkan fr angiven pixel i pixelbufferten. ndringen
+   *      visas frst vid nsta anrop av show.
+   *
+   *      - surface: Ytans index.
+   *      - x      : Pixelns kolumn.
+   *      - y      : Pixelns rad.
+   *      - level  : Ljusstyrka, 0 - 15 (0 = slckt).
+   ********************************************************************************/
+   void set(const uint8_t surface,
+            const uint8_t x,
+            const uint8_t y,
+            const uint8_t level = LEVELS - 1);
+
+   /********************************************************************************
+   * get: Returnerar ljusstyrkan fr angiven pixel i pixelbufferten.
+   *
+   *      - surface: Ytans index.
+   *      - x      : Pixelns kolumn.
+   *      - y      : Pixelns rad.
+   ********************************************************************************/
+   uint8_t get(const uint8_t surface,
+               const uint8_t x,
+               const uint8_t y);
+
+   /********************************************************************************
+   * fill: Stter samtliga pixlar p angiven yta till angiven ljusstyrka.
+   *
+   *       - surface: Ytans index.
+   *       - level  : Ljusstyrka, 0 - 15 (default = 0, dvs. slckt).
+   ********************************************************************************/
+   void fill(const uint8_t surface,
+             const uint8_t level = 0);
+
+   /********************************************************************************
+   * draw_row: Stter angiven rad frn en bitmask, dr bit x motsvarar
+   *           kolumn x, exempelvis fr att rita tecken frn en typsnittstabell.
+   *
+   *           - surface: Ytans index.
+   *           - y      : Radens index.
+   *           - bits   : Bitmask fr radens pixlar.
+   *           - level  : Ljusstyrka fr tnda pixlar (default = 15).
+   ********************************************************************************/
+   void draw_row(const uint8_t surface,
+                 const uint8_t y,
+                 const uint8_t bits,
+                 const uint8_t level = LEVELS - 1);
+
+   /********************************************************************************
+   * show: Berknar portbilder fr pixelbufferten i den bakre bufferten och
+   *       begr byte till denna i brjan av nsta bild. Om fregende byte
+   *       nnu inte har genomfrts returneras false utan tgrd, varvid
+   *       anropet upprepas senare (som lngst en bildlngd).
+   ********************************************************************************/
+   bool show(void);
+
+   /********************************************************************************
+   * pending: Indikerar ifall en begrd byte av buffert nnu inte har
+   *          genomfrts.
+   ********************************************************************************/
+   bool pending(void);
+
+   /********************************************************************************
+   * refresh_rate: Returnerar berknad uppdateringsfrekvens mtt i Hz utifrn
+   *               aktuellt antal rader.
+   ********************************************************************************/
+   uint16_t refresh_rate(void);
+
+   /********************************************************************************
+   * frames: Returnerar antalet visade bilder sedan start, vilket kan anvndas
+   *         fr att mta verklig uppdateringsfrekvens.
+   ********************************************************************************/
+   uint16_t frames(void);
+}
+
+#endif /* MATRIX_HPP_ */
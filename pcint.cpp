@@ -0,0 +1,205 @@
+/********************************************************************************
+* pcint.cpp: Innehller dispatcher fr PCI-avbrott med detektering av
+*            ndrade pinnar och flanker.
+********************************************************************************/
+#include "pcint.hpp"
+#include "interrupt.hpp"
+#include "atomic.hpp"
+#include "power.hpp"
+
+/********************************************************************************
+* port_state: Strukt innehllande tillstnd fr en I/O-port. Bit n i
+*             respektive mask tillhr pin n p porten.
+********************************************************************************/
+struct port_state
+{
+   uint8_t previous = 0;                         /* Fregende avlsning av PINx. */
+   uint8_t rising = 0;                           /* Pinnar som ska anropa hanteraren vid stigande flank. */
+   uint8_t falling = 0;                          /* Pinnar som ska anropa hanteraren vid fallande flank. */
+   void (*handlers[8])(const pcint::change&) {}; /* Hanterare fr respektive pin. */
+};
+
+/* Statiska variabler: */
+static port_state ports[3];                                          /* Tillstnd fr I/O-port B, C och D. */
+static volatile uint8_t* const inputs[3] = { &PINB, &PINC, &PIND };  /* Pinregister fr respektive I/O-port. */
+static volatile uint8_t* const masks[3] = { &PCMSK0, &PCMSK1, &PCMSK2 }; /* Maskregister fr respektive I/O-port. */
+static constexpr uint8_t pin_offset[3] = { 8, 14, 0 };               /* Frsta pin-nummer fr respektive I/O-port. */
+static volatile uint16_t missed_interrupts = 0;                      /* Antalet avbrott utan vald flank. */
+
+/********************************************************************************
+* bit_index: Tabell fr uppslagning av bitindex utifrn en isolerad bit b,
+*            dr index ((b * 0x1D) & 0xFF) >> 5 r unikt fr varje bit.
+********************************************************************************/
+static const uint8_t bit_index[8] = { 0, 1, 6, 2, 7, 5, 4, 3 };
+
+/********************************************************************************
+* locate: Tar fram I/O-port och bit fr angivet pin-nummer. Returnerar false
+*         ifall pin-numret r ogiltigt.
+*
+*         - pin  : Pin-nummer p Arduino Uno.
+*         - index: Referens till variabel dr I/O-portens index lagras.
+*         - bit  : Referens till variabel dr pinnens bit p porten lagras.
+********************************************************************************/
+static bool locate(const uint8_t pin,
+                   uint8_t& index,
+                   uint8_t& bit)
+{
+   if (pin <= 7)
+   {
+      index = static_cast<uint8_t>(io_port::d);
+   }
+   else if (pin <= 13)
+   {
+      index = static_cast<uint8_t>(io_port::b);
+   }
+   else if (pin <= 19)
+   {
+      index = static_cast<uint8_t>(io_port::c);
+   }
+   else
+   {
+      return false;
+   }
+
+   bit = pin - pin_offset[index];
+   return true;
+}
+
+/********************************************************************************
+* dispatch: Avgr vilka pinnar p angiven I/O-port som har ndrats sedan
+*           fregende avlsning och anropar lagrad hanterare fr varje
+*           ndrad pin vars flank har valts. Anropas frn avbrottsrutinen.
+*
+*           - index: Index fr I/O-porten (B = 0, C = 1, D = 2).
+********************************************************************************/
+static inline void dispatch(const uint8_t index)
+{
+   auto& port = ports[index];
+   const uint8_t snapshot = *inputs[index];
+   const uint8_t changed = snapshot ^ port.previous;
+   uint8_t pending = (changed & snapshot & port.rising) | (changed & ~snapshot & port.falling);
+   port.previous = snapshot;
+
+   if (!(changed & (port.rising | port.falling)))
+   {
+      missed_interrupts = missed_interrupts + 1;
+      return;
+   }
+   if (!pending) return;
+
+   pcint::change change;
+   change.timestamp = power::now();
+
+   while (pending)
+   {
+      const uint8_t lowest = pending & -pending;
+      const uint8_t bit = bit_index[static_cast<uint8_t>(lowest * 0x1D) >> 5];
+      pending &= pending - 1;
+
+      change.pin = pin_offset[index] + bit;
+      change.rising = snapshot & lowest;
+      port.handlers[bit](change);
+   }
+   return;
+}
+
+/********************************************************************************
+* port_b: Avbrottsrutin fr PCI-avbrott p I/O-port B (PCINT0_vect).
+********************************************************************************/
+static void port_b(void)
+{
+   dispatch(static_cast<uint8_t>(io_port::b));
+   return;
+}
+
+/********************************************************************************
+* port_c: Avbrottsrutin fr PCI-avbrott p I/O-port C (PCINT1_vect).
+********************************************************************************/
+static void port_c(void)
+{
+   dispatch(static_cast<uint8_t>(io_port::c));
+   return;
+}
+
+/********************************************************************************
+* port_d: Avbrottsrutin fr PCI-avbrott p I/O-port D (PCINT2_vect).
+********************************************************************************/
+static void port_d(void)
+{
+   dispatch(static_cast<uint8_t>(io_port::d));
+   return;
+}
+
+/********************************************************************************
+* attach: Lagrar angiven hanterare fr angiven pin och aktiverar PCI-avbrott
+*         p pinnen. Pinnens aktuella niv lagras som fregende avlsning.
+*         Dispatchern installeras nr frsta pinnen p porten registreras
+*         via pcint, oavsett om andra pinnar p porten redan har aktiverats
+*         i PCMSKx, exempelvis via button::enable_interrupt.
+*
+*         - pin    : Pin-nummer p Arduino Uno, exempelvis 13 eller A0.
+*         - handler: Hanterare som anropas frn avbrottsrutinen vid ndring.
+*         - edge   : Flank som ska anropa hanteraren.
+********************************************************************************/
+void pcint::attach(const uint8_t pin,
+                   void (*handler)(const change&),
+                   const enum edge edge)
+{
+   uint8_t index, bit;
+   if (!handler || !locate(pin, index, bit)) return;
+
+   auto& port = ports[index];
+   const uint8_t mask = (1 << bit);
+   critical_section lock;
+   const bool first = !(port.rising | port.falling);
+
+   port.handlers[bit] = handler;
+   port.rising &= ~mask;
+   port.falling &= ~mask;
+   if (edge != edge::falling) port.rising |= mask;
+   if (edge != edge::rising) port.falling |= mask;
+
+   if (first)
+   {
+      if (index == static_cast<uint8_t>(io_port::b)) interrupt::attach<interrupt::vector::pcint0>(&port_b);
+      else if (index == static_cast<uint8_t>(io_port::c)) interrupt::attach<interrupt::vector::pcint1>(&port_c);
+      else interrupt::attach<interrupt::vector::pcint2>(&port_d);
+   }
+
+   port.previous = (port.previous & ~mask) | (*inputs[index] & mask);
+   *masks[index] |= mask;
+   PCICR |= (1 << index);
+   return;
+}
+
+/********************************************************************************
+* detach: Inaktiverar PCI-avbrott och tar bort lagrad hanterare fr angiven
+*         pin. Avbrott p I/O-porten inaktiveras nr sista pinnen tas bort.
+*
+*         - pin: Pin-nummer p Arduino Uno, exempelvis 13 eller A0.
+********************************************************************************/
+void pcint::detach(const uint8_t pin)
+{
+   uint8_t index, bit;
+   if (!locate(pin, index, bit)) return;
+
+   auto& port = ports[index];
+   const uint8_t mask = (1 << bit);
+   critical_section lock;
+
+   *masks[index] &= ~mask;
+   port.rising &= ~mask;
+   port.falling &= ~mask;
+   port.handlers[bit] = nullptr;
+   if (!*masks[index]) PCICR &= ~(1 << index);
+   return;
+}
+
+/********************************************************************************
+* missed: Returnerar antalet avbrott dr ingen vald flank kunde detekteras.
+********************************************************************************/
+uint16_t pcint::missed(void)
+{
+   critical_section lock;
+   return missed_interrupts;
+}
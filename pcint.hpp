@@ -0,0 +1,85 @@
+/********************************************************************************
+* pcint.hpp: Innehller en dispatcher fr PCI-avbrott, som avgr vilka pinnar
+*            som har ndrats samt p vilken flank, s att detta inte behver
+*            implementeras av anvndaren i varje avbrottsrutin.
+*
+*            Vid avbrott lses aktuell I/O-port en gng (PINx) och jmfrs
+*            med fregende avlsning via XOR, vilket ger samtliga ndrade
+*            pinnar. ndringen tidsstmplas via tidsbasen i power.hpp, varefter
+*            lagrad hanterare anropas fr varje ndrad pin vars flank har valts.
+*
+*            ndrade pinnar itereras genom att lgsta ettstllda bit isoleras
+*            (mask & -mask) och dess index sls upp via multiplikation med en
+*            de Bruijn-sekvens, varefter biten nollstlls. Kostnaden i
+*            avbrottsrutinen blir drmed proportionell mot antalet ndrade
+*            pinnar, inte mot antalet pinnar p porten.
+*
+*            Dispatchern tar ver aktuell I/O-ports avbrottsvektor via
+*            dispatch-lagret i interrupt.hpp nr frsta pinnen p porten
+*            lggs till via pcint, vilket erstter en eventuell avbrottsrutin
+*            lagrad via button::init fr samma port. Pinnar som aktiverats
+*            via button::enable_interrupt p samma port frblir aktiverade i
+*            PCMSKx men saknar hanterare, s deras avbrott rknas av missed.
+********************************************************************************/
+#ifndef PCINT_HPP_
+#define PCINT_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+
+/********************************************************************************
+* pcint: Namnrymd innehllande dispatcher fr PCI-avbrott.
+********************************************************************************/
+namespace pcint
+{
+   /********************************************************************************
+   * edge: Enumerationsklass fr val av flank som ska anropa hanteraren.
+   ********************************************************************************/
+   enum class edge
+   {
+      falling, /* Fallande flank. */
+      rising,  /* Stigande flank. */
+      both     /* Bde stigande och fallande flank. */
+   };
+
+   /********************************************************************************
+   * change: Strukt innehllande en detekterad ndring p en pin.
+   ********************************************************************************/
+   struct change
+   {
+      uint8_t pin;        /* Pin-nummer p Arduino Uno, exempelvis 13. */
+      bool rising;        /* Indikerar stigande (true) eller fallande flank. */
+      uint32_t timestamp; /* Tidpunkt fr avbrottet mtt i ticks via power::now. */
+   };
+
+   /********************************************************************************
+   * attach: Lagrar angiven hanterare fr angiven pin och aktiverar PCI-avbrott
+   *         p pinnen. Pinnens aktuella niv lagras som fregende avlsning,
+   *         s att ingen flank registreras vid aktivering.
+   *
+   *         - pin    : Pin-nummer p Arduino Uno, exempelvis 13 eller A0.
+   *         - handler: Hanterare som anropas frn avbrottsrutinen vid ndring.
+   *         - edge   : Flank som ska anropa hanteraren (default = bda).
+   ********************************************************************************/
+   void attach(const uint8_t pin,
+               void (*handler)(const change&),
+               const enum edge edge = edge::both);
+
+   /********************************************************************************
+   * detach: Inaktiverar PCI-avbrott och tar bort lagrad hanterare fr angiven
+   *         pin. Avbrott p I/O-porten inaktiveras nr sista pinnen tas bort.
+   *
+   *         - pin: Pin-nummer p Arduino Uno, exempelvis 13 eller A0.
+   ********************************************************************************/
+   void detach(const uint8_t pin);
+
+   /********************************************************************************
+   * missed: Returnerar antalet avbrott dr ingen vald flank kunde detekteras,
+   *         exempelvis d en puls var kortare n avbrottsrutinens latens s att
+   *         pinnen hann terg till fregende niv fre avlsningen. Flanker
+   *         som inte har valts fr en pin rknas inte.
+   ********************************************************************************/
+   uint16_t missed(void);
+}
+
+#endif /* PCINT_HPP_ */
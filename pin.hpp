@@ -0,0 +1,237 @@
+/********************************************************************************
+* pin.hpp: Innehller pinnar vars I/O-port och bit bestms vid kompileringen
+*          via mallen pin<N>, dr N utgr pin-numret p Arduino Uno.
+*
+*          Eftersom bde registrets adress och bitmasken r konstanter
+*          genererar kompilatorn en enda instruktion fr varje operation:
+*          sbi/cbi vid ettstllning/nollstllning, out till PINx vid toggling
+*          samt sbic/sbis vid avlsning. Inga pekare lagras, s pinnen
+*          frbrukar inget RAM-minne.
+*
+*          Jmfrelse med klasserna led och button samt basic_led och
+*          basic_button, som har samma grnssnitt men bygger p pin<N>
+*          (avr-gcc -Os, uppskattat utifrn genererade instruktioner, ej
+*          uppmtt):
+*
+*          Operation          led/button                basic_led/basic_button, pin<N>
+*          on/off             ca 20 cykler, 12 ord      2 cykler (sbi/cbi), 1 ord
+*          toggle             ca 15 cykler, 9 ord       2 cykler (ldi + out), 2 ord
+*          is_pressed/read    ca 15 cykler, 9 ord       1 - 3 cykler (sbis), 1 ord
+*          enable_interrupt   ca 25 cykler, 15 ord      ca 8 cykler (lds/ori/sts x 2), 8 ord
+*          RAM per pin        9 byte (led), 8 byte      0 byte (1 byte per deklarerat
+*                             (button)                  basic_led/basic_button-objekt)
+*
+*          RAM-tgngen fr led utgrs av pin-numret, tre registerpekare
+*          samt pekaren till rutinen fr mappade register (expander.hpp),
+*          fr button av pin-numret, tre registerpekare samt PCI-biten.
+*          basic_led och basic_button saknar datamedlemmar, men ett objekt
+*          upptar nd en byte, eftersom tomma objekt har storleken 1.
+*
+*          led_vector, pwm, expander, debounce och gesture lagrar pekare
+*          eller referenser till objekt av klasserna led och button, vars
+*          pin vljs under krning, s dr anvnds fortfarande led och
+*          button. vriga pinnar som r knda vid kompileringen styrs via
+*          basic_led<pin<N>> och basic_button<pin<N>>, alternativt direkt
+*          via pin<N>.
+*
+*          Kostnaden fr led/button domineras av att pekaren och pin-numret
+*          lses frn objektet, att bitmasken rknas fram med en variabel
+*          skiftning samt att registret lses, modifieras och skrivs via
+*          pekaren. Drutver tillkommer initieringens if/else-kedja.
+*
+*          Mallarna output_pin, input_pin och input_pullup_pin initierar
+*          pinnens riktning. Samtliga medlemmar r statiska, s pinnen
+*          anvnds lmpligen som typ, exempelvis:
+*
+*          using red = output_pin<8>;
+*          red::init();
+*          red::set();
+********************************************************************************/
+#ifndef PIN_HPP_
+#define PIN_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+
+/********************************************************************************
+* pin: Generisk klass fr en pin vars I/O-port och bit bestms vid
+*      kompileringen. N utgr pin-numret p Arduino Uno, exempelvis 8 eller A0.
+********************************************************************************/
+template<uint8_t N>
+class pin
+{
+public:
+   static_assert(N <= 19, "Invalid pin number!");
+
+   static constexpr uint8_t NUMBER = N;                                          /* Pin-nummer p Arduino Uno. */
+   static constexpr uint8_t BIT = N <= 7 ? N : (N <= 13 ? N - 8 : N - 14);       /* Bit p aktuell I/O-port. */
+   static constexpr uint8_t MASK = (1 << BIT);                                   /* Bitmask p aktuell I/O-port. */
+   static constexpr io_port PORT = N <= 7 ? io_port::d : (N <= 13 ? io_port::b : io_port::c); /* Aktuell I/O-port. */
+
+   /********************************************************************************
+   * ddr: Returnerar en referens till pinnens datariktningsregister.
+   ********************************************************************************/
+   static inline volatile uint8_t& ddr(void)
+   {
+      if constexpr (PORT == io_port::d) return DDRD;
+      else if constexpr (PORT == io_port::b) return DDRB;
+      else return DDRC;
+   }
+
+   /********************************************************************************
+   * data: Returnerar en referens till pinnens dataregister.
+   ********************************************************************************/
+   static inline volatile uint8_t& data(void)
+   {
+      if constexpr (PORT == io_port::d) return PORTD;
+      else if constexpr (PORT == io_port::b) return PORTB;
+      else return PORTC;
+   }
+
+   /********************************************************************************
+   * input: Returnerar en referens till pinnens pinregister.
+   ********************************************************************************/
+   static inline volatile uint8_t& input(void)
+   {
+      if constexpr (PORT == io_port::d) return PIND;
+      else if constexpr (PORT == io_port::b) return PINB;
+      else return PINC;
+   }
+
+   /********************************************************************************
+   * set_output: Stter pinnen till utport (sbi).
+   ********************************************************************************/
+   static inline void set_output(void)
+   {
+      ddr() |= MASK;
+      return;
+   }
+
+   /********************************************************************************
+   * set_input: Stter pinnen till inport (cbi), med eller utan intern
+   *            pullup-resistor.
+   *
+   *            - pullup: Indikerar ifall intern pullup-resistor ska aktiveras.
+   ********************************************************************************/
+   static inline void set_input(const bool pullup = false)
+   {
+      ddr() &= ~MASK;
+      write(pullup);
+      return;
+   }
+
+   /********************************************************************************
+   * set: Ettstller pinnen (sbi).
+   ********************************************************************************/
+   static inline void set(void)
+   {
+      data() |= MASK;
+      return;
+   }
+
+   /********************************************************************************
+   * clear: Nollstller pinnen (cbi).
+   ********************************************************************************/
+   static inline void clear(void)
+   {
+      data() &= ~MASK;
+      return;
+   }
+
+   /********************************************************************************
+   * toggle: Togglar pinnen genom att skriva en etta till pinregistret.
+   ********************************************************************************/
+   static inline void toggle(void)
+   {
+      input() = MASK;
+      return;
+   }
+
+   /********************************************************************************
+   * write: Ettstller eller nollstller pinnen.
+   *
+   *        - value: Pinnens nya vrde.
+   ********************************************************************************/
+   static inline void write(const bool value)
+   {
+      if (value)
+      {
+         set();
+      }
+      else
+      {
+         clear();
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * read: Lser av pinnen och indikerar ifall denna r hg (sbis/sbic).
+   ********************************************************************************/
+   static inline bool read(void)
+   {
+      return input() & MASK;
+   }
+};
+
+/********************************************************************************
+* output_pin: Generisk klass fr en utport vars I/O-port och bit bestms vid
+*             kompileringen.
+********************************************************************************/
+template<uint8_t N>
+class output_pin : public pin<N>
+{
+public:
+
+   /********************************************************************************
+   * init: Stter pinnen till utport med angivet startvrde.
+   *
+   *       - start_val: Pinnens startvrde (default = 0, dvs. lg).
+   ********************************************************************************/
+   static inline void init(const bool start_val = false)
+   {
+      pin<N>::write(start_val);
+      pin<N>::set_output();
+      return;
+   }
+};
+
+/********************************************************************************
+* input_pin: Generisk klass fr en inport utan intern pullup-resistor vars
+*            I/O-port och bit bestms vid kompileringen.
+********************************************************************************/
+template<uint8_t N>
+class input_pin : public pin<N>
+{
+public:
+
+   /********************************************************************************
+   * init: Stter pinnen till inport utan intern pullup-resistor.
+   ********************************************************************************/
+   static inline void init(void)
+   {
+      pin<N>::set_input(false);
+      return;
+   }
+};
+
+/********************************************************************************
+* input_pullup_pin: Generisk klass fr en inport med intern pullup-resistor
+*                   vars I/O-port och bit bestms vid kompileringen.
+********************************************************************************/
+template<uint8_t N>
+class input_pullup_pin : public pin<N>
+{
+public:
+
+   /********************************************************************************
+   * init: Stter pinnen till inport med intern pullup-resistor.
+   ********************************************************************************/
+   static inline void init(void)
+   {
+      pin<N>::set_input(true);
+      return;
+   }
+};
+
+#endif /* PIN_HPP_ */
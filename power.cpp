@@ -0,0 +1,316 @@
+/********************************************************************************
+* power.cpp: Innehller drivrutiner fr tidsbas samt strmsnl vila (tickless
+*            idle) via Timer 2 och mikrodatorns sleep modes.
+********************************************************************************/
+#include "power.hpp"
+#include "serial.hpp"
+#include "interrupt.hpp"
+#include "atomic.hpp"
+
+/* Statiska variabler: */
+static volatile uint32_t overflow_count = 0; /* Antalet overflows av Timer 2 (tidsbasens vre bitar). */
+static volatile bool timebase_wakeup = false; /* Indikerar att senaste vckning orsakades av tidsbasen. */
+static bool measurement_enabled = false;      /* Indikerar ifall mtlge r aktiverat. */
+static uint32_t measurement_start = 0;        /* Starttid fr pgende mtning mtt i ticks. */
+static power::stats sleep_stats[8];           /* Mtvrden fr respektive sleep mode (indexerat via SM2 - SM0). */
+
+/********************************************************************************
+* on_overflow: Avbrottsrutin som ger rum vid overflow av Timer 2, dvs. var
+*              256:e tick. Tidsbasens vre bitar rknas upp. Rutinen lagras
+*              fr avbrottsvektor TIMER2_OVF_vect via dispatch-lagret.
+********************************************************************************/
+static void on_overflow(void)
+{
+   overflow_count++;
+   timebase_wakeup = true;
+   return;
+}
+
+/********************************************************************************
+* wait_for_async_update: Vntar p att Timer 2 har synkroniserats med den
+*                        asynkrona klockan. Efter vckning frn Power-save Mode
+*                        lses TCNT2 som vrdet fre vilan fram till nsta
+*                        stigande flank p TOSC1, vilket korrigeras genom att
+*                        en dummy-skrivning till OCR2B genomfrs och sedan
+*                        invntas. Samma vntan krvs innan ny insomning efter
+*                        att registren fr Timer 2 har skrivits.
+********************************************************************************/
+static inline void wait_for_async_update(void)
+{
+   if (!power::ASYNC_CLOCK) return;
+   OCR2B = OCR2B;
+   while (ASSR & ((1 << TCN2UB) | (1 << OCR2AUB) | (1 << OCR2BUB) | (1 << TCR2AUB) | (1 << TCR2BUB)));
+   return;
+}
+
+/********************************************************************************
+* enter_sleep_mode: Frstter processorn i angivet sleep mode. Avbrott mste
+*                   vara inaktiverade vid anrop. Avbrott aktiveras direkt fre
+*                   instruktionen SLEEP, vilket garanterar att ett avbrott som
+*                   intrffar efter kontroll av villkoren fr vilan nd vcker
+*                   processorn. Vid terkomst r avbrott ter inaktiverade.
+*
+*                   - sleep_mode: Sleep mode som ska anvndas.
+********************************************************************************/
+static void enter_sleep_mode(const power::mode sleep_mode)
+{
+   const auto start = measurement_enabled ? power::now() : 0;
+   wait_for_async_update();
+
+   SMCR = static_cast<uint8_t>(sleep_mode) | (1 << SE);
+   asm("SEI");
+   asm("SLEEP");
+   SMCR = 0x00;
+   asm("CLI");
+
+   wait_for_async_update();
+
+   if (measurement_enabled)
+   {
+      auto& stats = sleep_stats[static_cast<uint8_t>(sleep_mode) >> SM0];
+      stats.entries++;
+      stats.ticks += power::now() - start;
+   }
+   return;
+}
+
+/********************************************************************************
+* init: Initierar Timer 2 som kontinuerligt rknande tidsbas fr tickless
+*       vila. Overflow-avbrott ger rum var 256:e tick fr upprkning av
+*       tidsbasens vre bitar.
+********************************************************************************/
+void power::init(void)
+{
+   TIMSK2 = 0x00;
+   if (power::ASYNC_CLOCK) ASSR = (1 << AS2);
+
+   TCCR2A = 0x00;
+   TCCR2B = power::ASYNC_CLOCK ? (1 << CS20) : (1 << CS22) | (1 << CS21) | (1 << CS20);
+   TCNT2 = 0;
+   wait_for_async_update();
+
+   interrupt::attach<interrupt::vector::timer2_ovf>(&on_overflow);
+   TIFR2 = (1 << OCF2A) | (1 << TOV2);
+   TIMSK2 = (1 << TOIE2);
+   asm("SEI");
+   return;
+}
+
+/********************************************************************************
+* now: Returnerar aktuell tid mtt i ticks sedan tidsbasen initierades.
+*      Om ett overflow har gt rum men nnu inte hanterats av motsvarande
+*      avbrottsrutin kompenseras detta, s att returnerad tid aldrig minskar.
+********************************************************************************/
+uint32_t power::now(void)
+{
+   critical_section lock;
+   auto high = overflow_count;
+   const auto low = TCNT2;
+   if ((TIFR2 & (1 << TOV2)) && low < 128) high++;
+   return (high << 8) | low;
+}
+
+/********************************************************************************
+* deepest_mode: Returnerar det djupaste sleep mode som fortfarande medger
+*               vckning, utefter vilka kringkretsar som fr tillfllet
+*               behver I/O-klockan (Timer 0, Timer 1, ADC samt USART).
+*
+*               - timed: Indikerar ifall vckning ska ske via Timer 2 vid
+*                        en given deadline.
+********************************************************************************/
+enum power::mode power::deepest_mode(const bool timed)
+{
+   const bool timer_active = TIMSK0 || TIMSK1;
+   const bool adc_active = ADCSRA & (1 << ADSC);
+   const bool usart_active = (UCSR0B & (1 << TXEN0)) && !(UCSR0A & (1 << TXC0));
+
+   if (timer_active || adc_active || usart_active)
+   {
+      return mode::idle;
+   }
+   else if (power::ASYNC_CLOCK)
+   {
+      return mode::power_save;
+   }
+   else
+   {
+      return timed ? mode::idle : mode::power_down;
+   }
+}
+
+/********************************************************************************
+* sleep: Frstter processorn i djupast mjliga sleep mode tills ett godtyckligt
+*        avbrott (exempelvis PCI-avbrott eller Watchdog timeout) ger rum.
+*        Overflow-avbrott frn tidsbasen vcker inte anroparen.
+********************************************************************************/
+void power::sleep(void)
+{
+   asm("CLI");
+
+   do
+   {
+      timebase_wakeup = false;
+      enter_sleep_mode(power::deepest_mode(false));
+   } while (timebase_wakeup);
+
+   asm("SEI");
+   return;
+}
+
+/********************************************************************************
+* sleep_until: Frstter processorn i djupast mjliga sleep mode tills angiven
+*              deadline har passerats eller ett annat avbrott n tidsbasens
+*              ger rum. Returnerar true om deadline har passerats, annars
+*              false.
+*
+*              Eftersom Timer 2 fortstter rkna med avbrott inaktiverade kan
+*              deadline passeras medan OCR2A programmeras, varvid compare
+*              match uteblir och vckning i stllet sker vid nsta overflow,
+*              upp till 255 ticks fr sent. Drfr invntas uppdateringen av
+*              OCR2A vid asynkron klocka, varefter tiden lses om och vilan
+*              hoppas ver ifall deadline redan har passerats.
+*
+*              - deadline: Tidpunkt mtt i ticks d vckning ska ske.
+********************************************************************************/
+bool power::sleep_until(const uint32_t deadline)
+{
+   asm("CLI");
+
+   while (true)
+   {
+      const auto current = power::now();
+
+      if (static_cast<int32_t>(deadline - current) <= 0)
+      {
+         TIMSK2 &= ~(1 << OCIE2A);
+         asm("SEI");
+         return true;
+      }
+
+      if ((deadline >> 8) == (current >> 8))
+      {
+         OCR2A = static_cast<uint8_t>(deadline);
+         if (power::ASYNC_CLOCK) while (ASSR & (1 << OCR2AUB));
+         TIFR2 = (1 << OCF2A);
+         TIMSK2 |= (1 << OCIE2A);
+         if (static_cast<int32_t>(deadline - power::now()) <= 0) continue;
+      }
+
+      timebase_wakeup = false;
+      enter_sleep_mode(power::deepest_mode(true));
+
+      if (!timebase_wakeup)
+      {
+         TIMSK2 &= ~(1 << OCIE2A);
+         asm("SEI");
+         return static_cast<int32_t>(deadline - power::now()) <= 0;
+      }
+   }
+}
+
+/********************************************************************************
+* sleep_ms: Frstter processorn i vila under angiven tid, avbrutet endast
+*           av att tiden har lpt ut. vriga avbrott hanteras under tiden.
+*
+*           - time_ms: Tiden mtt i millisekunder.
+********************************************************************************/
+void power::sleep_ms(const uint32_t time_ms)
+{
+   const auto deadline = power::now() + power::ms_to_ticks(time_ms);
+   while (!power::sleep_until(deadline));
+   return;
+}
+
+/********************************************************************************
+* enable_measurement: Aktiverar mtlge, dr antalet insomningar samt tiden
+*                     i respektive sleep mode summeras.
+********************************************************************************/
+void power::enable_measurement(void)
+{
+   power::reset_stats();
+   measurement_enabled = true;
+   return;
+}
+
+/********************************************************************************
+* disable_measurement: Inaktiverar mtlge.
+********************************************************************************/
+void power::disable_measurement(void)
+{
+   measurement_enabled = false;
+   return;
+}
+
+/********************************************************************************
+* reset_stats: Nollstller lagrade mtvrden samt starttiden fr mtningen.
+********************************************************************************/
+void power::reset_stats(void)
+{
+   for (auto& i : sleep_stats)
+   {
+      i.entries = 0;
+      i.ticks = 0;
+   }
+
+   measurement_start = power::now();
+   return;
+}
+
+/********************************************************************************
+* get_stats: Returnerar lagrade mtvrden fr angivet sleep mode.
+*
+*            - sleep_mode: Sleep mode vars mtvrden ska returneras.
+********************************************************************************/
+const power::stats& power::get_stats(const mode sleep_mode)
+{
+   return sleep_stats[static_cast<uint8_t>(sleep_mode) >> SM0];
+}
+
+/********************************************************************************
+* print_stats: Skriver ut tiden i respektive anvnt sleep mode samt andelen
+*              av den totala mttiden via seriell verfring. Tiden i aktivt
+*              lge utgrs av mttiden som inte har spenderats i vila.
+********************************************************************************/
+void power::print_stats(void)
+{
+   static const char* names[] = { "Idle", "ADC noise reduction", "Power-down", "Power-save",
+                                  "Reserved", "Reserved", "Standby", "Extended standby" };
+   const auto total_ticks = power::now() - measurement_start;
+   auto sleep_ticks = 0UL;
+
+   serial::print("Measurement time: ");
+   serial::print_unsigned(power::ticks_to_ms(total_ticks));
+   serial::print(" ms\n");
+
+   for (uint8_t i = 0; i < sizeof(sleep_stats) / sizeof(power::stats); ++i)
+   {
+      if (sleep_stats[i].entries == 0) continue;
+      sleep_ticks += sleep_stats[i].ticks;
+
+      serial::print(names[i]);
+      serial::print(": ");
+      serial::print_unsigned(power::ticks_to_ms(sleep_stats[i].ticks));
+      serial::print(" ms (");
+      serial::print(total_ticks ? 100.0 * sleep_stats[i].ticks / total_ticks : 0.0);
+      serial::print(" %), ");
+      serial::print_unsigned(sleep_stats[i].entries);
+      serial::print(" entries\n");
+   }
+
+   serial::print("Active: ");
+   serial::print_unsigned(power::ticks_to_ms(total_ticks - sleep_ticks));
+   serial::print(" ms\n");
+   return;
+}
+
+/********************************************************************************
+* ISR (TIMER2_COMPA_vect): Avbrottsrutin som ger rum nr Timer 2 nr
+*                          programmerad deadline. Avbrottet inaktiveras direkt,
+*                          eftersom ny deadline programmeras vid nsta vila.
+********************************************************************************/
+ISR (TIMER2_COMPA_vect)
+{
+   TIMSK2 &= ~(1 << OCIE2A);
+   timebase_wakeup = true;
+   return;
+}
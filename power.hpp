@@ -0,0 +1,170 @@
+/********************************************************************************
+* power.hpp: Innehller drivrutiner fr strmsnl vila (tickless idle) via
+*            mikrodatorns sleep modes. Nr inget arbete finns att utfra
+*            programmeras nsta deadline in i Timer 2:s compare-register,
+*            varefter processorn frstts i djupast mjliga sleep mode som
+*            fortfarande medger vckning. Timer 2 anvnds som tidsbas och
+*            rknar kontinuerligt, ven under vila, vilket gr att ingen
+*            periodisk tick behvs fr att hlla reda p tiden.
+*
+*            Timer 2 klockas synkront via systemklockan med prescaler 1024,
+*            vilket ger en tick var 64:e mikrosekund. Om en 32.768 kHz-kristall
+*            r ansluten till TOSC1/TOSC2 kan ASYNC_CLOCK sttas till true,
+*            varvid Timer 2 klockas asynkront och fortstter rkna i Power-save
+*            Mode, vilket r betydligt strmsnlare n Idle Mode. P Arduino Uno
+*            r TOSC-pinnarna upptagna av systemkristallen, s dr r Idle Mode
+*            det djupaste lget som medger tidsstyrd vckning.
+*
+*            Timer 2 reserveras fr tidsbasen nr power::init anropas, vilket
+*            innebr att timer-objekt inte fr anvnda timer::sel::timer2 samtidigt.
+*            Overflow-avbrott hanteras via dispatch-lagret i interrupt.hpp,
+*            medan avbrottsvektorn TIMER2_COMPA_vect implementeras i power.cpp.
+*
+*            I mtlge summeras antalet insomningar samt tiden som spenderats
+*            i respektive sleep mode, vilket kan skrivas ut via seriell
+*            verfring fr att verifiera strmbesparingen.
+********************************************************************************/
+#ifndef POWER_HPP_
+#define POWER_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+
+/********************************************************************************
+* power: Namnrymd innehllande drivrutiner fr tidsbas samt strmsnl vila.
+********************************************************************************/
+namespace power
+{
+   static constexpr auto ASYNC_CLOCK = false; /* Indikerar ifall Timer 2 klockas via 32.768 kHz-kristall. */
+
+   /* Tid mellan varje tick i tidsbasen mtt i mikrosekunder: */
+   static constexpr auto TICK_US = ASYNC_CLOCK ? 1000000.0 / 32768 : 1024 * 1000000.0 / F_CPU;
+
+   /********************************************************************************
+   * mode: Enumerationsklass fr val av sleep mode. Vrdena motsvarar bitarna
+   *       SM2 - SM0 i registret SMCR.
+   ********************************************************************************/
+   enum class mode
+   {
+      idle                = 0,                                       /* Idle Mode. */
+      adc_noise_reduction = (1 << SM0),                              /* ADC Noise Reduction Mode. */
+      power_down          = (1 << SM1),                              /* Power-down Mode. */
+      power_save          = (1 << SM1) | (1 << SM0),                 /* Power-save Mode. */
+      standby             = (1 << SM2) | (1 << SM1),                 /* Standby Mode. */
+      extended_standby    = (1 << SM2) | (1 << SM1) | (1 << SM0)     /* Extended Standby Mode. */
+   };
+
+   /********************************************************************************
+   * stats: Strukt fr lagring av mtvrden fr ett givet sleep mode.
+   ********************************************************************************/
+   struct stats
+   {
+      uint32_t entries = 0; /* Antalet gnger aktuellt sleep mode har anvnts. */
+      uint32_t ticks = 0;   /* Total tid i aktuellt sleep mode mtt i ticks. */
+   };
+
+   /********************************************************************************
+   * init: Initierar Timer 2 som kontinuerligt rknande tidsbas fr tickless
+   *       vila. Overflow-avbrott ger rum var 256:e tick fr upprkning av
+   *       tidsbasens vre bitar.
+   ********************************************************************************/
+   void init(void);
+
+   /********************************************************************************
+   * now: Returnerar aktuell tid mtt i ticks sedan tidsbasen initierades.
+   ********************************************************************************/
+   uint32_t now(void);
+
+   /********************************************************************************
+   * ms_to_ticks: Returnerar antalet ticks som motsvarar angiven tid, avrundat
+   *              till nrmaste heltal.
+   *
+   *              - time_ms: Tiden mtt i millisekunder.
+   ********************************************************************************/
+   auto ms_to_ticks = [](const uint32_t time_ms)
+   {
+      return static_cast<uint32_t>(time_ms * 1000.0 / TICK_US + 0.5);
+   };
+
+   /********************************************************************************
+   * ticks_to_ms: Returnerar tiden mtt i millisekunder fr angivet antal ticks,
+   *              avrundat till nrmaste heltal.
+   *
+   *              - ticks: Antalet ticks.
+   ********************************************************************************/
+   auto ticks_to_ms = [](const uint32_t ticks)
+   {
+      return static_cast<uint32_t>(ticks * TICK_US / 1000.0 + 0.5);
+   };
+
+   /********************************************************************************
+   * deepest_mode: Returnerar det djupaste sleep mode som fortfarande medger
+   *               vckning, utefter vilka kringkretsar som fr tillfllet
+   *               behver I/O-klockan (Timer 0, Timer 1, ADC samt USART).
+   *
+   *               - timed: Indikerar ifall vckning ska ske via Timer 2 vid
+   *                        en given deadline.
+   ********************************************************************************/
+   enum mode deepest_mode(const bool timed);
+
+   /********************************************************************************
+   * sleep: Frstter processorn i djupast mjliga sleep mode tills ett godtyckligt
+   *        avbrott (exempelvis PCI-avbrott eller Watchdog timeout) ger rum.
+   *        Overflow-avbrott frn tidsbasen vcker inte anroparen.
+   *
+   *        Om Timer 2 klockas synkront och Power-down Mode anvnds stannar
+   *        tidsbasen under vilan, eftersom tiden d inte kan mtas.
+   ********************************************************************************/
+   void sleep(void);
+
+   /********************************************************************************
+   * sleep_until: Frstter processorn i djupast mjliga sleep mode tills angiven
+   *              deadline har passerats eller ett annat avbrott n tidsbasens
+   *              ger rum. Returnerar true om deadline har passerats, annars
+   *              false. Deadline programmeras in i OCR2A frst nr den ligger
+   *              inom nstkommande 256 ticks, vrig tid vcks processorn endast
+   *              kortvarigt vid overflow av Timer 2.
+   *
+   *              - deadline: Tidpunkt mtt i ticks d vckning ska ske.
+   ********************************************************************************/
+   bool sleep_until(const uint32_t deadline);
+
+   /********************************************************************************
+   * sleep_ms: Frstter processorn i vila under angiven tid, avbrutet endast
+   *           av att tiden har lpt ut. vriga avbrott hanteras under tiden.
+   *
+   *           - time_ms: Tiden mtt i millisekunder.
+   ********************************************************************************/
+   void sleep_ms(const uint32_t time_ms);
+
+   /********************************************************************************
+   * enable_measurement: Aktiverar mtlge, dr antalet insomningar samt tiden
+   *                     i respektive sleep mode summeras.
+   ********************************************************************************/
+   void enable_measurement(void);
+
+   /********************************************************************************
+   * disable_measurement: Inaktiverar mtlge.
+   ********************************************************************************/
+   void disable_measurement(void);
+
+   /********************************************************************************
+   * reset_stats: Nollstller lagrade mtvrden samt starttiden fr mtningen.
+   ********************************************************************************/
+   void reset_stats(void);
+
+   /********************************************************************************
+   * get_stats: Returnerar lagrade mtvrden fr angivet sleep mode.
+   *
+   *            - sleep_mode: Sleep mode vars mtvrden ska returneras.
+   ********************************************************************************/
+   const stats& get_stats(const mode sleep_mode);
+
+   /********************************************************************************
+   * print_stats: Skriver ut tiden i respektive anvnt sleep mode samt andelen
+   *              av den totala mttiden via seriell verfring.
+   ********************************************************************************/
+   void print_stats(void);
+}
+
+#endif /* POWER_HPP_ */
@@ -1,6 +1,16 @@
 /********************************************************************************
 * pwm.hpp: Innehller drivrutiner fr PWM-styrning av en godtycklig utenhet,
 *          ssom en eller flera lysdioder.
+*
+*          run samt run_with_duty_cycle blockerar under en hel PWM-period.
+*          I en schemalagd task anvnds i stllet update, som inte blockerar
+*          utan utfr ett steg per anrop, exempelvis:
+*
+*          scheduler::task pwm_task([]() { pwm1.update(); }, 1);
+*
+*          Med en task var millisekund och tio steg per period (default)
+*          blir periodtiden 10 ms (100 Hz) med elva ljusniver. Den analoga
+*          insignalen lses av en gng per period, vilket tar ca 0.1 ms.
 ********************************************************************************/
 #ifndef PWM_HPP_
 #define PWM_HPP_
@@ -26,6 +36,9 @@ private:
    void (T::*output_high_)(void) = nullptr; /* Pekare till funktion fr att tnda ansluten utenhet. */
    void (T::*output_low_)(void) = nullptr;  /* Pekare till funktion fr att slcka ansluten utenhet. */
    bool enabled_ = true;                    /* Enable-signal fr kontroll av PWM-generering. */
+   uint8_t steps_ = 10;                     /* Antalet steg per period vid styrning via update. */
+   uint8_t step_ = 0;                       /* Aktuellt steg inom perioden. */
+   uint8_t on_steps_ = 0;                   /* Antalet steg som utenheten r aktiverad under perioden. */
 
 public:
    /********************************************************************************
@@ -133,6 +146,7 @@ public:
    void enable(void)
    {
       this->enabled_ = true;
+      this->step_ = 0;
       return;
    }
 
@@ -180,6 +194,51 @@ public:
       return;
    }
 
+   /********************************************************************************
+   * steps: Returnerar antalet steg per period vid styrning via update.
+   ********************************************************************************/
+   uint8_t steps(void) const
+   {
+      return this->steps_;
+   }
+
+   /********************************************************************************
+   * set_steps: Stter antalet steg per period vid styrning via update, vilket
+   *            ven utgr antalet ljusniver minus ett. Perioden startas om.
+   *
+   *            - steps: Antalet steg per period, minst 1.
+   ********************************************************************************/
+   void set_steps(const uint8_t steps)
+   {
+      if (!steps) return;
+      this->steps_ = steps;
+      this->step_ = 0;
+      return;
+   }
+
+   /********************************************************************************
+   * update: Utfr ett steg av PWM-styrningen utan att blockera, frutsatt att
+   *         PWM-kontrollern r aktiverad. Vid periodens brjan lses ansluten
+   *         analog insignal av och antalet steg som utenheten ska vara
+   *         aktiverad berknas, varefter utenheten aktiveras. Nr detta antal
+   *         steg har passerat inaktiveras utenheten. Anropas periodiskt, dr
+   *         periodtiden fr PWM blir anropsintervallet gnger antalet steg.
+   ********************************************************************************/
+   void update(void)
+   {
+      if (!this->enabled_) return;
+
+      if (this->step_ == 0)
+      {
+         this->on_steps_ = this->input_.duty_steps(this->steps_);
+         if (this->on_steps_) (this->output_->*this->output_high_)();
+      }
+
+      if (this->step_ == this->on_steps_) (this->output_->*this->output_low_)();
+      if (++this->step_ >= this->steps_) this->step_ = 0;
+      return;
+   }
+
    /********************************************************************************
    * run_with_duty_cycle: Kr angiven PWM-kontroller under en period och styr
    *                      ansluten utenhet med angiven duty cycle, frutsatt att
@@ -0,0 +1,152 @@
+/********************************************************************************
+* queue.hpp: Implementering av lsfria ker med fast kapacitet via klassen
+*            queue, avsedda fr verfring av data frn avbrottsrutiner till
+*            huvudprogrammet (eller omvnt).
+*
+*            Kn r en ringbuffert dr producenten endast skriver till head
+*            och konsumenten endast skriver till tail. Bda indexen r en byte
+*            stora och skrivs drmed odelbart av processorn, vilket innebr
+*            att varken producent eller konsument behver inaktivera avbrott
+*            s lnge det finns en producent och en konsument (SPSC).
+*
+*            Multipla avbrottsrutiner kan ocks skriva till samma k utan
+*            ls, eftersom avbrottsrutiner p ATmega328P inte avbryter
+*            varandra (flaggan I i SREG r nollstlld under avbrottsrutinen).
+*            Om en producent kan avbrytas av en annan producent, exempelvis
+*            om bde huvudprogrammet och en avbrottsrutin skriver, ska
+*            push_shared anvndas, vilket skyddar reservationen av platsen
+*            med en kritisk sektion.
+********************************************************************************/
+#ifndef QUEUE_HPP_
+#define QUEUE_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "atomic.hpp"
+
+/********************************************************************************
+* queue: Generisk klass fr lsfria ker med fast kapacitet. Antalet platser
+*        N mste vara en tvpotens mellan 2 - 128, vilket gr att indexen kan
+*        rknas om med en bitmask. En plats hlls alltid tom fr att skilja
+*        en full k frn en tom, vilket ger en kapacitet p N - 1 element.
+********************************************************************************/
+template<class T, uint8_t N>
+class queue
+{
+private:
+   static_assert(N >= 2 && N <= 128 && !(N & (N - 1)), "Queue size must be a power of two between 2 and 128!");
+
+   T data_[N];                /* Flt innehllande lagrade element. */
+   volatile uint8_t head_ = 0; /* Index fr nsta skrivning (skrivs endast av producenten). */
+   volatile uint8_t tail_ = 0; /* Index fr nsta lsning (skrivs endast av konsumenten). */
+
+public:
+
+   /********************************************************************************
+   * queue: Defaultkonstruktor, initierar tom k.
+   ********************************************************************************/
+   queue(void) { }
+
+   /********************************************************************************
+   * queue: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   queue(queue&) = delete;
+
+   /********************************************************************************
+   * queue: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   queue& operator= (queue&) = delete;
+
+   /********************************************************************************
+   * capacity: Returnerar maximalt antal element som kan lagras i kn.
+   ********************************************************************************/
+   static constexpr uint8_t capacity(void)
+   {
+      return N - 1;
+   }
+
+   /********************************************************************************
+   * size: Returnerar antalet element lagrade i kn.
+   ********************************************************************************/
+   uint8_t size(void) const
+   {
+      return static_cast<uint8_t>(this->head_ - this->tail_) & (N - 1);
+   }
+
+   /********************************************************************************
+   * empty: Indikerar ifall kn r tom.
+   ********************************************************************************/
+   bool empty(void) const
+   {
+      return this->head_ == this->tail_;
+   }
+
+   /********************************************************************************
+   * full: Indikerar ifall kn r full.
+   ********************************************************************************/
+   bool full(void) const
+   {
+      return ((this->head_ + 1) & (N - 1)) == this->tail_;
+   }
+
+   /********************************************************************************
+   * clear: Tmmer kn. Fr endast anropas av konsumenten.
+   ********************************************************************************/
+   void clear(void)
+   {
+      this->tail_ = this->head_;
+      return;
+   }
+
+   /********************************************************************************
+   * push: Lgger till angivet element sist i kn. Om kn r full returneras
+   *       false, annars true. Elementet skrivs innan head uppdateras, s att
+   *       konsumenten aldrig kan lsa ett halvskrivet element.
+   *
+   *       - item: Referens till elementet som ska lggas till.
+   ********************************************************************************/
+   bool push(const T& item)
+   {
+      const uint8_t head = this->head_;
+      const uint8_t next = (head + 1) & (N - 1);
+      if (next == this->tail_) return false;
+
+      this->data_[head] = item;
+      memory_barrier();
+      this->head_ = next;
+      return true;
+   }
+
+   /********************************************************************************
+   * push_shared: Lgger till angivet element sist i kn, dr skrivningen sker
+   *              i en kritisk sektion. Anvnds nr producenten kan avbrytas av
+   *              en annan producent. Om kn r full returneras false.
+   *
+   *              - item: Referens till elementet som ska lggas till.
+   ********************************************************************************/
+   bool push_shared(const T& item)
+   {
+      critical_section lock;
+      return this->push(item);
+   }
+
+   /********************************************************************************
+   * pop: Lser och tar bort frsta elementet i kn. Om kn r tom returneras
+   *      false, annars true. Elementet kopieras innan tail uppdateras, s att
+   *      producenten aldrig kan skriva ver ett element som hller p att lsas.
+   *
+   *      - item: Referens till variabel dr elementet lagras.
+   ********************************************************************************/
+   bool pop(T& item)
+   {
+      const uint8_t tail = this->tail_;
+      if (tail == this->head_) return false;
+
+      item = this->data_[tail];
+      memory_barrier();
+      this->tail_ = (tail + 1) & (N - 1);
+      return true;
+   }
+};
+
+#endif /* QUEUE_HPP_ */
\ No newline at end of file
@@ -0,0 +1,147 @@
+/********************************************************************************
+* scheduler.cpp: Innehller kooperativ schemalggare fr huvudloopen.
+********************************************************************************/
+#include "scheduler.hpp"
+#include "serial.hpp"
+
+/* Statiska variabler: */
+static scheduler::task* tasks[scheduler::MAX_TASKS]; /* Tillagda tasks sorterade efter prioritet. */
+static uint8_t num_tasks = 0;                        /* Antalet tillagda tasks. */
+
+/********************************************************************************
+* add: Lgger till angiven task i schemalggaren, sorterad efter prioritet.
+*      Tasks med hgre prioritet flyttas inte, vriga flyttas ett steg bakt
+*      fr att ge plats t den nya tasken. Om schemalggaren redan innehller
+*      MAX_TASKS tasks returneras false.
+*
+*      - task: Referens till tasken som ska lggas till.
+********************************************************************************/
+bool scheduler::add(task& task)
+{
+   if (num_tasks >= MAX_TASKS) return false;
+   auto i = num_tasks;
+
+   while (i > 0 && tasks[i - 1]->priority() < task.priority())
+   {
+      tasks[i] = tasks[i - 1];
+      i--;
+   }
+
+   tasks[i] = &task;
+   num_tasks++;
+   return true;
+}
+
+/********************************************************************************
+* start: Stter en gemensam starttid fr samtliga tillagda tasks, relativt
+*        vilken respektive tasks fasfrskjutning rknas, samt nollstller
+*        lagrade mtvrden.
+********************************************************************************/
+void scheduler::start(void)
+{
+   const auto epoch = power::now();
+
+   for (uint8_t i = 0; i < num_tasks; ++i)
+   {
+      tasks[i]->start(epoch);
+      tasks[i]->reset_stats();
+   }
+   return;
+}
+
+/********************************************************************************
+* run: Hanterar nsta vntande hndelse, alternativt kr den task med hgst
+*      prioritet som r redo. Eftersom tasks lagras sorterade efter prioritet
+*      krs den frsta tasken som r redo. Om varken hndelse eller task r
+*      redo frstts processorn i vila tills nsta task slpps eller ett
+*      avbrott ger rum.
+*
+*      Hndelsekn kontrolleras en sista gng med avbrott inaktiverade.
+*      Vilofunktionerna i power.hpp aktiverar avbrott frst i samband med
+*      instruktionen SLEEP, s en hndelse som postas efter kontrollen
+*      vcker processorn direkt i stllet fr att bli liggande i kn.
+********************************************************************************/
+void scheduler::run(void)
+{
+   if (events::dispatch()) return;
+
+   const auto now = power::now();
+   uint32_t release = 0;
+
+   for (uint8_t i = 0; i < num_tasks; ++i)
+   {
+      if (tasks[i]->ready(now))
+      {
+         tasks[i]->run(now);
+         return;
+      }
+   }
+
+   const auto timed = scheduler::next_release(release);
+   asm("CLI");
+
+   if (events::pending())
+   {
+      asm("SEI");
+   }
+   else if (timed)
+   {
+      power::sleep_until(release);
+   }
+   else
+   {
+      power::sleep();
+   }
+   return;
+}
+
+/********************************************************************************
+* next_release: Returnerar tidpunkten fr nrmast frestende slpp bland
+*               aktiverade tasks mtt i ticks. Om ingen task r aktiverad
+*               returneras false, annars true.
+*
+*               - release: Referens till variabel dr tidpunkten lagras.
+********************************************************************************/
+bool scheduler::next_release(uint32_t& release)
+{
+   const auto now = power::now();
+   auto found = false;
+
+   for (uint8_t i = 0; i < num_tasks; ++i)
+   {
+      if (!tasks[i]->enabled()) continue;
+
+      if (!found || static_cast<int32_t>(tasks[i]->release() - now) < static_cast<int32_t>(release - now))
+      {
+         release = tasks[i]->release();
+         found = true;
+      }
+   }
+   return found;
+}
+
+/********************************************************************************
+* print_stats: Skriver ut antalet krningar, lngsta exekveringstid samt
+*              antalet overruns fr respektive task via seriell verfring.
+*              Exekveringstiden skrivs ut i mikrosekunder.
+********************************************************************************/
+void scheduler::print_stats(void)
+{
+   for (uint8_t i = 0; i < num_tasks; ++i)
+   {
+      const auto& stats = tasks[i]->get_stats();
+
+      serial::print("Task ");
+      serial::print_unsigned(i);
+      serial::print(" (priority ");
+      serial::print_unsigned(tasks[i]->priority());
+      serial::print("): ");
+      serial::print_unsigned(stats.runs);
+      serial::print(" runs, WCET ");
+      serial::print_unsigned(static_cast<uint32_t>(stats.wcet_ticks * power::TICK_US));
+      serial::print(" us, ");
+      serial::print_unsigned(stats.overruns);
+      serial::print(" overruns\n");
+   }
+   return;
+}
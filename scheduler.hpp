@@ -0,0 +1,298 @@
+/********************************************************************************
+* scheduler.hpp: Innehller en kooperativ schemalggare fr huvudloopen, dr
+*                statiskt deklarerade tasks krs periodiskt med angiven
+*                periodtid, fasfrskjutning samt prioritet. Varje task krs
+*                till slut (run-to-completion) och kan drmed inte avbrytas
+*                av en annan task, endast av avbrottsrutiner.
+*
+*                Tidsbasen i power.hpp (Timer 2) anvnds som tick, vilket
+*                innebr att power::init mste anropas innan schemalggaren
+*                startas. Nr ingen task r redo frstts processorn i vila
+*                fram till nsta task ska kras via power::sleep_until, s
+*                ingen periodisk tick-avbrottsrutin behvs.
+*
+*                Hndelser som postats av avbrottsrutiner via events.hpp
+*                hanteras fre tasks, en hndelse per anrop av scheduler::run.
+*
+*                Inget dynamiskt minne anvnds. Tasks deklareras som globala
+*                eller statiska objekt och lggs till i schemalggaren, som
+*                lagrar pekare till maximalt MAX_TASKS tasks sorterade efter
+*                prioritet. Fr varje task lagras antalet krningar, lngsta
+*                uppmtta exekveringstid (WCET) samt antalet missade perioder
+*                (overruns). Exekveringstiden mts med tidsbasens upplsning,
+*                dvs. 64 us.
+*
+*                Exempel:
+*
+*                scheduler::task t1(&sample_sensor, 100);
+*                scheduler::task t2(&print_log, 1000, 500, 1);
+*
+*                scheduler::add(t1);
+*                scheduler::add(t2);
+*                scheduler::start();
+*
+*                while (1) scheduler::run();
+********************************************************************************/
+#ifndef SCHEDULER_HPP_
+#define SCHEDULER_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "power.hpp"
+#include "events.hpp"
+
+/********************************************************************************
+* scheduler: Namnrymd innehllande kooperativ schemalggare.
+********************************************************************************/
+namespace scheduler
+{
+   static constexpr uint8_t MAX_TASKS = 8; /* Maximalt antal tasks i schemalggaren. */
+
+   /********************************************************************************
+   * stats: Strukt fr lagring av mtvrden fr en given task.
+   ********************************************************************************/
+   struct stats
+   {
+      uint32_t runs = 0;       /* Antalet genomfrda krningar. */
+      uint32_t wcet_ticks = 0; /* Lngsta uppmtta exekveringstid mtt i ticks. */
+      uint32_t overruns = 0;   /* Antalet perioder som har missats helt. */
+   };
+
+   /********************************************************************************
+   * task: Klass fr periodiska tasks. En task slpps (blir redo att kras) en
+   *       gng per period. Om en task inte hinner kras innan nsta slpp
+   *       rknas en overrun fr varje missad period, varefter missade slpp
+   *       hoppas ver s att tasken inte krs flera gnger i fljd fr att
+   *       komma ikapp.
+   ********************************************************************************/
+   class task
+   {
+   private:
+      void (*function_)(void) = nullptr; /* Pekare till funktionen som utgr tasken. */
+      uint32_t period_ = 0;              /* Periodtid mtt i ticks. */
+      uint32_t phase_ = 0;               /* Fasfrskjutning relativt starttiden mtt i ticks. */
+      uint32_t release_ = 0;             /* Tidpunkt fr nsta slpp mtt i ticks. */
+      uint8_t priority_ = 0;             /* Prioritet, dr hgre vrde ger hgre prioritet. */
+      bool enabled_ = true;              /* Indikerar ifall tasken r aktiverad. */
+      struct stats stats_;               /* Mtvrden fr tasken. */
+
+   public:
+
+      /********************************************************************************
+      * task: Defaultkonstruktor, initierar tomt objekt.
+      ********************************************************************************/
+      task(void) { }
+
+      /********************************************************************************
+      * task: Initierar ny task med angiven funktion, periodtid, fasfrskjutning
+      *       samt prioritet.
+      *
+      *       - function : Pekare till funktionen som ska kras periodiskt.
+      *       - period_ms: Periodtid mtt i millisekunder.
+      *       - phase_ms : Frdrjning av frsta krningen relativt starttiden
+      *                    mtt i millisekunder (default = 0).
+      *       - priority : Prioritet, dr hgre vrde ger hgre prioritet
+      *                    (default = 0).
+      ********************************************************************************/
+      task(void (*function)(void),
+           const uint32_t period_ms,
+           const uint32_t phase_ms = 0,
+           const uint8_t priority = 0)
+      {
+         this->init(function, period_ms, phase_ms, priority);
+         return;
+      }
+
+      /********************************************************************************
+      * task: Kopieringskonstruktor raderad.
+      ********************************************************************************/
+      task(task&) = delete;
+
+      /********************************************************************************
+      * task: Tilldelningsoperator raderad.
+      ********************************************************************************/
+      task& operator= (task&) = delete;
+
+      /********************************************************************************
+      * init: Initierar task med angiven funktion, periodtid, fasfrskjutning
+      *       samt prioritet. Periodtiden avrundas uppt till minst en tick.
+      *
+      *       - function : Pekare till funktionen som ska kras periodiskt.
+      *       - period_ms: Periodtid mtt i millisekunder.
+      *       - phase_ms : Frdrjning av frsta krningen relativt starttiden
+      *                    mtt i millisekunder (default = 0).
+      *       - priority : Prioritet, dr hgre vrde ger hgre prioritet
+      *                    (default = 0).
+      ********************************************************************************/
+      void init(void (*function)(void),
+                const uint32_t period_ms,
+                const uint32_t phase_ms = 0,
+                const uint8_t priority = 0)
+      {
+         this->function_ = function;
+         this->period_ = power::ms_to_ticks(period_ms);
+         this->phase_ = power::ms_to_ticks(phase_ms);
+         this->priority_ = priority;
+         this->enabled_ = true;
+         if (!this->period_) this->period_ = 1;
+         this->reset_stats();
+         return;
+      }
+
+      /********************************************************************************
+      * priority: Returnerar taskens prioritet.
+      ********************************************************************************/
+      uint8_t priority(void) const
+      {
+         return this->priority_;
+      }
+
+      /********************************************************************************
+      * release: Returnerar tidpunkten fr taskens nsta slpp mtt i ticks.
+      ********************************************************************************/
+      uint32_t release(void) const
+      {
+         return this->release_;
+      }
+
+      /********************************************************************************
+      * enabled: Indikerar ifall tasken r aktiverad.
+      ********************************************************************************/
+      bool enabled(void) const
+      {
+         return this->enabled_;
+      }
+
+      /********************************************************************************
+      * get_stats: Returnerar lagrade mtvrden fr tasken.
+      ********************************************************************************/
+      const struct stats& get_stats(void) const
+      {
+         return this->stats_;
+      }
+
+      /********************************************************************************
+      * enable: Aktiverar tasken, som slpps direkt vid nsta anrop av
+      *         scheduler::run och drefter en gng per period.
+      ********************************************************************************/
+      void enable(void)
+      {
+         if (!this->enabled_) this->release_ = power::now();
+         this->enabled_ = true;
+         return;
+      }
+
+      /********************************************************************************
+      * disable: Inaktiverar tasken, som d inte krs frrn den teraktiveras.
+      ********************************************************************************/
+      void disable(void)
+      {
+         this->enabled_ = false;
+         return;
+      }
+
+      /********************************************************************************
+      * reset_stats: Nollstller lagrade mtvrden fr tasken.
+      ********************************************************************************/
+      void reset_stats(void)
+      {
+         this->stats_.runs = 0;
+         this->stats_.wcet_ticks = 0;
+         this->stats_.overruns = 0;
+         return;
+      }
+
+      /********************************************************************************
+      * start: Stter taskens frsta slpp till angiven starttid plus taskens
+      *        fasfrskjutning.
+      *
+      *        - epoch: Gemensam starttid fr samtliga tasks mtt i ticks.
+      ********************************************************************************/
+      void start(const uint32_t epoch)
+      {
+         this->release_ = epoch + this->phase_;
+         return;
+      }
+
+      /********************************************************************************
+      * ready: Indikerar ifall tasken r aktiverad och har slppts.
+      *
+      *        - now: Aktuell tid mtt i ticks.
+      ********************************************************************************/
+      bool ready(const uint32_t now) const
+      {
+         return this->enabled_ && static_cast<int32_t>(now - this->release_) >= 0;
+      }
+
+      /********************************************************************************
+      * run: Kr tasken till slut och uppdaterar taskens mtvrden. Om en eller
+      *      flera hela perioder har passerat sedan slppet rknas dessa som
+      *      overruns och hoppas ver. Nsta slpp stts en period efter
+      *      aktuellt slpp, s att perioden inte driver p grund av jitter.
+      *
+      *      - now: Aktuell tid mtt i ticks.
+      ********************************************************************************/
+      void run(const uint32_t now)
+      {
+         const auto lateness = now - this->release_;
+
+         if (lateness >= this->period_)
+         {
+            const auto missed = lateness / this->period_;
+            this->stats_.overruns += missed;
+            this->release_ += missed * this->period_;
+         }
+
+         this->release_ += this->period_;
+
+         const auto start = power::now();
+         this->function_();
+         const auto execution_time = power::now() - start;
+
+         if (execution_time > this->stats_.wcet_ticks) this->stats_.wcet_ticks = execution_time;
+         this->stats_.runs++;
+         return;
+      }
+   };
+
+   /********************************************************************************
+   * add: Lgger till angiven task i schemalggaren, sorterad efter prioritet.
+   *      Tasks med samma prioritet krs i den ordning de lades till. Om
+   *      schemalggaren redan innehller MAX_TASKS tasks returneras false.
+   *
+   *      - task: Referens till tasken som ska lggas till.
+   ********************************************************************************/
+   bool add(task& task);
+
+   /********************************************************************************
+   * start: Stter en gemensam starttid fr samtliga tillagda tasks, relativt
+   *        vilken respektive tasks fasfrskjutning rknas, samt nollstller
+   *        lagrade mtvrden.
+   ********************************************************************************/
+   void start(void);
+
+   /********************************************************************************
+   * run: Hanterar nsta vntande hndelse, alternativt kr den task med hgst
+   *      prioritet som r redo. Om varken hndelse eller task r redo frstts
+   *      processorn i vila tills nsta task slpps eller ett avbrott ger rum.
+   *      Anropas kontinuerligt frn huvudloopen.
+   ********************************************************************************/
+   void run(void);
+
+   /********************************************************************************
+   * next_release: Returnerar tidpunkten fr nrmast frestende slpp bland
+   *               aktiverade tasks mtt i ticks. Om ingen task r aktiverad
+   *               returneras false, annars true.
+   *
+   *               - release: Referens till variabel dr tidpunkten lagras.
+   ********************************************************************************/
+   bool next_release(uint32_t& release);
+
+   /********************************************************************************
+   * print_stats: Skriver ut antalet krningar, lngsta exekveringstid samt
+   *              antalet overruns fr respektive task via seriell verfring.
+   ********************************************************************************/
+   void print_stats(void);
+}
+
+#endif /* SCHEDULER_HPP_ */
@@ -0,0 +1,80 @@
+/********************************************************************************
+* sequencer.cpp: Innehller frdefinierade ljusmnster lagrade som bytekod i
+*                programminnet.
+********************************************************************************/
+#include "sequencer.hpp"
+
+/* Lngden p en punkt i morsekod (150 ms): */
+#define MORSE_UNIT 15
+
+/********************************************************************************
+* blink_slow: Blinkning med 1 Hz.
+********************************************************************************/
+const uint8_t sequence::blink_slow[] PROGMEM =
+{
+   set, 0xFF, wait, 50,
+   set, 0x00, wait, 50,
+   restart
+};
+
+/********************************************************************************
+* blink_fast: Blinkning med 5 Hz.
+********************************************************************************/
+const uint8_t sequence::blink_fast[] PROGMEM =
+{
+   set, 0xFF, wait, 10,
+   set, 0x00, wait, 10,
+   restart
+};
+
+/********************************************************************************
+* heartbeat: Tv korta blinkningar fljt av paus, totalt en sekund.
+********************************************************************************/
+const uint8_t sequence::heartbeat[] PROGMEM =
+{
+   repeat, 2,
+   set, 0xFF, wait, 8,
+   set, 0x00, wait, 12,
+   next,
+   wait, 60,
+   restart
+};
+
+/********************************************************************************
+* chase: Lpljus fram och tillbaka ver lysdiod 0 - 2 i en vektor.
+********************************************************************************/
+const uint8_t sequence::chase[] PROGMEM =
+{
+   set, 0x01, wait, 15,
+   set, 0x02, wait, 15,
+   set, 0x04, wait, 15,
+   set, 0x02, wait, 15,
+   restart
+};
+
+/********************************************************************************
+* breathe: Ljusstyrkan kar stegvis till full styrka och minskar sedan.
+********************************************************************************/
+const uint8_t sequence::breathe[] PROGMEM =
+{
+   set, 0xFF,
+   level, 0, wait, 10, level, 1, wait, 6, level, 2, wait, 6, level, 3, wait, 6,
+   level, 4, wait, 6, level, 5, wait, 6, level, 6, wait, 6, level, 7, wait, 6,
+   level, 8, wait, 20, level, 7, wait, 6, level, 6, wait, 6, level, 5, wait, 6,
+   level, 4, wait, 6, level, 3, wait, 6, level, 2, wait, 6, level, 1, wait, 6,
+   restart
+};
+
+/********************************************************************************
+* sos: SOS i morsekod (... --- ...), fljt av tv sekunders paus.
+********************************************************************************/
+const uint8_t sequence::sos[] PROGMEM =
+{
+   repeat, 3, SEQUENCE_DOT(MORSE_UNIT), next,
+   wait, 2 * MORSE_UNIT,
+   repeat, 3, SEQUENCE_DASH(MORSE_UNIT), next,
+   wait, 2 * MORSE_UNIT,
+   repeat, 3, SEQUENCE_DOT(MORSE_UNIT), next,
+   wait, 200,
+   restart
+};
\ No newline at end of file
@@ -0,0 +1,270 @@
+/********************************************************************************
+* sequencer.hpp: Innehller en icke-blockerande sekvenserare fr ljusmnster
+*                via klassen sequencer, exempelvis blinkkoder, lpljus,
+*                andning (breathe) samt statuskoder i morsekod.
+*
+*                Mnster lagras som kompakt bytekod i programminnet (flash)
+*                och exekveras steg fr steg vid varje anrop av update, som
+*                sker periodiskt var millisekund frn en timer eller en task.
+*                Varje anrop utfr endast instruktionerna fram till nsta
+*                vntan, s statusindikering blockerar aldrig huvudloopen.
+*                Ett godtyckligt antal sekvenserare kan kras samtidigt,
+*                en per lysdiod eller vektor med lysdioder, exempelvis:
+*
+*                sequencer<led> s1(l1);
+*                sequencer<led_vector> s2(v1);
+*                scheduler::task status_task([]() { s1.update(); s2.update(); }, 1);
+*
+*                Bytekoden bestr av en instruktion fljd av eventuell
+*                operand, se namnrymden sequence. Vntan anges i enheter om
+*                10 ms (max 2,55 s per instruktion). Ljusstyrka 1 - 7 stad-
+*                kommes via mjukvaru-PWM med en periodtid p 8 ms, dr
+*                lysdioderna endast skrivs nr utsignalen ndras.
+********************************************************************************/
+#ifndef SEQUENCER_HPP_
+#define SEQUENCER_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include <avr/pgmspace.h>
+
+/********************************************************************************
+* sequence: Namnrymd innehllande instruktioner samt frdefinierade mnster.
+********************************************************************************/
+namespace sequence
+{
+   static constexpr uint8_t UNIT_MS = 10;   /* Tid per enhet vid vntan mtt i millisekunder. */
+   static constexpr uint8_t MAX_LEVEL = 8;  /* Full ljusstyrka. */
+
+   /********************************************************************************
+   * opcode: Enumeration fr instruktioner i bytekoden.
+   ********************************************************************************/
+   enum opcode : uint8_t
+   {
+      end,     /* Avslutar mnstret och slcker lysdioderna. */
+      set,     /* set, mnster: Tnder lysdiod n fr bit n i mnstret, slcker vriga. */
+      level,   /* level, 0 - 8: Stter ljusstyrkan fr tnda lysdioder. */
+      wait,    /* wait, enheter: Vntar angivet antal enheter om 10 ms. */
+      toggle,  /* Inverterar aktuellt mnster. */
+      repeat,  /* repeat, antal: Markerar brjan p en slinga som krs angivet antal gnger. */
+      next,    /* Markerar slutet p slingan (en niv, ingen nstling). */
+      restart  /* Startar om mnstret frn brjan. */
+   };
+
+   /* Frdefinierade mnster lagrade i programminnet: */
+   extern const uint8_t blink_slow[] PROGMEM; /* Blinkning med 1 Hz. */
+   extern const uint8_t blink_fast[] PROGMEM; /* Blinkning med 5 Hz. */
+   extern const uint8_t heartbeat[] PROGMEM;  /* Tv korta blinkningar per sekund. */
+   extern const uint8_t chase[] PROGMEM;      /* Lpljus fram och tillbaka ver tre lysdioder. */
+   extern const uint8_t breathe[] PROGMEM;    /* Ljusstyrkan kar och minskar mjukt. */
+   extern const uint8_t sos[] PROGMEM;        /* SOS i morsekod, fljt av tv sekunders paus. */
+}
+
+/********************************************************************************
+* SEQUENCE_DOT: Makro fr en punkt i morsekod, dr en enhet anges i 10 ms.
+*
+*               - unit: Lngden p en punkt i enheter om 10 ms.
+********************************************************************************/
+#define SEQUENCE_DOT(unit) sequence::set, 0xFF, sequence::wait, (unit), \
+                           sequence::set, 0x00, sequence::wait, (unit)
+
+/********************************************************************************
+* SEQUENCE_DASH: Makro fr ett streck i morsekod (tre enheter lngt).
+*
+*                - unit: Lngden p en punkt i enheter om 10 ms.
+********************************************************************************/
+#define SEQUENCE_DASH(unit) sequence::set, 0xFF, sequence::wait, 3 * (unit), \
+                            sequence::set, 0x00, sequence::wait, (unit)
+
+/********************************************************************************
+* sequencer: Generisk klass fr exekvering av ljusmnster p en utenhet av
+*            typen T, exempelvis led eller led_vector. Utenheten mste ha en
+*            medlemsfunktion write, som tar emot aktuellt mnster.
+********************************************************************************/
+template<class T>
+class sequencer
+{
+private:
+   T* target_ = nullptr;                 /* Pekare till ansluten utenhet. */
+   const uint8_t* program_ = nullptr;    /* Pekare till aktuellt mnster i programminnet. */
+   uint16_t countdown_ = 0;              /* terstende ticks av pgende vntan. */
+   uint8_t pc_ = 0;                      /* Index fr nsta instruktion. */
+   uint8_t pattern_ = 0;                 /* Aktuellt mnster. */
+   uint8_t level_ = sequence::MAX_LEVEL; /* Aktuell ljusstyrka, 0 - 8. */
+   uint8_t phase_ = 0;                   /* Fas fr mjukvaru-PWM, 0 - 7. */
+   uint8_t output_ = 0;                  /* Senast skrivet mnster. */
+   uint8_t loop_pc_ = 0;                 /* Index fr frsta instruktionen i slingan. */
+   uint8_t loop_count_ = 0;              /* terstende varv i slingan. */
+
+   /********************************************************************************
+   * fetch: Lser nsta byte i mnstret frn programminnet.
+   ********************************************************************************/
+   uint8_t fetch(void)
+   {
+      return pgm_read_byte(this->program_ + this->pc_++);
+   }
+
+   /********************************************************************************
+   * write: Skriver angivet mnster till utenheten, frutsatt att det skiljer
+   *        sig frn senast skrivet mnster.
+   *
+   *        - output: Mnstret som ska skrivas.
+   ********************************************************************************/
+   void write(const uint8_t output)
+   {
+      if (output == this->output_) return;
+      this->output_ = output;
+      this->target_->write(output);
+      return;
+   }
+
+   /********************************************************************************
+   * execute: Exekverar instruktioner fram till nsta vntan eller slutet p
+   *          mnstret. Antalet instruktioner per anrop begrnsas, s att ett
+   *          mnster utan vntan inte kan lsa anroparen.
+   ********************************************************************************/
+   void execute(void)
+   {
+      for (uint8_t i = 0; i < 32 && this->program_; ++i)
+      {
+         switch (this->fetch())
+         {
+            case sequence::set:
+               this->pattern_ = this->fetch();
+               break;
+            case sequence::level:
+               this->level_ = this->fetch();
+               if (this->level_ > sequence::MAX_LEVEL) this->level_ = sequence::MAX_LEVEL;
+               break;
+            case sequence::wait:
+               this->countdown_ = static_cast<uint16_t>(this->fetch()) * sequence::UNIT_MS;
+               if (this->countdown_) return;
+               break;
+            case sequence::toggle:
+               this->pattern_ = ~this->pattern_;
+               break;
+            case sequence::repeat:
+               this->loop_count_ = this->fetch();
+               this->loop_pc_ = this->pc_;
+               break;
+            case sequence::next:
+               if (this->loop_count_ > 1)
+               {
+                  this->loop_count_--;
+                  this->pc_ = this->loop_pc_;
+               }
+               break;
+            case sequence::restart:
+               this->pc_ = 0;
+               break;
+            case sequence::end:
+            default:
+               this->stop();
+               return;
+         }
+      }
+      return;
+   }
+
+public:
+
+   /********************************************************************************
+   * sequencer: Defaultkonstruktor, initierar tomt objekt.
+   ********************************************************************************/
+   sequencer(void) { }
+
+   /********************************************************************************
+   * sequencer: Initierar sekvenserare fr angiven utenhet.
+   *
+   *            - target: Referens till utenheten, exempelvis en lysdiod.
+   ********************************************************************************/
+   sequencer(T& target)
+   {
+      this->init(target);
+      return;
+   }
+
+   /********************************************************************************
+   * sequencer: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   sequencer(sequencer&) = delete;
+
+   /********************************************************************************
+   * sequencer: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   sequencer& operator= (sequencer&) = delete;
+
+   /********************************************************************************
+   * init: Initierar sekvenserare fr angiven utenhet.
+   *
+   *       - target: Referens till utenheten, exempelvis en lysdiod.
+   ********************************************************************************/
+   void init(T& target)
+   {
+      this->target_ = &target;
+      this->program_ = nullptr;
+      return;
+   }
+
+   /********************************************************************************
+   * running: Indikerar ifall ett mnster exekveras.
+   ********************************************************************************/
+   bool running(void) const
+   {
+      return this->program_ != nullptr;
+   }
+
+   /********************************************************************************
+   * start: Startar angivet mnster frn brjan, vilket erstter eventuellt
+   *        pgende mnster.
+   *
+   *        - program: Pekare till mnstret i programminnet, exempelvis
+   *                   sequence::heartbeat.
+   ********************************************************************************/
+   void start(const uint8_t* program)
+   {
+      if (!this->target_) return;
+      this->program_ = program;
+      this->pc_ = 0;
+      this->countdown_ = 0;
+      this->pattern_ = 0;
+      this->level_ = sequence::MAX_LEVEL;
+      this->loop_count_ = 0;
+      this->output_ = 0xFF;
+      this->write(0);
+      return;
+   }
+
+   /********************************************************************************
+   * stop: Avbryter pgende mnster och slcker utenheten.
+   ********************************************************************************/
+   void stop(void)
+   {
+      if (!this->program_) return;
+      this->program_ = nullptr;
+      this->write(0);
+      return;
+   }
+
+   /********************************************************************************
+   * update: Genomfr en tick, vilket sker var millisekund. Pgende vntan
+   *         rknas ned och drefter exekveras nsta instruktioner, fljt av
+   *         att utsignalen uppdateras utifrn aktuellt mnster och ljusstyrka.
+   ********************************************************************************/
+   void update(void)
+   {
+      if (!this->program_) return;
+
+      if (!this->countdown_ || --this->countdown_ == 0)
+      {
+         this->execute();
+      }
+
+      if (!this->program_) return;
+      this->phase_ = (this->phase_ + 1) & (sequence::MAX_LEVEL - 1);
+      this->write(this->phase_ < this->level_ ? this->pattern_ : 0);
+      return;
+   }
+};
+
+#endif /* SEQUENCER_HPP_ */
\ No newline at end of file
@@ -2,6 +2,7 @@
 * serial.cpp: Innehller drivrutiner fr seriell verfring via USART.
 ********************************************************************************/
 #include "serial.hpp"
+#include "format.hpp"
 
 /********************************************************************************
 * init: Initierar USART fr seriell verfring med angiven baud rate.
@@ -56,8 +57,8 @@ void serial::print(const char* s)
 ********************************************************************************/
 void serial::print(const int32_t number)
 {
-   char s[20] = { '\0' };
-   sprintf(s, "%ld", number);
+   char s[format::BUFFER_SIZE];
+   format::to_string(number, s);
    serial::print(s);
    return;
 }
@@ -69,45 +70,40 @@ void serial::print(const int32_t number)
 ********************************************************************************/
 void serial::print_unsigned(const uint32_t number)
 {
-   char s[20] = { '\0' };
-   sprintf(s, "%ld", number);
+   char s[format::BUFFER_SIZE];
+   format::to_string(number, s);
    serial::print(s);
    return;
 }
 
 /********************************************************************************
-* print: Skriver ut ett flyttal via seriell verfring.
+* print: Skriver ut ett flyttal via seriell verfring med tv decimaler.
+*        Flyttalet avrundas till hundradelar och skrivs ut som ett fixtal.
 *
 *        - number: Flyttalet som ska skrivas ut.
 ********************************************************************************/
 void serial::print(const double number)
 {
-   const auto integer = static_cast<int32_t>(number);
-   int32_t decimal = 0;
-   char s[20] = { '\0' };
-      
-   if (integer >= 0)
-   {
-      decimal = static_cast<int32_t>((number - integer) * 100 + 0.5);
-   }
-   else
-   {
-      decimal = static_cast<int32_t>((integer - number) * 100 + 0.5);
-   }
-
-   sprintf(s, "%ld.%ld", integer, decimal);
+   const auto hundredths = static_cast<int32_t>(number * 100 + (number >= 0 ? 0.5 : -0.5));
+   char s[format::BUFFER_SIZE];
+   format::to_string(hundredths, 2, s);
    serial::print(s);
    return;
 }
 
 /********************************************************************************
-* print: Skriver ut ett enskilt tecken via seriell verfring.
+* print: Skriver ut ett enskilt tecken via seriell verfring. Flaggan TXC0
+*        nollstlls innan tecknet skrivs, s att den indikerar nr hela
+*        verfringen r slutfrd (anvnds vid val av sleep mode). Endast
+*        konfigurationsbitarna U2X0 och MPCM0 skrivs tillbaka, eftersom
+*        statusbitarna FE0, DOR0 och UPE0 alltid ska skrivas till noll.
 *
 *        - character: Det tecken som ska skrivas ut.
 ********************************************************************************/
 void serial::print(const char character)
 {
    while ((UCSR0A & (1 << UDRE0)) == 0);
+   UCSR0A = (UCSR0A & ((1 << U2X0) | (1 << MPCM0))) | (1 << TXC0);
    UDR0 = character;
    return;
 }
\ No newline at end of file
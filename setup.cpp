@@ -7,9 +7,13 @@
 led l1(8), l2(9), l3(10);
 led_vector v1;
 button b1(13);
-timer t0(timer::sel::timer0, 300);
-timer t1(timer::sel::timer1, 50);
+gesture g1(b1, 5, 1000);
+timer t1(timer::sel::timer1, 50);
 pwm<led_vector> pwm1(A0, &v1, &led_vector::on, &led_vector::off);
+scheduler::task pwm_task([]() { pwm1.update(); }, 1);
+scheduler::task button_task(&button_update, 5, 0, 1);
+sequencer<led> status(l2);
+scheduler::task status_task([]() { status.update(); }, 1);
 
 /********************************************************************************
 * setup: Initierar det inbyggda systemet.
@@ -20,7 +24,7 @@ void setup(void)
    const size_t num_leds = sizeof(leds) / sizeof(struct led*);
 
    v1.init(leds, num_leds);
-   b1.enable_interrupt();
+   debounce::add(b1);
 
    serial::init();
 
@@ -28,5 +32,15 @@ void setup(void)
    wdt::init(wdt::timeout::_8192_ms);
    wdt::enable_interrupt();
 
+   events::attach(EVENT_B1_PRESSED, &b1_pressed);
+   events::attach(EVENT_WDT_TIMEOUT, &wdt_timeout_handler);
+   events::attach(EVENT_B1_LONG_PRESS, &b1_long_pressed);
+
+   power::init();
+   scheduler::add(pwm_task);
+   scheduler::add(button_task);
+   scheduler::add(status_task);
+   status_task.disable();
+   scheduler::start();
    return;
 }
\ No newline at end of file
@@ -0,0 +1,36 @@
+/********************************************************************************
+* seven_segment.cpp: Innehller segmentmnster fr sjusegmentsdisplayer
+*                    lagrade i programminnet.
+********************************************************************************/
+#include "seven_segment.hpp"
+
+/********************************************************************************
+* font: Segmentmnster fr ASCII 0x20 - 0x5F, dr bit 0 - 6 motsvarar
+*       segment a - g. Bokstver som inte kan visas entydigt approximeras,
+*       exempelvis b, d, n, r och t som gemener. Tecken som saknar mnster
+*       visas som blanka.
+********************************************************************************/
+const uint8_t segment::font[64] PROGMEM =
+{
+   0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x00, 0x02, /* sp ! " # $ % & ' */
+   0x39, 0x0F, 0x63, 0x00, 0x00, 0x40, 0x00, 0x52, /* ( ) * + , - . / */
+   0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, /* 0 1 2 3 4 5 6 7 */
+   0x7F, 0x6F, 0x00, 0x00, 0x58, 0x48, 0x4C, 0x53, /* 8 9 : ; < = > ? */
+   0x00, 0x77, 0x7C, 0x39, 0x5E, 0x79, 0x71, 0x3D, /* @ A B C D E F G */
+   0x76, 0x30, 0x1E, 0x76, 0x38, 0x15, 0x54, 0x3F, /* H I J K L M N O */
+   0x73, 0x67, 0x50, 0x6D, 0x78, 0x3E, 0x1C, 0x2A, /* P Q R S T U V W */
+   0x76, 0x6E, 0x5B, 0x39, 0x64, 0x0F, 0x23, 0x08  /* X Y Z [ \ ] ^ _ */
+};
+
+/********************************************************************************
+* encode: Returnerar segmentmnstret fr angivet tecken. Gemener omvandlas
+*         till versaler innan tabellen lses.
+*
+*         - character: Tecknet som ska visas.
+********************************************************************************/
+uint8_t segment::encode(char character)
+{
+   if (character >= 'a' && character <= 'z') character -= 'a' - 'A';
+   if (character < 0x20 || character > 0x5F) return 0x00;
+   return pgm_read_byte(&segment::font[character - 0x20]);
+}
\ No newline at end of file
@@ -0,0 +1,540 @@
+/********************************************************************************
+* seven_segment.hpp: Innehller drivrutiner fr multiplexade sjusegments-
+*                    displayer med upp till tta siffror via klassen
+*                    seven_segment.
+*
+*                    Segmenten (a - g samt decimalpunkt) delas av samtliga
+*                    siffror, som tnds en i taget via respektive siffras
+*                    gemensamma pin. Multiplexeringen sker via tick, som
+*                    anropas periodiskt frn en timer, exempelvis var
+*                    0.128:e millisekund via ett timer-objekt p Timer 0
+*                    (Timer 2 anvnds av power och schemalggaren):
+*
+*                    seven_segment<4> display(segment_pins, 8, digit_pins);
+*                    timer t0(timer::sel::timer0, 0.128, []() { display.tick(); });
+*
+*                    Varje siffra visas under SLOT_TICKS (8) ticks, vilket med
+*                    ticks om 128 us ger 1.024 ms per siffra och en uppdaterings-
+*                    frekvens om ca 244 Hz fr fyra siffror, allts utan flimmer.
+*                    Ljusstyrkan 0 - 8 anger under hur mnga av dessa ticks
+*                    siffran r tnd. Segmentens portvrden berknas i frvg
+*                    nr en siffra skrivs, s att tick endast skriver tre
+*                    portar samt tv siffer-pinnar. Ett anrop tar drmed som
+*                    mest ca 70 CPU-cykler oavsett innehll.
+*
+*                    Segmentmnster fr siffror och bokstver lagras i
+*                    programminnet (namnrymden segment). Tal formateras via
+*                    format.hpp utan sprintf, dr decimalpunkten lggs p
+*                    fregende siffra. Tal som inte ryms visas som streck.
+*
+*                    tick lser, modifierar och skriver segmentens portar, men
+*                    ndrar endast displayens pinnar. vriga pinnar p samma
+*                    port br ndras odelbart (exempelvis via output_pin<N>).
+********************************************************************************/
+#ifndef SEVEN_SEGMENT_HPP_
+#define SEVEN_SEGMENT_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "atomic.hpp"
+#include "format.hpp"
+#include <avr/pgmspace.h>
+
+/********************************************************************************
+* segment: Namnrymd innehllande segmentmnster fr sjusegmentsdisplayer, dr
+*          bit 0 - 6 motsvarar segment a - g och bit 7 decimalpunkten.
+********************************************************************************/
+namespace segment
+{
+   static constexpr uint8_t A = (1 << 0);  /* Segment a (verst). */
+   static constexpr uint8_t B = (1 << 1);  /* Segment b (vre hger). */
+   static constexpr uint8_t C = (1 << 2);  /* Segment c (nedre hger). */
+   static constexpr uint8_t D = (1 << 3);  /* Segment d (nederst). */
+   static constexpr uint8_t E = (1 << 4);  /* Segment e (nedre vnster). */
+   static constexpr uint8_t F = (1 << 5);  /* Segment f (vre vnster). */
+   static constexpr uint8_t G = (1 << 6);  /* Segment g (mitten). */
+   static constexpr uint8_t DP = (1 << 7); /* Decimalpunkt. */
+
+   /* Segmentmnster fr ASCII 0x20 - 0x5F lagrade i programminnet: */
+   extern const uint8_t font[64] PROGMEM;
+
+   /********************************************************************************
+   * encode: Returnerar segmentmnstret fr angivet tecken. Gemener visas som
+   *         motsvarande versaler och tecken som saknas i tabellen som blanka.
+   *
+   *         - character: Tecknet som ska visas.
+   ********************************************************************************/
+   uint8_t encode(char character);
+}
+
+/********************************************************************************
+* seven_segment: Generisk klass fr multiplexade sjusegmentsdisplayer med
+*                N siffror, dr siffra 0 r lngst till vnster.
+********************************************************************************/
+template<uint8_t N = 4>
+class seven_segment
+{
+private:
+   static_assert(N >= 1 && N <= 8, "Number of digits must be between 1 and 8!");
+
+   uint8_t lines_[8] = {};                /* Segmentens pinnar kodade som (port << 3) | bit. */
+   uint8_t segments_ = 0;                 /* Antalet anslutna segment (7 eller 8). */
+   bool segments_active_high_ = true;     /* Indikerar ifall tnt segment drivs hgt. */
+   bool digits_active_high_ = false;      /* Indikerar ifall aktiv siffra drivs hg. */
+   volatile uint8_t* digit_ports_[N] = {}; /* Pekare till siffrornas dataregister. */
+   uint8_t digit_masks_[N] = {};          /* Bitmaskar fr siffrornas pinnar. */
+   uint8_t patterns_[N] = {};             /* Segmentmnster per siffra. */
+   uint8_t images_[N][3] = {};            /* Segmentens portvrden per siffra (I/O-port B, C och D). */
+   uint8_t masks_[3] = {};                /* Segmentens pinnar per I/O-port. */
+   volatile uint8_t brightness_ = 8;      /* Antalet ticks per siffra som siffran r tnd. */
+   volatile bool blanked_ = false;        /* Indikerar ifall displayen r slckt. */
+   uint8_t digit_ = 0;                    /* Aktuell siffra (anvnds endast av tick). */
+   uint8_t phase_ = 0;                    /* Aktuell tick inom siffran (anvnds endast av tick). */
+
+   /********************************************************************************
+   * select: Tnder eller slcker angiven siffra via dess gemensamma pin.
+   *
+   *         - digit  : Siffrans index.
+   *         - enabled: Indikerar ifall siffran ska tndas.
+   ********************************************************************************/
+   void select(const uint8_t digit,
+               const bool enabled)
+   {
+      if (enabled == this->digits_active_high_)
+      {
+         *this->digit_ports_[digit] |= this->digit_masks_[digit];
+      }
+      else
+      {
+         *this->digit_ports_[digit] &= ~this->digit_masks_[digit];
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * parse: Omvandlar angiven text till segmentmnster, dr en punkt lggs p
+   *        fregende siffra. Antalet anvnda siffror returneras. Om texten
+   *        inte ryms stts overflow till true och texten kortas av.
+   *
+   *        - s       : Pekare till texten.
+   *        - patterns: Referens till array dr segmentmnstren lagras.
+   *        - overflow: Referens till variabel som indikerar ifall texten
+   *                    inte rymdes.
+   ********************************************************************************/
+   static uint8_t parse(const char* s,
+                        uint8_t (&patterns)[N],
+                        bool& overflow)
+   {
+      uint8_t count = 0;
+      overflow = false;
+
+      for (auto i = s; *i; ++i)
+      {
+         if (*i == '.' && count && !(patterns[count - 1] & segment::DP))
+         {
+            patterns[count - 1] |= segment::DP;
+         }
+         else if (count < N)
+         {
+            patterns[count++] = *i == '.' ? segment::DP : segment::encode(*i);
+         }
+         else
+         {
+            overflow = true;
+            break;
+         }
+      }
+      return count;
+   }
+
+   /********************************************************************************
+   * show: Skriver angivna segmentmnster till displayen, vnster- eller
+   *       hgerjusterade, dr oanvnda siffror slcks.
+   *
+   *       - patterns   : Referens till array med segmentmnster.
+   *       - count      : Antalet anvnda siffror.
+   *       - right_align: Indikerar ifall mnstren ska hgerjusteras.
+   ********************************************************************************/
+   void show(const uint8_t (&patterns)[N],
+             const uint8_t count,
+             const bool right_align)
+   {
+      const uint8_t offset = right_align ? N - count : 0;
+
+      for (uint8_t i = 0; i < N; ++i)
+      {
+         const bool used = i >= offset && i < offset + count;
+         this->set_raw(i, used ? patterns[i - offset] : 0x00);
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * show_overflow: Visar streck p samtliga siffror, vilket indikerar att
+   *                talet inte ryms p displayen.
+   ********************************************************************************/
+   void show_overflow(void)
+   {
+      for (uint8_t i = 0; i < N; ++i)
+      {
+         this->set_raw(i, segment::G);
+      }
+      return;
+   }
+
+public:
+
+   static constexpr uint8_t SLOT_TICKS = 8; /* Antalet ticks per siffra (tillika maximal ljusstyrka). */
+
+   /********************************************************************************
+   * seven_segment: Defaultkonstruktor, initierar tomt objekt.
+   ********************************************************************************/
+   seven_segment(void) { }
+
+   /********************************************************************************
+   * seven_segment: Initierar display med angivna pinnar.
+   *
+   *                - segment_pins        : Pekare till array med segmentens
+   *                                        pinnar i ordningen a - g, dp.
+   *                - segments            : Antalet segment, 7 (utan
+   *                                        decimalpunkt) eller 8.
+   *                - digit_pins          : Pekare till array med N pinnar fr
+   *                                        siffrornas gemensamma anslutning.
+   *                - segments_active_high: Indikerar ifall tnt segment drivs
+   *                                        hgt (default = true).
+   *                - digits_active_high  : Indikerar ifall aktiv siffra drivs
+   *                                        hg (default = false, dvs.
+   *                                        gemensam katod).
+   ********************************************************************************/
+   seven_segment(const uint8_t* segment_pins,
+                 const uint8_t segments,
+                 const uint8_t* digit_pins,
+                 const bool segments_active_high = true,
+                 const bool digits_active_high = false)
+   {
+      this->init(segment_pins, segments, digit_pins, segments_active_high, digits_active_high);
+      return;
+   }
+
+   /********************************************************************************
+   * seven_segment: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   seven_segment(seven_segment&) = delete;
+
+   /********************************************************************************
+   * seven_segment: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   seven_segment& operator= (seven_segment&) = delete;
+
+   /********************************************************************************
+   * init: Initierar display med angivna pinnar, som stts till utportar med
+   *       samtliga segment och siffror slckta.
+   *
+   *       - segment_pins        : Pekare till array med segmentens pinnar i
+   *                               ordningen a - g, dp.
+   *       - segments            : Antalet segment, 7 eller 8.
+   *       - digit_pins          : Pekare till array med N pinnar fr
+   *                               siffrornas gemensamma anslutning.
+   *       - segments_active_high: Indikerar ifall tnt segment drivs hgt.
+   *       - digits_active_high  : Indikerar ifall aktiv siffra drivs hg.
+   ********************************************************************************/
+   void init(const uint8_t* segment_pins,
+             const uint8_t segments,
+             const uint8_t* digit_pins,
+             const bool segments_active_high = true,
+             const bool digits_active_high = false)
+   {
+      critical_section lock;
+      this->segments_ = segments < 8 ? segments : 8;
+      this->segments_active_high_ = segments_active_high;
+      this->digits_active_high_ = digits_active_high;
+      this->masks_[0] = this->masks_[1] = this->masks_[2] = 0;
+
+      for (uint8_t i = 0; i < this->segments_; ++i)
+      {
+         const auto pin = segment_pins[i];
+         const uint8_t port = pin <= 7 ? static_cast<uint8_t>(io_port::d) :
+            (pin <= 13 ? static_cast<uint8_t>(io_port::b) : static_cast<uint8_t>(io_port::c));
+         const uint8_t bit = pin <= 7 ? pin : (pin <= 13 ? pin - 8 : pin - 14);
+         this->lines_[i] = (port << 3) | bit;
+         this->masks_[port] |= (1 << bit);
+      }
+
+      DDRB |= this->masks_[0];
+      DDRC |= this->masks_[1];
+      DDRD |= this->masks_[2];
+
+      for (uint8_t i = 0; i < N; ++i)
+      {
+         const auto pin = digit_pins[i];
+
+         if (pin <= 7)
+         {
+            this->digit_ports_[i] = &PORTD;
+            this->digit_masks_[i] = (1 << pin);
+            DDRD |= this->digit_masks_[i];
+         }
+         else if (pin <= 13)
+         {
+            this->digit_ports_[i] = &PORTB;
+            this->digit_masks_[i] = (1 << (pin - 8));
+            DDRB |= this->digit_masks_[i];
+         }
+         else
+         {
+            this->digit_ports_[i] = &PORTC;
+            this->digit_masks_[i] = (1 << (pin - 14));
+            DDRC |= this->digit_masks_[i];
+         }
+
+         this->select(i, false);
+         this->set_raw(i, 0x00);
+      }
+
+      this->digit_ = 0;
+      this->phase_ = 0;
+      return;
+   }
+
+   /********************************************************************************
+   * tick: Multiplexerar displayen och anropas periodiskt frn en timer. Vid
+   *       frsta ticken fr varje siffra slcks fregende siffra, segmenten
+   *       skrivs och siffran tnds. Siffran slcks nr antalet ticks nr
+   *       ljusstyrkan. Antalet cykler r begrnsat och oberoende av innehll.
+   ********************************************************************************/
+   void tick(void)
+   {
+      if (!this->segments_) return;
+
+      if (this->phase_ == 0)
+      {
+         this->select(this->digit_, false);
+         if (++this->digit_ >= N) this->digit_ = 0;
+
+         const auto image = this->images_[this->digit_];
+         PORTB = (PORTB & ~this->masks_[0]) | image[0];
+         PORTC = (PORTC & ~this->masks_[1]) | image[1];
+         PORTD = (PORTD & ~this->masks_[2]) | image[2];
+
+         if (this->brightness_ && !this->blanked_) this->select(this->digit_, true);
+      }
+      else if (this->phase_ == this->brightness_)
+      {
+         this->select(this->digit_, false);
+      }
+
+      if (++this->phase_ >= SLOT_TICKS) this->phase_ = 0;
+      return;
+   }
+
+   /********************************************************************************
+   * set_raw: Stter angivet segmentmnster p angiven siffra, dr bit 0 - 6
+   *          motsvarar segment a - g och bit 7 decimalpunkten. Segmentens
+   *          portvrden berknas hr, s att tick endast behver skriva dem.
+   *
+   *          - digit  : Siffrans index, 0 - N - 1.
+   *          - pattern: Segmentmnstret.
+   ********************************************************************************/
+   void set_raw(const uint8_t digit,
+                const uint8_t pattern)
+   {
+      if (digit >= N) return;
+      uint8_t image[3] = {};
+
+      for (uint8_t i = 0; i < this->segments_; ++i)
+      {
+         const bool lit = pattern & (1 << i);
+         if (lit == this->segments_active_high_) image[this->lines_[i] >> 3] |= (1 << (this->lines_[i] & 0x07));
+      }
+
+      critical_section lock;
+      this->patterns_[digit] = pattern;
+      this->images_[digit][0] = image[0];
+      this->images_[digit][1] = image[1];
+      this->images_[digit][2] = image[2];
+      return;
+   }
+
+   /********************************************************************************
+   * get_raw: Returnerar segmentmnstret fr angiven siffra.
+   *
+   *          - digit: Siffrans index, 0 - N - 1.
+   ********************************************************************************/
+   uint8_t get_raw(const uint8_t digit) const
+   {
+      return digit < N ? this->patterns_[digit] : 0x00;
+   }
+
+   /********************************************************************************
+   * set_char: Visar angivet tecken p angiven siffra.
+   *
+   *           - digit    : Siffrans index, 0 - N - 1.
+   *           - character: Tecknet som ska visas.
+   *           - dp       : Indikerar ifall decimalpunkten ska tndas
+   *                        (default = false).
+   ********************************************************************************/
+   void set_char(const uint8_t digit,
+                 const char character,
+                 const bool dp = false)
+   {
+      this->set_raw(digit, segment::encode(character) | (dp ? segment::DP : 0x00));
+      return;
+   }
+
+   /********************************************************************************
+   * set_dp: Tnder eller slcker decimalpunkten p angiven siffra.
+   *
+   *         - digit  : Siffrans index, 0 - N - 1.
+   *         - enabled: Indikerar ifall decimalpunkten ska tndas.
+   ********************************************************************************/
+   void set_dp(const uint8_t digit,
+               const bool enabled)
+   {
+      if (digit >= N) return;
+      const auto pattern = this->patterns_[digit];
+      this->set_raw(digit, enabled ? pattern | segment::DP : pattern & ~segment::DP);
+      return;
+   }
+
+   /********************************************************************************
+   * clear: Slcker samtliga siffror.
+   ********************************************************************************/
+   void clear(void)
+   {
+      for (uint8_t i = 0; i < N; ++i)
+      {
+         this->set_raw(i, 0x00);
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * print: Visar angiven text, dr en punkt lggs p fregende tecken.
+   *        Text som inte ryms kortas av.
+   *
+   *        - s          : Pekare till texten.
+   *        - right_align: Indikerar ifall texten ska hgerjusteras
+   *                       (default = false).
+   ********************************************************************************/
+   void print(const char* s,
+              const bool right_align = false)
+   {
+      uint8_t patterns[N] = {};
+      bool overflow = false;
+      const auto count = parse(s, patterns, overflow);
+      this->show(patterns, count, right_align);
+      return;
+   }
+
+   /********************************************************************************
+   * print: Visar angivet tal hgerjusterat med angivet antal decimaler, dr
+   *        talet tolkas som ett fixtal, exempelvis 2150 med tv decimaler
+   *        som "21.50". Tal som inte ryms visas som streck.
+   *
+   *        - number  : Talet som ska visas.
+   *        - decimals: Antalet decimaler (default = 0).
+   ********************************************************************************/
+   void print(const int32_t number,
+              const uint8_t decimals = 0)
+   {
+      char s[format::BUFFER_SIZE];
+      uint8_t patterns[N] = {};
+      bool overflow = false;
+
+      format::to_string(number, decimals, s);
+      const auto count = parse(s, patterns, overflow);
+
+      if (overflow)
+      {
+         this->show_overflow();
+      }
+      else
+      {
+         this->show(patterns, count, true);
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * print_hex: Visar angivet tal i hexadecimal form hgerjusterat, utfyllt
+   *            med inledande nollor till angiven bredd. Tal som inte ryms
+   *            visas som streck.
+   *
+   *            - number: Talet som ska visas.
+   *            - width : Minsta antal siffror (default = 1).
+   ********************************************************************************/
+   void print_hex(const uint32_t number,
+                  const uint8_t width = 1)
+   {
+      char s[format::BUFFER_SIZE];
+      uint8_t patterns[N] = {};
+      bool overflow = false;
+
+      format::to_hex(number, s, width);
+      const auto count = parse(s, patterns, overflow);
+
+      if (overflow)
+      {
+         this->show_overflow();
+      }
+      else
+      {
+         this->show(patterns, count, true);
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * brightness: Returnerar aktuell ljusstyrka, 0 - SLOT_TICKS.
+   ********************************************************************************/
+   uint8_t brightness(void) const
+   {
+      return this->brightness_;
+   }
+
+   /********************************************************************************
+   * set_brightness: Stter ljusstyrkan, allts antalet ticks per siffra som
+   *                 siffran r tnd.
+   *
+   *                 - brightness: Ljusstyrka, 0 - SLOT_TICKS (0 = slckt).
+   ********************************************************************************/
+   void set_brightness(const uint8_t brightness)
+   {
+      this->brightness_ = brightness < SLOT_TICKS ? brightness : SLOT_TICKS;
+      return;
+   }
+
+   /********************************************************************************
+   * blank: Slcker eller tnder hela displayen utan att innehllet pverkas,
+   *        exempelvis fr att blinka ett vrde under instllning.
+   *
+   *        - blanked: Indikerar ifall displayen ska slckas.
+   ********************************************************************************/
+   void blank(const bool blanked)
+   {
+      this->blanked_ = blanked;
+      return;
+   }
+
+   /********************************************************************************
+   * blanked: Indikerar ifall displayen r slckt via blank.
+   ********************************************************************************/
+   bool blanked(void) const
+   {
+      return this->blanked_;
+   }
+
+   /********************************************************************************
+   * refresh_rate: Returnerar uppdateringsfrekvensen mtt i Hz fr angivet
+   *               tickintervall.
+   *
+   *               - tick_us: Tid mellan anrop av tick mtt i mikrosekunder
+   *                          (default = 128 us).
+   ********************************************************************************/
+   static constexpr uint16_t refresh_rate(const uint16_t tick_us = 128)
+   {
+      return static_cast<uint16_t>(1000000UL / (static_cast<uint32_t>(tick_us) * SLOT_TICKS * N));
+   }
+};
+
+#endif /* SEVEN_SEGMENT_HPP_ */
@@ -0,0 +1,154 @@
+/********************************************************************************
+* span.hpp: Implementering av icke-gande vyer av sammanhngande element via
+*           klassen span.
+*
+*           En span bestr endast av en pekare och en storlek och refererar
+*           till element som gs av ngon annan, exempelvis en statisk array,
+*           en vector eller en static_vector. Drmed kan funktioner ta emot
+*           element oavsett hur de lagras, utan kopiering eller allokering.
+*           Elementen mste finnas kvar s lnge vyn anvnds; en vector som
+*           vxer kan flytta sina element, varvid vyn blir ogiltig.
+********************************************************************************/
+#ifndef SPAN_HPP_
+#define SPAN_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+
+/********************************************************************************
+* span: Generisk klass fr icke-gande vyer av element av valfri datatyp.
+********************************************************************************/
+template<class T>
+class span
+{
+protected:
+   T* data_ = nullptr; /* Pekare till det frsta refererade elementet. */
+   size_t size_ = 0;   /* Antalet refererade element. */
+public:
+
+   /*****************************************************************************
+   * span: Tom konstruktor, initierar en ny tom vy.
+   *****************************************************************************/
+   span(void) { }
+
+   /*****************************************************************************
+   * span: Initierar vy av angivet antal element med start p angiven adress.
+   *
+   *       - data: Pekare till det frsta elementet.
+   *       - size: Antalet element.
+   *****************************************************************************/
+   span(T* data,
+        const size_t size)
+   {
+      this->assign(data, size);
+      return;
+   }
+
+   /*****************************************************************************
+   * span: Initierar vy av samtliga element i angiven array.
+   *
+   *       - array: Referens till arrayen.
+   *****************************************************************************/
+   template<size_t N>
+   span(T (&array)[N])
+   {
+      this->assign(array, N);
+      return;
+   }
+
+   /*****************************************************************************
+   * span: Initierar vy av samtliga element i angiven vektor, exempelvis en
+   *       vector eller static_vector.
+   *
+   *       - container: Referens till vektorn.
+   *****************************************************************************/
+   template<class C>
+   span(C& container)
+   {
+      this->assign(container.data(), container.size());
+      return;
+   }
+
+   /*****************************************************************************
+   * data: Returnerar en pekare till det frsta refererade elementet.
+   *****************************************************************************/
+   T* data(void) const
+   {
+      return this->data_;
+   }
+
+   /*****************************************************************************
+   * size: Returnerar antalet refererade element.
+   *****************************************************************************/
+   size_t size(void) const
+   {
+      return this->size_;
+   }
+
+   /*****************************************************************************
+   * begin: Returnerar adressen till det frsta refererade elementet.
+   *****************************************************************************/
+   T* begin(void) const
+   {
+      return this->data_;
+   }
+
+   /*****************************************************************************
+   * end: Returnerar adressen direkt efter det sista refererade elementet.
+   *****************************************************************************/
+   T* end(void) const
+   {
+      return this->data_ + this->size_;
+   }
+
+   /*****************************************************************************
+   * last: Returnerar adressen till det sista refererade elementet.
+   *****************************************************************************/
+   T* last(void) const
+   {
+      return this->size_ ? this->end() - 1 : nullptr;
+   }
+
+   /*****************************************************************************
+   * operator[]: Returnerar en referens till elementet p angivet index, som
+   *             inte kontrolleras.
+   *
+   *             - index: Elementets index, 0 - size - 1.
+   *****************************************************************************/
+   T& operator[] (const size_t index) const
+   {
+      return this->data_[index];
+   }
+
+   /*****************************************************************************
+   * assign: Pekar om angiven vy till angivet antal element med start p
+   *         angiven adress. Returnerar 0 fr kompatibilitet med vector.
+   *
+   *         - data: Pekare till det frsta elementet.
+   *         - size: Antalet element.
+   *****************************************************************************/
+   int assign(T* data,
+              const size_t size)
+   {
+      this->data_ = data;
+      this->size_ = data ? size : 0;
+      return 0;
+   }
+
+   /*****************************************************************************
+   * subspan: Returnerar en vy av hgst angivet antal element med start p
+   *          angivet index. Vyn kortas av vid slutet av angiven vy.
+   *
+   *          - offset: Index fr det frsta elementet.
+   *          - count : Hgsta antal element.
+   *****************************************************************************/
+   span subspan(const size_t offset,
+                const size_t count) const
+   {
+      if (offset >= this->size_) return span();
+      const size_t remaining = this->size_ - offset;
+      return span(this->data_ + offset, count < remaining ? count : remaining);
+   }
+};
+
+#endif /* SPAN_HPP_ */
\ No newline at end of file
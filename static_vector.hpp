@@ -0,0 +1,295 @@
+/********************************************************************************
+* static_vector.hpp: Implementering av vektorer med fast kapacitet via klassen
+*                    static_vector.
+*
+*                    Elementen lagras direkt i objektet i stllet fr p
+*                    heapen, s minnestgngen r knd vid lnkning och
+*                    varken allokering eller fragmentering kan uppst.
+*                    Grnssnittet r detsamma som fr vector, s att klasserna
+*                    kan bytas mot varandra, exempelvis som lagring fr
+*                    led_vector. Operationer som skulle verskrida kapaciteten
+*                    returnerar felkod 1, precis som vector vid misslyckad
+*                    minnesallokering.
+********************************************************************************/
+#ifndef STATIC_VECTOR_HPP_
+#define STATIC_VECTOR_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include "vector.hpp"
+
+/********************************************************************************
+* static_vector: Generisk klass fr vektorer av valfri datatyp med plats fr
+*                hgst N element, som lagras utan dynamisk minnesallokering.
+********************************************************************************/
+template<class T, size_t N>
+class static_vector
+{
+protected:
+   static_assert(N > 0, "The capacity of a static vector must be at least one element!");
+
+   alignas(T) uint8_t storage_[sizeof(T) * N]; /* Minne fr elementen, som konstrueras vid behov. */
+   size_t size_ = 0;                           /* Vektorns storlek, dvs. antalet lagrade element. */
+
+public:
+
+   /*****************************************************************************
+   * static_vector: Tom konstruktor, initierar en ny tom vektor.
+   *****************************************************************************/
+   static_vector(void) { }
+
+   /*****************************************************************************
+   * static_vector: Konstruktor, initierar ny vektor av angiven storlek med
+   *                angivet startvrde. Storleken begrnsas till N.
+   *
+   *                - start_size: Vektorns nya storlek (antalet element).
+   *                - start_val : Referens till startvrde fr samtliga element
+   *                              (default = 0).
+   *****************************************************************************/
+   static_vector(const size_t start_size,
+                 const T& start_val = static_cast<T>(0))
+   {
+      this->resize(start_size <= N ? start_size : N, start_val);
+      return;
+   }
+
+   /*****************************************************************************
+   * ~static_vector: Destruktor, destruerar lagrade element innan radering.
+   *****************************************************************************/
+   ~static_vector(void)
+   {
+      this->clear();
+      return;
+   }
+
+   /********************************************************************************
+   * static_vector: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   static_vector(static_vector&) = delete;
+
+   /********************************************************************************
+   * static_vector: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   static_vector& operator= (static_vector&) = delete;
+
+   /*****************************************************************************
+   * data: Returnerar en pekare till innehllet lagrat i angiven vektor.
+   *****************************************************************************/
+   T* data(void) const
+   {
+      return reinterpret_cast<T*>(const_cast<uint8_t*>(this->storage_));
+   }
+
+   /*****************************************************************************
+   * size: Returnerar arrayens storlek (antalet element) i angiven vektor.
+   *****************************************************************************/
+   size_t size(void) const
+   {
+      return this->size_;
+   }
+
+   /*****************************************************************************
+   * capacity: Returnerar antalet element som ryms i angiven vektor, dvs. N.
+   *****************************************************************************/
+   static constexpr size_t capacity(void)
+   {
+      return N;
+   }
+
+   /*****************************************************************************
+   * begin: Returnerar adressen till det frsta elementet i angiven vektor.
+   *****************************************************************************/
+   T* begin(void) const
+   {
+      return this->data();
+   }
+
+   /*****************************************************************************
+   * end: Returnerar adressen direkt efter det sista elementet i angiven vektor.
+   *****************************************************************************/
+   T* end(void) const
+   {
+      return this->data() + this->size_;
+   }
+
+   /*****************************************************************************
+   * last: Returnerar adressen till det sista elementet i angiven vektor.
+   *****************************************************************************/
+   T* last(void) const
+   {
+      return this->size_ ? this->end() - 1 : nullptr;
+   }
+
+   /*****************************************************************************
+   * clear: Tmmer angiven vektor.
+   *****************************************************************************/
+   void clear(void)
+   {
+      while (this->size_)
+      {
+         this->pop();
+      }
+      return;
+   }
+
+   /*****************************************************************************
+   * reserve: Kontrollerar att angiven vektor rymmer angivet antal element.
+   *          Ifall det gr det returneras 0, annars felkod 1.
+   *
+   *          - new_capacity: nskad kapacitet (antalet element).
+   *****************************************************************************/
+   int reserve(const size_t new_capacity) const
+   {
+      return new_capacity <= N ? 0 : 1;
+   }
+
+   /*****************************************************************************
+   * shrink_to_fit: Saknar effekt, eftersom minnet r statiskt. Returnerar 0
+   *                fr kompatibilitet med vector.
+   *****************************************************************************/
+   int shrink_to_fit(void) const
+   {
+      return 0;
+   }
+
+   /*****************************************************************************
+   * assign: Kopierar angivet antal element frn angivet flt till angiven
+   *         vektor, som frst tms. Ifall elementen ryms returneras 0, annars
+   *         felkod 1, varvid vektorn lmnas tom.
+   *
+   *         - data: Pekare till fltet som ska kopieras.
+   *         - size: Antalet element i fltet.
+   *****************************************************************************/
+   int assign(const T* data,
+              const size_t size)
+   {
+      this->clear();
+      if (size > N) return 1;
+
+      for (size_t i = 0; i < size; ++i)
+      {
+         new (this->data() + this->size_++) T(data[i]);
+      }
+      return 0;
+   }
+
+   /*****************************************************************************
+   * resize: ndrar storlek p angiven vektor med angivet startvrde, dr
+   *         startvrdet r satt till 0 som default. Samtliga element tilldelas
+   *         startvrdet. Ifall den nya storleken ryms returneras 0, annars
+   *         felkod 1, varvid vektorn lmnas ofrndrad.
+   *
+   *         - new_size : Vektorns nya storlek (antalet element).
+   *         - start_val: Referens till startvrde fr respektive element
+   *                      (default = 0).
+   *****************************************************************************/
+   int resize(const size_t new_size,
+              const T& start_val = static_cast<T>(0))
+   {
+      if (new_size > N) return 1;
+
+      while (this->size_ > new_size)
+      {
+         this->pop();
+      }
+
+      for (auto& i : *this)
+      {
+         i = start_val;
+      }
+
+      while (this->size_ < new_size)
+      {
+         new (this->data() + this->size_++) T(start_val);
+      }
+
+      return 0;
+   }
+
+   /*****************************************************************************
+   * emplace: Konstruerar ett nytt element lngst bak i angiven vektor med
+   *          angivna argument. Ifall elementet ryms returneras 0, annars
+   *          felkod 1.
+   *
+   *          - args: Argument som passeras till elementets konstruktor.
+   *****************************************************************************/
+   template<class... Args>
+   int emplace(Args&&... args)
+   {
+      if (this->size_ >= N) return 1;
+      new (this->data() + this->size_) T(static_cast<Args&&>(args)...);
+      this->size_++;
+      return 0;
+   }
+
+   /*****************************************************************************
+   * push: Lgger till ett nytt element lngst bak i angiven vektor. Ifall
+   *       elementet ryms returneras 0, annars felkod 1.
+   *
+   *       - new_element: Referens till det nya element som skall lggas till.
+   *****************************************************************************/
+   int push(const T& new_element)
+   {
+      return this->emplace(new_element);
+   }
+
+   /*****************************************************************************
+   * pop: Tar bort det sista elementet i angiven vektor om ett sdant finns.
+   *****************************************************************************/
+   void pop(void)
+   {
+      if (!this->size_) return;
+      this->data()[--this->size_].~T();
+      return;
+   }
+
+   /*****************************************************************************
+   * insert: Lgger till ett nytt element p angivet index i angiven vektor,
+   *         dr efterfljande element flyttas ett steg bakt. Ifall indexet
+   *         r giltigt och elementet ryms returneras 0, annars felkod 1.
+   *
+   *         - index      : Index fr det nya elementet, 0 - size.
+   *         - new_element: Referens till det nya element som skall lggas till.
+   *****************************************************************************/
+   int insert(const size_t index,
+              const T& new_element)
+   {
+      if (index > this->size_ || this->size_ >= N) return 1;
+      if (index == this->size_) return this->emplace(new_element);
+
+      T copy(new_element);
+      auto data = this->data();
+      this->emplace(static_cast<T&&>(data[this->size_ - 1]));
+
+      for (size_t i = this->size_ - 2; i > index; --i)
+      {
+         data[i] = static_cast<T&&>(data[i - 1]);
+      }
+
+      data[index] = static_cast<T&&>(copy);
+      return 0;
+   }
+
+   /*****************************************************************************
+   * erase: Tar bort elementet p angivet index i angiven vektor, dr
+   *        efterfljande element flyttas ett steg framt. Ifall indexet r
+   *        giltigt returneras 0, annars felkod 1.
+   *
+   *        - index: Index fr elementet som ska tas bort.
+   *****************************************************************************/
+   int erase(const size_t index)
+   {
+      if (index >= this->size_) return 1;
+      auto data = this->data();
+
+      for (size_t i = index; i + 1 < this->size_; ++i)
+      {
+         data[i] = static_cast<T&&>(data[i + 1]);
+      }
+
+      this->pop();
+      return 0;
+   }
+};
+
+#endif /* STATIC_VECTOR_HPP_ */
\ No newline at end of file
@@ -0,0 +1,30 @@
+/********************************************************************************
+* timer.cpp: Innehller standardrutiner fr avbrottsvektorerna som anvnds av
+*            Timer 0 samt Timer 1 via klassen timer. Rutinerna anropar timerns
+*            avbrottshantering direkt i stllet fr via dispatch-lagret, s
+*            att lagrad avbrottsrutin r det enda indirekta anropet per
+*            avbrott. Rutinerna deklareras som svaga symboler, s att en
+*            avbrottsrutin definierad via INTERRUPT_BIND erstter motsvarande
+*            standardrutin vid lnkningen.
+********************************************************************************/
+#include "timer.hpp"
+
+/********************************************************************************
+* ISR (TIMER0_OVF_vect): Anropar avbrottshanteringen fr den timer som
+*                        anvnder Timer 0, bde i timer- och rknarlge.
+********************************************************************************/
+ISR (TIMER0_OVF_vect, __attribute__((weak)))
+{
+   timer::handle_vector<timer::sel::timer0>();
+   return;
+}
+
+/********************************************************************************
+* ISR (TIMER1_COMPA_vect): Anropar avbrottshanteringen fr den timer som
+*                          anvnder Timer 1 i CTC Mode.
+********************************************************************************/
+ISR (TIMER1_COMPA_vect, __attribute__((weak)))
+{
+   timer::handle_vector<timer::sel::timer1>();
+   return;
+}
\ No newline at end of file
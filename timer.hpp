@@ -2,12 +2,35 @@
 * timer.hpp: Innehller funktionalitet fr implementering av interruptbaserade
 *            timerkretsar via klassen timer. Dessa timerkretsar fungerar ocks 
 *            utmrkt att anvnda som rknare.
+*
+*            Om avbrottsrutinen r knd vid kompileringen binds den direkt
+*            till timerkretsens avbrottsvektor via INTERRUPT_BIND och
+*            handle_interrupt<F>, vilket ger ett direkt anrop utan
+*            funktionspekare. Upprkning av timern skts i s fall av
+*            drivrutinen.
+*
+*            Alternativt kan en avbrottsrutin passeras vid initiering, vilken
+*            d anropas via funktionspekare varje gng timern lper ut. Timer 0
+*            samt Timer 1 har d standardrutiner i timer.cpp, som anropar
+*            timerns avbrottshantering direkt, medan Timer 2 anropas via
+*            dispatch-lagret i interrupt.hpp, eftersom TIMER2_OVF_vect delas
+*            med tidsbasen i power.
+*
+*            Timer 0 samt Timer 1 kan ven anvndas som hrdvarubaserade
+*            hndelserknare, dr timerkretsen klockas av pulser p pin T0
+*            (PORTD4 / pin 4) respektive T1 (PORTD5 / pin 5). Varje flank rknas
+*            d av hrdvaran utan att ngot avbrott genereras; endast vid
+*            overflow (var 256:e respektive var 65 536:e puls) sker ett avbrott
+*            fr utkning av rknaren till 32 bitar. Pulser upp till ca 6 MHz
+*            (F_CPU / 2.5) kan rknas.
 ********************************************************************************/
 #ifndef TIMER_HPP_
 #define TIMER_HPP_
 
 /* Inkluderingsdirektiv: */
 #include "misc.hpp"
+#include "interrupt.hpp"
+#include "atomic.hpp"
 
 /********************************************************************************
 * timer: Klass fr implementering av interruptbaserade timerkretsar, som vid
@@ -18,11 +41,12 @@ class timer
 public:
    enum class sel; /* Frdeklaration av enumerationsklass fr val av timerkrets. */
 private:
-   volatile uint32_t counter_ = 0;  /* 32-bitars rknare. */
+   atomic<uint32_t> counter_;       /* 32-bitars rknare (antalet rknade pulser fre senaste overflow i rknarlge). */
    uint32_t max_count_ = 0;         /* Maxvrde som upprkning ska ske till. */
    volatile uint8_t* timsk_ = 0;    /* Pekare till maskregister fr aktivering av avbrott. */
    uint8_t timsk_bit_ = 0;          /* Bit fr aktivering av avbrott i motsvarande maskregister. */
    enum sel timer_sel_ = sel::none; /* Val av timerkrets. */
+   void (*callback_)(void) = nullptr; /* Pekare till avbrottsrutin som anropas nr timern lper ut. */
 
    static constexpr auto TIME_BETWEEN_INTERRUPTS_MS_ = 0.128; /* 0.128 ms mellan varje timergenererat avbrott. */
 
@@ -37,6 +61,105 @@ private:
       return static_cast<uint32_t>(time_ms / timer::TIME_BETWEEN_INTERRUPTS_MS_ + 0.5);
    }
 
+   /********************************************************************************
+   * instance: Returnerar en referens till pekaren till det timer-objekt som
+   *           anvnder angiven timerkrets via dispatch-lagret.
+   ********************************************************************************/
+   template<sel S>
+   static timer*& instance(void)
+   {
+      static timer* instance = nullptr;
+      return instance;
+   }
+
+   /********************************************************************************
+   * dispatch: Avbrottsrutin som lagras i dispatch-lagret fr Timer 2.
+   *           Anropar avbrottshanteringen fr det timer-objekt som anvnder
+   *           timerkretsen.
+   ********************************************************************************/
+   template<sel S>
+   static void dispatch(void)
+   {
+      timer::instance<S>()->handle_interrupt();
+      return;
+   }
+
+   /********************************************************************************
+   * dispatch_overflow: Rknar upp rknarens vre bitar med antalet pulser som
+   *                    krvs fr overflow av angiven timerkrets i rknarlge.
+   *                    Lagras i dispatch-lagret fr Timer 1, eftersom
+   *                    TIMER1_OVF_vect delas med capture.
+   ********************************************************************************/
+   template<sel S>
+   static void dispatch_overflow(void)
+   {
+      timer::instance<S>()->counter_.fetch_add(S == sel::timer0 ? 0x100UL : 0x10000UL);
+      return;
+   }
+
+   /********************************************************************************
+   * bind: Lagrar angiven timer som anvndare av angiven timerkrets, vilket
+   *       avlses direkt av timerkretsens avbrottsvektor i timer.cpp. Lagringen
+   *       sker med avbrott inaktiverade, s att en halvskriven pekare aldrig
+   *       kan avlsas.
+   *
+   *       - self: Pekare till timern som ska lagras (nullptr vid borttagning).
+   ********************************************************************************/
+   template<sel S>
+   static void bind(timer* self)
+   {
+      critical_section lock;
+      timer::instance<S>() = self;
+      return;
+   }
+
+   /********************************************************************************
+   * attach_callback: Lagrar angiven timer fr anrop av dess avbrottsrutin,
+   *                  frutsatt att en avbrottsrutin har passerats.
+   ********************************************************************************/
+   void attach_callback(void)
+   {
+      if (!this->callback_) return;
+
+      if (this->timer_sel_ == sel::timer0)
+      {
+         timer::bind<sel::timer0>(this);
+      }
+      else if (this->timer_sel_ == sel::timer1)
+      {
+         timer::bind<sel::timer1>(this);
+      }
+      else if (this->timer_sel_ == sel::timer2)
+      {
+         timer::instance<sel::timer2>() = this;
+         interrupt::attach<interrupt::vector::timer2_ovf>(&timer::dispatch<sel::timer2>);
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * detach_callback: Tar bort angiven timer som anvndare av timerkretsen,
+   *                  frutsatt att timerkretsen anvnds av angiven timer.
+   ********************************************************************************/
+   void detach_callback(void)
+   {
+      if (this->timer_sel_ == sel::timer0 && timer::instance<sel::timer0>() == this)
+      {
+         timer::bind<sel::timer0>(nullptr);
+      }
+      else if (this->timer_sel_ == sel::timer1 && timer::instance<sel::timer1>() == this)
+      {
+         interrupt::detach<interrupt::vector::timer1_ovf>();
+         timer::bind<sel::timer1>(nullptr);
+      }
+      else if (this->timer_sel_ == sel::timer2 && timer::instance<sel::timer2>() == this)
+      {
+         interrupt::detach<interrupt::vector::timer2_ovf>();
+         timer::instance<sel::timer2>() = nullptr;
+      }
+      return;
+   }
+
    /********************************************************************************
    * init_circuit: Initierar angiven timerkrets. Timer 0 samt Timer 2 initieras 
    *               i Normal Mode, medan Timer 1 initieras i CTC Mode med upprkning 
@@ -81,11 +204,15 @@ public:
    *
    *        - timer_sel: Val av timerkrets.
    *        - time_ms  : Tiden timern ska sttas p mtt i millisekunder.
+   *        - callback : Avbrottsrutin som anropas nr timern lper ut
+   *                     (default = ingen, avbrottsvektorn skrivs d av
+   *                     anvndaren).
    ********************************************************************************/
    timer(const sel timer_sel, 
-         const double time_ms)
+         const double time_ms,
+         void (*callback)(void) = nullptr)
    {
-      this->init(timer_sel, time_ms);
+      this->init(timer_sel, time_ms, callback);
       return;
    }
 
@@ -113,7 +240,7 @@ public:
    ********************************************************************************/
    uint32_t counter(void) const
    {
-      return this->counter_;
+      return this->counter_.load();
    }
 
    /********************************************************************************
@@ -146,23 +273,138 @@ public:
    *
    *       - timer_sel: Val av timerkrets.
    *       - time_ms  : Tiden timern ska sttas p mtt i millisekunder.
+   *       - callback : Avbrottsrutin som anropas nr timern lper ut
+   *                    (default = ingen, avbrottsvektorn skrivs d av
+   *                    anvndaren).
    ********************************************************************************/
    void init(const sel timer_sel, 
-             const double time_ms)
+             const double time_ms,
+             void (*callback)(void) = nullptr)
    {
       this->timer_sel_ = timer_sel;
       this->max_count_ = this->get_max_count(time_ms);
+      this->callback_ = callback;
       this->init_circuit();
+      this->attach_callback();
       return;
    }
 
+   /********************************************************************************
+   * init_counter: Initierar Timer 0 eller Timer 1 som hrdvarubaserad
+   *               hndelserknare, dr timerkretsen klockas av pulser p pin
+   *               T0 (PORTD4 / pin 4) respektive T1 (PORTD5 / pin 5). Timer 2
+   *               saknar extern klockingng och kan drmed inte anvndas.
+   *               Avbrott sker endast vid overflow, vilket anvnds fr att
+   *               utka rknaren till 32 bitar.
+   *
+   *               - timer_sel: Val av timerkrets (Timer 0 eller Timer 1).
+   *               - rising   : Indikerar ifall pulser ska rknas p stigande
+   *                            flank (default = true), annars fallande flank.
+   *               - pullup   : Indikerar ifall intern pullup-resistor ska
+   *                            aktiveras p ingngen (default = false).
+   ********************************************************************************/
+   void init_counter(const sel timer_sel,
+                     const bool rising = true,
+                     const bool pullup = false)
+   {
+      this->timer_sel_ = timer_sel;
+      this->counter_.store(0);
+      this->max_count_ = 0;
+      this->callback_ = nullptr;
+
+      const uint8_t clock_select = rising ? (1 << CS02) | (1 << CS01) | (1 << CS00) : (1 << CS02) | (1 << CS01);
+
+      if (timer_sel == sel::timer0)
+      {
+         DDRD &= ~(1 << PORTD4);
+         if (pullup) PORTD |= (1 << PORTD4);
+
+         this->timsk_ = &TIMSK0;
+         this->timsk_bit_ = TOIE0;
+         TCCR0A = 0x00;
+         TCCR0B = clock_select;
+         TCNT0 = 0;
+         TIFR0 = (1 << TOV0);
+
+         timer::bind<sel::timer0>(this);
+      }
+      else if (timer_sel == sel::timer1)
+      {
+         DDRD &= ~(1 << PORTD5);
+         if (pullup) PORTD |= (1 << PORTD5);
+
+         this->timsk_ = &TIMSK1;
+         this->timsk_bit_ = TOIE1;
+         TCCR1A = 0x00;
+         TCCR1B = clock_select;
+         TCNT1 = 0;
+         TIFR1 = (1 << TOV1);
+
+         timer::instance<sel::timer1>() = this;
+         interrupt::attach<interrupt::vector::timer1_ovf>(&timer::dispatch_overflow<sel::timer1>);
+      }
+      else
+      {
+         return;
+      }
+
+      this->enable_interrupt();
+      asm("SEI");
+      return;
+   }
+
+   /********************************************************************************
+   * event_count: Returnerar antalet rknade pulser i rknarlge som ett
+   *              32-bitars tal. Rknarens vre bitar samt timerkretsens
+   *              rknarregister lses med avbrott inaktiverade, dr ett
+   *              overflow som nnu inte har hanterats kompenseras, vilket gr
+   *              att ett halvuppdaterat vrde aldrig kan returneras.
+   ********************************************************************************/
+   uint32_t event_count(void) const
+   {
+      critical_section lock;
+      auto count = this->counter_.load();
+
+      if (this->timer_sel_ == sel::timer0)
+      {
+         const uint8_t low = TCNT0;
+         if ((TIFR0 & (1 << TOV0)) && low < 0x80) count += 0x100;
+         count += low;
+      }
+      else if (this->timer_sel_ == sel::timer1)
+      {
+         const uint16_t low = TCNT1;
+         if ((TIFR1 & (1 << TOV1)) && low < 0x8000) count += 0x10000;
+         count += low;
+      }
+
+      return count;
+   }
+
+   /********************************************************************************
+   * event_rate_hz: Mter antalet pulser per sekund i rknarlge under angiven
+   *                grindtid. Lngre grindtid ger hgre upplsning (1 Hz vid
+   *                1000 ms), men blockerar anroparen under hela mtningen.
+   *
+   *                - gate_time_ms: Grindtid mtt i millisekunder.
+   ********************************************************************************/
+   double event_rate_hz(const uint16_t gate_time_ms) const
+   {
+      if (gate_time_ms == 0) return 0.0;
+      const auto start = this->event_count();
+      misc::delay_ms(gate_time_ms);
+      return (this->event_count() - start) * 1000.0 / gate_time_ms;
+   }
+
     /********************************************************************************
    * clear: Inaktiverar och nollstller angiven timerkrets.
    ********************************************************************************/
    void clear(void)
    {
       this->reset();
+      this->detach_callback();
       this->max_count_ = 0;
+      this->callback_ = nullptr;
       this->timsk_ = 0;
       this->timsk_bit_ = 0;
       this->timer_sel_ = sel::none;
@@ -224,20 +466,23 @@ public:
    ********************************************************************************/
    void count(void)
    {
-      this->counter_++;
+      this->counter_.fetch_add(1);
       return;
    }
 
    /********************************************************************************
    * elapsed: Indikerar ifall angiven timer har lpt ut genom att returnera true
    *          eller false. Ifall timern har lpt ut nollstlls rknaren infr
-   *          nsta upprkning.
+   *          nsta upprkning. Jmfrelse och nollstllning sker i samma
+   *          kritiska sektion, s att ingen upprkning kan g frlorad.
    ********************************************************************************/
    bool elapsed(void)
    {
-      if (this->counter_ >= this->max_count_)
+      critical_section lock;
+
+      if (this->counter_.load() >= this->max_count_)
       {
-         this->counter_ = 0;
+         this->counter_.store(0);
          return true;
       }
       else
@@ -246,13 +491,75 @@ public:
       }
    }
 
+   /********************************************************************************
+   * handle_interrupt: Rknar upp angiven timer och anropar lagrad avbrottsrutin
+   *                   nr timern lper ut. Anropas frn timerkretsens
+   *                   avbrottsvektor, alternativt via INTERRUPT_BIND, vilket
+   *                   erstter standardrutinen i timer.cpp, exempelvis:
+   *
+   *                   INTERRUPT_BIND (TIMER1_COMPA_vect, t1.handle_interrupt);
+   ********************************************************************************/
+   void handle_interrupt(void)
+   {
+      this->count();
+
+      if (this->elapsed() && this->callback_)
+      {
+         this->callback_();
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * handle_interrupt: Rknar upp angiven timer och anropar angiven avbrottsrutin
+   *                   direkt nr timern lper ut, utan lagrad funktionspekare.
+   *                   Avbrottsrutinen anges som mallparameter och binds till
+   *                   timerkretsens avbrottsvektor via INTERRUPT_BIND, vilket
+   *                   erstter standardrutinen i timer.cpp, exempelvis:
+   *
+   *                   INTERRUPT_BIND (TIMER1_COMPA_vect, t1.handle_interrupt<&t1_elapsed>);
+   *
+   *                   Timern initieras d utan avbrottsrutin.
+   ********************************************************************************/
+   template<void (*F)(void)>
+   void handle_interrupt(void)
+   {
+      this->count();
+      if (this->elapsed()) F();
+      return;
+   }
+
+   /********************************************************************************
+   * handle_vector: Avbrottshantering fr angiven timerkrets, som anropas direkt
+   *                frn timerkretsens avbrottsvektor i timer.cpp. I rknarlge
+   *                (ingen avbrottsrutin lagrad) rknas rknarens vre bitar
+   *                upp, annars anropas handle_interrupt fr den timer som
+   *                anvnder timerkretsen.
+   ********************************************************************************/
+   template<sel S>
+   static void handle_vector(void)
+   {
+      const auto self = timer::instance<S>();
+      if (!self) return;
+
+      if (self->callback_)
+      {
+         self->handle_interrupt();
+      }
+      else
+      {
+         timer::dispatch_overflow<S>();
+      }
+      return;
+   }
+
    /********************************************************************************
    * reset: terstller angiven timer till startlget.
    ********************************************************************************/
     void reset(void)
     {
        this->disable_interrupt();
-       this->counter_ = 0;
+       this->counter_.store(0);
        return;
     }
 
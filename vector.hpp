@@ -1,5 +1,24 @@
 /********************************************************************************
 * vector.hpp: Implementering av dynamiska vektorer via klassen vector.
+*
+*             Vektorn hller reda p sin kapacitet (antalet allokerade
+*             element) separat frn sin storlek. Nr kapaciteten tar slut vid
+*             push kas den med 50 % (minst fyra element), s att N element
+*             kan lggas till med O(log N) omallokeringar i stllet fr en
+*             omallokering per element, vilket ven minskar fragmenteringen
+*             av heapen. pop frigr aldrig minne; anropa shrink_to_fit fr
+*             att lmna tillbaka verskottet, eller reserve i frvg nr
+*             antalet element r knt.
+*
+*             Element konstrueras och destrueras med placement new samt
+*             explicita destruktoranrop, s att ven datatyper med
+*             konstruktor och destruktor kan lagras. Fr datatyper som kan
+*             kopieras bitvis anvnds realloc, vilket ofta kan utka
+*             minnesblocket p plats.
+*
+*             Vektorn ger alltid sina element; assign kopierar angivet flt.
+*             Fr att referera till element som gs av ngon annan, exempelvis
+*             en statisk array, anvnds span i stllet.
 ********************************************************************************/
 #ifndef VECTOR_HPP_
 #define VECTOR_HPP_
@@ -7,6 +26,18 @@
 /* Inkluderingsdirektiv: */
 #include "misc.hpp"
 
+/********************************************************************************
+* operator new: Placement new, som konstruerar ett objekt p angiven adress
+*               utan allokering. Deklareras hr eftersom avr-libc saknar
+*               standardheadern <new>.
+*
+*               - address: Adressen dr objektet ska konstrueras.
+********************************************************************************/
+inline void* operator new(size_t, void* address) noexcept
+{
+   return address;
+}
+
 /********************************************************************************
 * vector: Generisk klass fr dynamiska vektorer av valfri datatyp.
 ********************************************************************************/
@@ -14,21 +45,97 @@ template<class T>
 class vector
 {
 protected:
-   T* data_ = nullptr; /* Pekare till ett flt innehllande lagrad data. */
-   size_t size_ = 0;   /* Vektorns storlek, dvs. antalet lagrade element. */
+   T* data_ = nullptr;   /* Pekare till ett flt innehllande lagrad data. */
+   size_t size_ = 0;     /* Vektorns storlek, dvs. antalet lagrade element. */
+   size_t capacity_ = 0; /* Antalet allokerade element. */
+
+   /*****************************************************************************
+   * destroy: Destruerar angivet antal element med start p angiven adress.
+   *
+   *          - first: Pekare till det frsta elementet.
+   *          - count: Antalet element som ska destrueras.
+   *****************************************************************************/
+   static void destroy(T* first,
+                       const size_t count)
+   {
+      for (size_t i = 0; i < count; ++i)
+      {
+         first[i].~T();
+      }
+      return;
+   }
+
+   /*****************************************************************************
+   * reallocate: Flyttar vektorns element till ett nytt minnesblock med angiven
+   *             kapacitet. Element som inte ryms i det nya blocket tas bort.
+   *             Ifall omallokeringen lyckas returneras 0, annars felkod 1,
+   *             varvid vektorn lmnas ofrndrad.
+   *
+   *             - new_capacity: Den nya kapaciteten (antalet element).
+   *****************************************************************************/
+   int reallocate(const size_t new_capacity)
+   {
+      if (new_capacity == 0)
+      {
+         free(this->data_);
+         this->data_ = nullptr;
+         this->capacity_ = 0;
+         return 0;
+      }
+
+      T* copy = nullptr;
+      const size_t count = this->size_ < new_capacity ? this->size_ : new_capacity;
+
+      if constexpr (__is_trivially_copyable(T))
+      {
+         copy = static_cast<T*>(realloc(this->data_, sizeof(T) * new_capacity));
+         if (!copy) return 1;
+      }
+      else
+      {
+         copy = static_cast<T*>(malloc(sizeof(T) * new_capacity));
+         if (!copy) return 1;
+
+         for (size_t i = 0; i < count; ++i)
+         {
+            new (copy + i) T(static_cast<T&&>(this->data_[i]));
+         }
+
+         destroy(this->data_, this->size_);
+         free(this->data_);
+      }
+
+      this->data_ = copy;
+      this->size_ = count;
+      this->capacity_ = new_capacity;
+      return 0;
+   }
+
+   /*****************************************************************************
+   * grow: Skerstller plats fr ytterligare ett element genom att ka
+   *       kapaciteten med 50 % (minst fyra element) nr vektorn r full.
+   *       Ifall det lyckas returneras 0, annars felkod 1.
+   *****************************************************************************/
+   int grow(void)
+   {
+      if (this->size_ < this->capacity_) return 0;
+      const size_t new_capacity = this->size_ < 4 ? 4 : this->size_ + this->size_ / 2;
+      return this->reallocate(new_capacity);
+   }
+
 public:
 
    /*****************************************************************************
-   * vector: Tom konstruktor, initierar en ny tom vektor. 
+   * vector: Tom konstruktor, initierar en ny tom vektor.
    *****************************************************************************/
    vector(void) { }
 
    /*****************************************************************************
    * vector: Konstruktor, initierar ny vektor av angiven storlek med angivet
    *         startvrde.
-   * 
+   *
    *         - start_size: Vektorns nya storlek (antalet element).
-   *         - start_val : Referens till startvrde fr samtliga element 
+   *         - start_val : Referens till startvrde fr samtliga element
    *                       (default = 0).
    *****************************************************************************/
    vector(const size_t start_size,
@@ -41,16 +148,16 @@ public:
    /*****************************************************************************
    * ~vector: Destruktor, frigr minne allokerat fr vektorn innan radering.
    *****************************************************************************/
-   ~vector(void) 
+   ~vector(void)
    {
       this->clear();
       return;
-   } 
+   }
 
    /********************************************************************************
    * vector: Kopieringskonstruktor raderad.
    ********************************************************************************/
-   vector(vector&) = delete;         
+   vector(vector&) = delete;
 
    /********************************************************************************
    * vector: Tilldelningsoperator raderad.
@@ -68,9 +175,18 @@ public:
    /*****************************************************************************
    * size: Returnerar arrayens storlek (antalet element) i angiven vektor.
    *****************************************************************************/
-   size_t size(void) const 
-   { 
-      return this->size_; 
+   size_t size(void) const
+   {
+      return this->size_;
+   }
+
+   /*****************************************************************************
+   * capacity: Returnerar antalet element som ryms i angiven vektor utan
+   *           omallokering.
+   *****************************************************************************/
+   size_t capacity(void) const
+   {
+      return this->capacity_;
    }
 
    /*****************************************************************************
@@ -94,27 +210,74 @@ public:
    *****************************************************************************/
    T* last(void) const
    {
-      return this->data_ ? this->end() - 1 : nullptr;
+      return this->size_ ? this->end() - 1 : nullptr;
    }
 
    /*****************************************************************************
-   * clear: Tmmer angiven vektor.
+   * clear: Tmmer angiven vektor och frigr allokerat minne.
    *****************************************************************************/
    void clear(void)
    {
-      free(this->data_);
-      this->data_ = nullptr;
+      destroy(this->data_, this->size_);
       this->size_ = 0;
+      this->reallocate(0);
       return;
    }
 
+   /*****************************************************************************
+   * reserve: Skerstller att angiven vektor rymmer minst angivet antal
+   *          element utan vidare omallokering. Ifall det lyckas returneras 0,
+   *          annars felkod 1.
+   *
+   *          - new_capacity: nskad kapacitet (antalet element).
+   *****************************************************************************/
+   int reserve(const size_t new_capacity)
+   {
+      if (new_capacity <= this->capacity_) return 0;
+      return this->reallocate(new_capacity);
+   }
+
+   /*****************************************************************************
+   * shrink_to_fit: Minskar kapaciteten i angiven vektor till dess storlek,
+   *                s att verskottet lmnas tillbaka till heapen. Ifall det
+   *                lyckas returneras 0, annars felkod 1.
+   *****************************************************************************/
+   int shrink_to_fit(void)
+   {
+      if (this->capacity_ == this->size_) return 0;
+      return this->reallocate(this->size_);
+   }
+
+   /*****************************************************************************
+   * assign: Kopierar angivet antal element frn angivet flt till angiven
+   *         vektor, som frst tms. Ifall minnesallokeringen lyckas returneras
+   *         0, annars felkod 1, varvid vektorn lmnas tom.
+   *
+   *         - data: Pekare till fltet som ska kopieras.
+   *         - size: Antalet element i fltet.
+   *****************************************************************************/
+   int assign(const T* data,
+              const size_t size)
+   {
+      this->clear();
+      if (!data || !size) return 0;
+      if (this->reserve(size)) return 1;
+
+      for (size_t i = 0; i < size; ++i)
+      {
+         new (this->data_ + this->size_++) T(data[i]);
+      }
+      return 0;
+   }
+
    /*****************************************************************************
    * resize: ndrar storlek p angiven vektor med angivet startvrde, dr
-   *         startvrdet r satt till 0 som default. Ifall vektorns storlek
-   *         lyckas ndras till nskad storlek returneras 0, annars felkod 1.
-   * 
+   *         startvrdet r satt till 0 som default. Samtliga element tilldelas
+   *         startvrdet. Ifall vektorns storlek lyckas ndras till nskad
+   *         storlek returneras 0, annars felkod 1.
+   *
    *         - new_size : Vektorns nya storlek (antalet element).
-   *         - start_val: Referens till startvrde fr respektive element 
+   *         - start_val: Referens till startvrde fr respektive element
    *                      (default = 0).
    *****************************************************************************/
    int resize(const size_t new_size,
@@ -126,54 +289,119 @@ public:
          return 0;
       }
 
-      auto copy = (T*)realloc(this->data_, sizeof(T) * new_size);
-      if (!copy) return 1;
-      this->data_ = copy;
-      this->size_ = new_size;
+      if (new_size < this->size_)
+      {
+         destroy(this->data_ + new_size, this->size_ - new_size);
+         this->size_ = new_size;
+      }
+
+      if (this->reserve(new_size)) return 1;
 
       for (auto& i : *this)
       {
          i = start_val;
       }
 
+      while (this->size_ < new_size)
+      {
+         new (this->data_ + this->size_++) T(start_val);
+      }
+
+      return 0;
+   }
+
+   /*****************************************************************************
+   * emplace: Konstruerar ett nytt element lngst bak i angiven vektor med
+   *          angivna argument. Elementet konstrueras innan befintliga element
+   *          flyttas, s argumenten fr referera till element i vektorn.
+   *          Ifall minnesallokeringen lyckas s returneras 0, annars felkod 1.
+   *
+   *          - args: Argument som passeras till elementets konstruktor.
+   *****************************************************************************/
+   template<class... Args>
+   int emplace(Args&&... args)
+   {
+      if (this->size_ < this->capacity_)
+      {
+         new (this->data_ + this->size_++) T(static_cast<Args&&>(args)...);
+         return 0;
+      }
+
+      T new_element(static_cast<Args&&>(args)...);
+      if (this->grow()) return 1;
+      new (this->data_ + this->size_++) T(static_cast<T&&>(new_element));
       return 0;
    }
 
    /*****************************************************************************
    * push: Lgger till ett nytt element lngst bak i angiven vektor. Ifall
    *       minnesallokeringen lyckas s returneras 0, annars felkod 1.
-   * 
+   *
    *       - new_element: Referens till det nya element som skall lggas till.
    *****************************************************************************/
    int push(const T& new_element)
    {
-      auto copy = (T*)realloc(this->data_, sizeof(T) * (this->size_ + 1));
-      if (!copy) return 1;
-      copy[this->size_++] = new_element;
-      this->data_ = copy;
-      return 0;
+      return this->emplace(new_element);
    }
 
    /*****************************************************************************
    * pop: Tar bort det sista elementet i angiven vektor om ett sdant finns.
-   *      Om hgst ett element finns lagrat i vektor s tms den helt.
+   *      Minnet behlls fr kommande push, se shrink_to_fit.
    *****************************************************************************/
    void pop(void)
    {
-      if (this->size <= 1)
+      if (!this->size_) return;
+      this->size_--;
+      this->data_[this->size_].~T();
+      return;
+   }
+
+   /*****************************************************************************
+   * insert: Lgger till ett nytt element p angivet index i angiven vektor,
+   *         dr efterfljande element flyttas ett steg bakt. Ifall indexet
+   *         r giltigt och minnesallokeringen lyckas returneras 0, annars
+   *         felkod 1.
+   *
+   *         - index      : Index fr det nya elementet, 0 - size.
+   *         - new_element: Referens till det nya element som skall lggas till.
+   *****************************************************************************/
+   int insert(const size_t index,
+              const T& new_element)
+   {
+      if (index > this->size_) return 1;
+      if (index == this->size_) return this->emplace(new_element);
+
+      T copy(new_element);
+      if (this->emplace(static_cast<T&&>(this->data_[this->size_ - 1]))) return 1;
+
+      for (size_t i = this->size_ - 2; i > index; --i)
       {
-         this->clear();
+         this->data_[i] = static_cast<T&&>(this->data_[i - 1]);
       }
-      else
+
+      this->data_[index] = static_cast<T&&>(copy);
+      return 0;
+   }
+
+   /*****************************************************************************
+   * erase: Tar bort elementet p angivet index i angiven vektor, dr
+   *        efterfljande element flyttas ett steg framt. Ifall indexet r
+   *        giltigt returneras 0, annars felkod 1.
+   *
+   *        - index: Index fr elementet som ska tas bort.
+   *****************************************************************************/
+   int erase(const size_t index)
+   {
+      if (index >= this->size_) return 1;
+
+      for (size_t i = index; i + 1 < this->size_; ++i)
       {
-         auto copy = (T*)realloc(this->data_, sizeof(T) * (this->size_ - 1));
-         if (!copy) return;
-         this->data_ = copy;
-         this->size_--;
+         this->data_[i] = static_cast<T&&>(this->data_[i + 1]);
       }
 
-      return;
+      this->pop();
+      return 0;
    }
 };
 
-#endif /* VECTOR_HPP_ */
\ No newline at end of file
+#endif /* VECTOR_HPP_ */
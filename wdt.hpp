@@ -5,11 +5,17 @@
 *          Det r ocks mjligt att kombinera tidigare nmnda modes fr att
 *          avbrott sker, fljt av systemterstllning.
 *
-*          Avbrottsvektorn fr timeout-avbrott r WDT_vect.
+*          Avbrottsvektorn fr timeout-avbrott r WDT_vect. En avbrottsrutin
+*          kan passeras vid initiering, vilken d anropas via dispatch-lagret
+*          i interrupt.hpp.
 ********************************************************************************/
 #ifndef WDT_HPP_
 #define WDT_HPP_
 
+/* Inkluderingsdirektiv: */
+#include "interrupt.hpp"
+#include "atomic.hpp"
+
 namespace wdt
 {
    /********************************************************************************
@@ -35,10 +41,9 @@ namespace wdt
    ********************************************************************************/
    auto reset = [](void)
    {
-      asm("CLI");
+      critical_section lock;
       asm("WDR");
       MCUSR &= ~(1 << WDRF);
-      asm("SEI");
       return;
    };
 
@@ -46,14 +51,18 @@ namespace wdt
    * init: Initierar Watchdog-timern med angiven timeout mtt i millisekunder.
    *
    *       - timeout_ms: Timeout mtt i millisekunder.
+   *       - callback  : Avbrottsrutin som anropas vid timeout i Interrupt Mode
+   *                     (default = ingen, avbrottsvektorn skrivs d av
+   *                     anvndaren).
    ********************************************************************************/
-   auto init = [](const timeout timeout_ms)
+   auto init = [](const timeout timeout_ms,
+                  void (*callback)(void) = nullptr)
    {
+      if (callback) interrupt::attach<interrupt::vector::wdt>(callback);
       wdt::reset();
-      asm("CLI");
+      critical_section lock;
       WDTCSR = (1 << WDCE) | (1 << WDE);
       WDTCSR = (1 << WDE) | static_cast<uint8_t>(timeout_ms);
-      asm("SEI");
       return;
    };
 
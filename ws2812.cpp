@@ -0,0 +1,207 @@
+/********************************************************************************
+* ws2812.cpp: Innehller sndning till adresserbara RGB-lysdioder av typen
+*             WS2812B samt gammatabell lagrad i programminnet.
+********************************************************************************/
+#include "ws2812.hpp"
+
+/********************************************************************************
+* gamma: Gammatabell med gamma 2.6, dr index utgr okorrigerat vrde.
+********************************************************************************/
+const uint8_t neopixel::gamma[256] PROGMEM =
+{
+     0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   1,
+     1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,
+     3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   5,   6,   6,   6,   6,   7,
+     7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  10,  11,  11,  11,  12,  12,
+    13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,  20,
+    20,  21,  21,  22,  22,  23,  24,  24,  25,  25,  26,  27,  27,  28,  29,  29,
+    30,  31,  31,  32,  33,  34,  34,  35,  36,  37,  38,  38,  39,  40,  41,  42,
+    42,  43,  44,  45,  46,  47,  48,  49,  50,  51,  52,  53,  54,  55,  56,  57,
+    58,  59,  60,  61,  62,  63,  64,  65,  66,  68,  69,  70,  71,  72,  73,  75,
+    76,  77,  78,  80,  81,  82,  84,  85,  86,  88,  89,  90,  92,  93,  94,  96,
+    97,  99, 100, 102, 103, 105, 106, 108, 109, 111, 112, 114, 115, 117, 119, 120,
+   122, 124, 125, 127, 129, 130, 132, 134, 136, 137, 139, 141, 143, 145, 146, 148,
+   150, 152, 154, 156, 158, 160, 162, 164, 166, 168, 170, 172, 174, 176, 178, 180,
+   182, 184, 186, 188, 191, 193, 195, 197, 199, 202, 204, 206, 209, 211, 213, 215,
+   218, 220, 223, 225, 227, 230, 232, 235, 237, 240, 242, 245, 247, 250, 252, 255
+};
+
+/********************************************************************************
+* scale: Returnerar angivet vrde efter gammakorrigering samt skalning med
+*        angiven ljusstyrka.
+*
+*        - value           : Okorrigerat vrde, 0 - 255.
+*        - brightness      : Ljusstyrka, 0 - 255 (255 = full).
+*        - gamma_correction: Indikerar ifall gammakorrigering ska tillmpas.
+********************************************************************************/
+static inline uint8_t scale(uint8_t value,
+                            const uint8_t brightness,
+                            const bool gamma_correction)
+{
+   if (gamma_correction) value = pgm_read_byte(&neopixel::gamma[value]);
+   if (brightness == 255) return value;
+   return static_cast<uint8_t>((value * static_cast<uint16_t>(brightness + 1)) >> 8);
+}
+
+/********************************************************************************
+* transmit: Snder tre byte (en pixel) till slingan, mest signifikant bit
+*           frst. Varje bit tar exakt 20 cykler, dr pinnen stts hg vid
+*           T = 2, lg vid T = 7 fr en nolla samt lg vid T = 15 fr en etta
+*           (tiden rknas frn brjan av instruktionen st, som tar tv
+*           cykler). Nsta byte lses under sista bitens lgniv. Anropas
+*           med avbrott inaktiverade.
+*
+*           - port: Pekare till pinnens dataregister.
+*           - high: Dataregistrets vrde med pinnen hg.
+*           - low : Dataregistrets vrde med pinnen lg.
+*           - grb : Pekare till fyra byte, dr de tre frsta snds (den
+*                   fjrde lses men snds inte).
+********************************************************************************/
+static inline void transmit(volatile uint8_t* port,
+                            const uint8_t high,
+                            const uint8_t low,
+                            const uint8_t* grb)
+{
+   uint8_t byte = *grb++;
+   uint8_t bit = 8;
+   uint8_t bytes = 3;
+   uint8_t next = low;
+
+   asm volatile(
+      "1:                          \n\t" /* Cykler  (T =  0) */
+      "st   %a[port], %[high]      \n\t" /* 2       (T =  2) Pinnen hg. */
+      "sbrc %[byte], 7             \n\t" /* 1 - 2            Om biten r en etta... */
+      "mov  %[next], %[high]       \n\t" /* 0 - 1   (T =  4) ...frblir pinnen hg. */
+      "dec  %[bit]                 \n\t" /* 1       (T =  5) */
+      "st   %a[port], %[next]      \n\t" /* 2       (T =  7) Pinnen lg fr en nolla. */
+      "mov  %[next], %[low]        \n\t" /* 1       (T =  8) */
+      "breq 2f                     \n\t" /* 1 - 2   (T =  9) Sista biten i byten? */
+      "rol  %[byte]                \n\t" /* 1       (T = 10) Nsta bit. */
+      "rjmp .+0                    \n\t" /* 2       (T = 12) */
+      "nop                         \n\t" /* 1       (T = 13) */
+      "st   %a[port], %[low]       \n\t" /* 2       (T = 15) Pinnen lg fr en etta. */
+      "nop                         \n\t" /* 1       (T = 16) */
+      "rjmp .+0                    \n\t" /* 2       (T = 18) */
+      "rjmp 1b                     \n\t" /* 2       (T = 20) */
+      "2:                          \n\t" /*         (T = 10) */
+      "ldi  %[bit], 8              \n\t" /* 1       (T = 11) */
+      "ld   %[byte], %a[grb]+      \n\t" /* 2       (T = 13) Nsta byte. */
+      "st   %a[port], %[low]       \n\t" /* 2       (T = 15) Pinnen lg fr en etta. */
+      "nop                         \n\t" /* 1       (T = 16) */
+      "nop                         \n\t" /* 1       (T = 17) */
+      "dec  %[bytes]               \n\t" /* 1       (T = 18) */
+      "brne 1b                     \n\t" /* 2       (T = 20) */
+      : [byte]  "+r" (byte),
+        [bit]   "+d" (bit),
+        [bytes] "+r" (bytes),
+        [next]  "+r" (next),
+        [grb]   "+e" (grb)
+      : [port]  "e" (port),
+        [high]  "r" (high),
+        [low]   "r" (low)
+      : "memory");
+   return;
+}
+
+/********************************************************************************
+* write: Snder angivet antal pixlar till slingan. Avbrott inaktiveras under
+*        varje fnster och terstlls mellan fnstren till det lge som
+*        gllde vid anropet. Dataregistrets vrden fr hg respektive lg
+*        niv berknas i brjan av varje fnster, s att vriga pinnar p
+*        samma port behller sina vrden.
+*
+*        Vid mtning rknar Timer 0 med prescaler 8 (0.5 us per tick) frn
+*        noll i brjan av varje fnster. Eftersom en pixel tar ca 34 us
+*        kontrolleras overflow efter varje pixel, vilket tillter fnster av
+*        godtycklig lngd.
+*
+*        - port             : Pekare till pinnens dataregister.
+*        - mask             : Bitmask fr pinnen.
+*        - data             : Pekare till pixlarna (tre byte per pixel).
+*        - pixels           : Antalet pixlar som ska sndas.
+*        - brightness       : Ljusstyrka, 0 - 255 (255 = full).
+*        - gamma_correction : Indikerar ifall gammakorrigering ska tillmpas.
+*        - pixels_per_window: Antalet pixlar per avbrottsfritt fnster
+*                             (0 = hela slingan).
+*        - window_us        : Pekare till variabel dr lngsta uppmtta
+*                             fnster lagras, eller nullptr.
+********************************************************************************/
+void neopixel::write(volatile uint8_t* port,
+                     const uint8_t mask,
+                     const uint8_t* data,
+                     const uint16_t pixels,
+                     const uint8_t brightness,
+                     const bool gamma_correction,
+                     const uint16_t pixels_per_window,
+                     uint16_t* window_us)
+{
+   const uint16_t window = pixels_per_window && pixels_per_window < pixels ? pixels_per_window : pixels;
+   const uint8_t sreg = SREG;
+   const uint8_t tccr0a = TCCR0A;
+   const uint8_t tccr0b = TCCR0B;
+   const uint8_t tcnt0 = TCNT0;
+   uint32_t longest = 0;
+   uint8_t grb[4] = {};
+   uint16_t remaining = pixels;
+
+   if (window_us)
+   {
+      TCCR0A = 0x00;
+      TCCR0B = (1 << CS01);
+   }
+
+   while (remaining)
+   {
+      auto count = remaining < window ? remaining : window;
+      uint16_t overflows = 0;
+      remaining -= count;
+
+      asm("CLI");
+
+      if (window_us)
+      {
+         TCNT0 = 0;
+         TIFR0 = (1 << TOV0);
+      }
+
+      const uint8_t high = *port | mask;
+      const uint8_t low = *port & ~mask;
+
+      while (count--)
+      {
+         grb[0] = scale(data[0], brightness, gamma_correction);
+         grb[1] = scale(data[1], brightness, gamma_correction);
+         grb[2] = scale(data[2], brightness, gamma_correction);
+         transmit(port, high, low, grb);
+         data += 3;
+
+         if (window_us && (TIFR0 & (1 << TOV0)))
+         {
+            TIFR0 = (1 << TOV0);
+            overflows++;
+         }
+      }
+
+      if (window_us)
+      {
+         const uint8_t ticks = TCNT0;
+         if ((TIFR0 & (1 << TOV0)) && ticks < 0x80) overflows++;
+         const uint32_t elapsed = (static_cast<uint32_t>(overflows) << 8) | ticks;
+         if (elapsed > longest) longest = elapsed;
+      }
+
+      SREG = sreg;
+   }
+
+   if (window_us)
+   {
+      TCCR0B = 0x00;
+      TCCR0A = tccr0a;
+      TCNT0 = tcnt0;
+      TCCR0B = tccr0b;
+      const uint32_t us = (longest + 1) / 2;
+      *window_us = us > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(us);
+   }
+   return;
+}
\ No newline at end of file
@@ -0,0 +1,350 @@
+/********************************************************************************
+* ws2812.hpp: Innehller drivrutiner fr adresserbara RGB-lysdioder av typen
+*             WS2812B (NeoPixel) via klassen ws2812, dr lysdiodsslingan
+*             ansluts till valfri pin.
+*
+*             Protokollet krver 800 kHz, allts 1.25 us (20 CPU-cykler vid
+*             16 MHz) per bit, dr en nolla snds som 5 cykler hg (312 ns)
+*             och en etta som 13 cykler hg (812 ns). Bitarna snds via en
+*             cykelexakt assemblerslinga i ws2812.cpp med avbrott inaktiverade.
+*             Mellan bitarna finns ingen tid fr avbrott, men lgnivn
+*             mellan tv pixlar fr frlngas med ngra mikrosekunder utan
+*             att slingan tolkar det som reset (WS2812B krver minst 50 us,
+*             nyare versioner 280 us). Avbrott tillts drfr mellan varje
+*             fnster om pixels_per_window pixlar (default = 1), vilket ger
+*             ett avbrottsfritt fnster p ca 34 us per pixel. Avbrottsrutiner
+*             som krs mellan tv fnster frlnger lgnivn, s fr ldre
+*             varianter med kortare reset-tid (ca 6 us) br hela slingan
+*             sndas i ett fnster (pixels_per_window = 0).
+*
+*             Pixlarna lagras i en buffert om tre byte per lysdiod i den
+*             ordning de snds (grn, rd, bl). 300 lysdioder krver drmed
+*             900 byte RAM, vilket rymms i ATmega328P:s 2 kB. Ljusstyrka samt
+*             gammakorrigering (tabell i programminnet) tillmpas per byte
+*             vid sndning, s att bufferten alltid innehller okorrigerade
+*             frger och ljusstyrkan kan ndras utan frlust.
+*
+*             Exempel med 60 lysdioder p pin 6:
+*
+*             ws2812<60> strip(6);
+*             strip.set(0, 255, 0, 0);
+*             strip.set_brightness(64);
+*             strip.show();
+*
+*             Det avbrottsfria fnstrets lngd kan mtas via measure_window,
+*             som lnar Timer 0 under mtningen.
+********************************************************************************/
+#ifndef WS2812_HPP_
+#define WS2812_HPP_
+
+/* Inkluderingsdirektiv: */
+#include "misc.hpp"
+#include <avr/pgmspace.h>
+
+/********************************************************************************
+* neopixel: Namnrymd innehllande sndning till WS2812B-slingor samt
+*           gammatabell, gemensamma fr samtliga slingor.
+********************************************************************************/
+namespace neopixel
+{
+   static constexpr uint16_t RESET_US = 300;         /* Lgniv som avslutar en bild (280 us fr WS2812B V5). */
+   static constexpr uint16_t CYCLES_PER_PIXEL = 480; /* CPU-cykler per pixel (24 bitar  20 cykler). */
+   static constexpr uint16_t WINDOW_OVERHEAD = 64;   /* Uppskattade CPU-cykler per pixel fr skalning samt per fnster. */
+
+   /* Gammatabell (gamma 2.6) lagrad i programminnet: */
+   extern const uint8_t gamma[256] PROGMEM;
+
+   /********************************************************************************
+   * write: Snder angivet antal pixlar till slingan p angiven pin. Avbrott
+   *        inaktiveras under varje fnster om pixels_per_window pixlar och
+   *        terstlls mellan fnstren. Ljusstyrka samt gammakorrigering
+   *        tillmpas per byte precis innan respektive pixel snds.
+   *
+   *        - port             : Pekare till pinnens dataregister.
+   *        - mask             : Bitmask fr pinnen.
+   *        - data             : Pekare till pixlarna (tre byte per pixel).
+   *        - pixels           : Antalet pixlar som ska sndas.
+   *        - brightness       : Ljusstyrka, 0 - 255 (255 = full).
+   *        - gamma_correction : Indikerar ifall gammakorrigering ska tillmpas.
+   *        - pixels_per_window: Antalet pixlar per avbrottsfritt fnster
+   *                             (0 = hela slingan).
+   *        - window_us        : Pekare till variabel dr lngsta uppmtta
+   *                             fnster lagras mtt i mikrosekunder, eller
+   *                             nullptr om ingen mtning ska ske. Timer 0
+   *                             lnas under mtningen och terstlls sedan.
+   ********************************************************************************/
+   void write(volatile uint8_t* port,
+              const uint8_t mask,
+              const uint8_t* data,
+              const uint16_t pixels,
+              const uint8_t brightness,
+              const bool gamma_correction,
+              const uint16_t pixels_per_window,
+              uint16_t* window_us = nullptr);
+}
+
+/********************************************************************************
+* ws2812: Generisk klass fr en slinga med N adresserbara RGB-lysdioder av
+*         typen WS2812B.
+********************************************************************************/
+template<uint16_t N>
+class ws2812
+{
+private:
+   static_assert(N >= 1 && N <= 500, "Number of pixels must be between 1 and 500!");
+
+   uint8_t pixels_[N * 3] = {};        /* Pixelbuffert i sndordning (grn, rd, bl). */
+   volatile uint8_t* port_ = nullptr;  /* Pekare till pinnens dataregister. */
+   uint8_t mask_ = 0;                  /* Bitmask fr pinnen. */
+   uint8_t brightness_ = 255;          /* Ljusstyrka, 0 - 255. */
+   bool gamma_ = false;                /* Indikerar ifall gammakorrigering tillmpas. */
+   uint16_t pixels_per_window_ = 1;    /* Antalet pixlar per avbrottsfritt fnster. */
+
+public:
+
+   /********************************************************************************
+   * ws2812: Defaultkonstruktor, initierar tomt objekt.
+   ********************************************************************************/
+   ws2812(void) { }
+
+   /********************************************************************************
+   * ws2812: Initierar slinga p angiven pin.
+   *
+   *         - pin              : Pin-nummer p Arduino Uno, exempelvis 6.
+   *         - pixels_per_window: Antalet pixlar per avbrottsfritt fnster
+   *                              (default = 1, 0 = hela slingan).
+   ********************************************************************************/
+   ws2812(const uint8_t pin,
+          const uint16_t pixels_per_window = 1)
+   {
+      this->init(pin, pixels_per_window);
+      return;
+   }
+
+   /********************************************************************************
+   * ws2812: Kopieringskonstruktor raderad.
+   ********************************************************************************/
+   ws2812(ws2812&) = delete;
+
+   /********************************************************************************
+   * ws2812: Tilldelningsoperator raderad.
+   ********************************************************************************/
+   ws2812& operator= (ws2812&) = delete;
+
+   /********************************************************************************
+   * init: Initierar slinga p angiven pin, som stts till utport med lg
+   *       niv. Pixelbufferten nollstlls.
+   *
+   *       - pin              : Pin-nummer p Arduino Uno, exempelvis 6.
+   *       - pixels_per_window: Antalet pixlar per avbrottsfritt fnster
+   *                            (default = 1, 0 = hela slingan).
+   ********************************************************************************/
+   void init(const uint8_t pin,
+             const uint16_t pixels_per_window = 1)
+   {
+      if (pin <= 7)
+      {
+         this->port_ = &PORTD;
+         this->mask_ = (1 << pin);
+         DDRD |= this->mask_;
+      }
+      else if (pin <= 13)
+      {
+         this->port_ = &PORTB;
+         this->mask_ = (1 << (pin - 8));
+         DDRB |= this->mask_;
+      }
+      else
+      {
+         this->port_ = &PORTC;
+         this->mask_ = (1 << (pin - 14));
+         DDRC |= this->mask_;
+      }
+
+      *this->port_ &= ~this->mask_;
+      this->pixels_per_window_ = pixels_per_window;
+      this->clear();
+      return;
+   }
+
+   /********************************************************************************
+   * size: Returnerar antalet lysdioder i slingan.
+   ********************************************************************************/
+   static constexpr uint16_t size(void)
+   {
+      return N;
+   }
+
+   /********************************************************************************
+   * data: Returnerar en pekare till pixelbufferten (grn, rd, bl per pixel).
+   ********************************************************************************/
+   uint8_t* data(void)
+   {
+      return this->pixels_;
+   }
+
+   /********************************************************************************
+   * set: Stter frgen fr angiven lysdiod i pixelbufferten. ndringen
+   *      visas frst vid nsta anrop av show.
+   *
+   *      - index: Lysdiodens index, 0 - N - 1.
+   *      - red  : Rd frgkomponent, 0 - 255.
+   *      - green: Grn frgkomponent, 0 - 255.
+   *      - blue : Bl frgkomponent, 0 - 255.
+   ********************************************************************************/
+   void set(const uint16_t index,
+            const uint8_t red,
+            const uint8_t green,
+            const uint8_t blue)
+   {
+      if (index >= N) return;
+      auto pixel = this->pixels_ + index * 3;
+      pixel[0] = green;
+      pixel[1] = red;
+      pixel[2] = blue;
+      return;
+   }
+
+   /********************************************************************************
+   * set: Stter frgen fr angiven lysdiod i pixelbufferten.
+   *
+   *      - index: Lysdiodens index, 0 - N - 1.
+   *      - rgb  : Frg angiven som 0xRRGGBB.
+   ********************************************************************************/
+   void set(const uint16_t index,
+            const uint32_t rgb)
+   {
+      this->set(index, static_cast<uint8_t>(rgb >> 16), static_cast<uint8_t>(rgb >> 8), static_cast<uint8_t>(rgb));
+      return;
+   }
+
+   /********************************************************************************
+   * get: Returnerar frgen fr angiven lysdiod som 0xRRGGBB.
+   *
+   *      - index: Lysdiodens index, 0 - N - 1.
+   ********************************************************************************/
+   uint32_t get(const uint16_t index) const
+   {
+      if (index >= N) return 0;
+      const auto pixel = this->pixels_ + index * 3;
+      return (static_cast<uint32_t>(pixel[1]) << 16) | (static_cast<uint16_t>(pixel[0]) << 8) | pixel[2];
+   }
+
+   /********************************************************************************
+   * fill: Stter samtliga lysdioder till angiven frg.
+   *
+   *       - red  : Rd frgkomponent, 0 - 255.
+   *       - green: Grn frgkomponent, 0 - 255.
+   *       - blue : Bl frgkomponent, 0 - 255.
+   ********************************************************************************/
+   void fill(const uint8_t red,
+             const uint8_t green,
+             const uint8_t blue)
+   {
+      for (uint16_t i = 0; i < N; ++i)
+      {
+         this->set(i, red, green, blue);
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * clear: Slcker samtliga lysdioder i pixelbufferten.
+   ********************************************************************************/
+   void clear(void)
+   {
+      for (auto& i : this->pixels_)
+      {
+         i = 0;
+      }
+      return;
+   }
+
+   /********************************************************************************
+   * brightness: Returnerar aktuell ljusstyrka, 0 - 255.
+   ********************************************************************************/
+   uint8_t brightness(void) const
+   {
+      return this->brightness_;
+   }
+
+   /********************************************************************************
+   * set_brightness: Stter ljusstyrkan, som tillmpas vid sndning utan att
+   *                 pixelbufferten pverkas.
+   *
+   *                 - brightness: Ljusstyrka, 0 - 255 (255 = full).
+   ********************************************************************************/
+   void set_brightness(const uint8_t brightness)
+   {
+      this->brightness_ = brightness;
+      return;
+   }
+
+   /********************************************************************************
+   * set_gamma: Aktiverar eller inaktiverar gammakorrigering vid sndning.
+   *
+   *            - enabled: Indikerar ifall gammakorrigering ska tillmpas.
+   ********************************************************************************/
+   void set_gamma(const bool enabled)
+   {
+      this->gamma_ = enabled;
+      return;
+   }
+
+   /********************************************************************************
+   * set_pixels_per_window: Stter antalet pixlar per avbrottsfritt fnster.
+   *
+   *                        - pixels_per_window: Antalet pixlar per fnster
+   *                                             (0 = hela slingan).
+   ********************************************************************************/
+   void set_pixels_per_window(const uint16_t pixels_per_window)
+   {
+      this->pixels_per_window_ = pixels_per_window;
+      return;
+   }
+
+   /********************************************************************************
+   * interrupt_window_us: Returnerar berknad lngd fr det avbrottsfria
+   *                      fnstret mtt i mikrosekunder, utifrn antalet
+   *                      cykler i sndslingan samt uppskattad overhead.
+   ********************************************************************************/
+   uint16_t interrupt_window_us(void) const
+   {
+      const uint32_t pixels = this->pixels_per_window_ && this->pixels_per_window_ < N ?
+         this->pixels_per_window_ : N;
+      return static_cast<uint16_t>(pixels * (neopixel::CYCLES_PER_PIXEL + neopixel::WINDOW_OVERHEAD) /
+                                   (F_CPU / 1000000UL));
+   }
+
+   /********************************************************************************
+   * show: Snder pixelbufferten till slingan och vntar sedan p reset, s
+   *       att nsta anrop alltid pbrjar en ny bild. Sndningen tar ca
+   *       30 us per lysdiod, exempelvis ca 9 ms fr 300 lysdioder.
+   ********************************************************************************/
+   void show(void)
+   {
+      if (!this->port_) return;
+      neopixel::write(this->port_, this->mask_, this->pixels_, N, this->brightness_,
+                      this->gamma_, this->pixels_per_window_);
+      misc::delay_us(neopixel::RESET_US);
+      return;
+   }
+
+   /********************************************************************************
+   * measure_window: Snder pixelbufferten till slingan och returnerar
+   *                 lngsta uppmtta avbrottsfria fnster mtt i
+   *                 mikrosekunder (upplsning 0.5 us). Timer 0 lnas under
+   *                 mtningen och fr drmed inte anvndas samtidigt.
+   ********************************************************************************/
+   uint16_t measure_window(void)
+   {
+      uint16_t window_us = 0;
+      if (!this->port_) return 0;
+      neopixel::write(this->port_, this->mask_, this->pixels_, N, this->brightness_,
+                      this->gamma_, this->pixels_per_window_, &window_us);
+      misc::delay_us(neopixel::RESET_US);
+      return window_us;
+   }
+};
+
+#endif /* WS2812_HPP_ */
\ No newline at end of file